@@ -16,7 +16,7 @@ class TenncorConan(ConanFile):
         "cppkg/0.1.2@mingkaic-co/stable",
         "Ppconsul/0.2.1@mingkaic-co/stable",
         "g3log/1.3.3",
-        "eigen/3.3.7",
+        "eigen/3.4.0",
         "pybind11/2.6.0",
     )
     generators = "cmake", "cmake_find_package_multi"
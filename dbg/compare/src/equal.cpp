@@ -47,7 +47,8 @@ bool is_equal (const eteq::ETensor& lroot, const eteq::ETensor& rroot)
 		}
 		if (lheights.upper_ == 0)
 		{
-			auto hid = global::get_generator()->get_str();
+			// paired leaves share the hash of the left leaf
+			size_t hid = boost::hash_value(ords.first);
 			hasher.hashes_.emplace(ords.first, hid);
 			hasher.hashes_.emplace(ords.second, hid);
 			hasher.visited_.emplace(ords.first);
@@ -30,6 +30,13 @@ class Embedding(object):
         idx = self.word2idx[word]
         return self[idx]
 
+    def lookup(self, indices):
+        '''
+        indices     tensor of word indices
+        return embedding vectors of indices without a vocabulary sized matmul
+        '''
+        return tc.api.gather(self.weight, indices, 1)
+
     def onehot(self, word):
         if word not in self.word2idx:
             return None
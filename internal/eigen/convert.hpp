@@ -20,6 +20,29 @@ namespace eigen
 /// Eigen shape
 using DimensionsT = std::array<Eigen::Index,teq::rank_cap>;
 
+/// Scalar type that sums and products of T accumulate in
+template <typename T>
+struct AccumType
+{
+	using type = T;
+};
+
+/// 16-bit floats accumulate in float to avoid losing precision
+template <>
+struct AccumType<Eigen::half>
+{
+	using type = float;
+};
+
+template <>
+struct AccumType<Eigen::bfloat16>
+{
+	using type = float;
+};
+
+template <typename T>
+using AccumT = typename AccumType<T>::type;
+
 /// Eigen Matrix
 template <typename T>
 using  MatrixT = Eigen::Matrix<T,Eigen::Dynamic,Eigen::Dynamic,Eigen::RowMajor>;
@@ -114,6 +137,32 @@ teq::Shape get_shape (const TensMapT<T>& tens)
 	return teq::Shape(teq::DimsT(slist.begin(), slist.end()));
 }
 
+/// Assign product of a and b (each transposed if flagged) to out
+/// where a and b are any matrix expression (e.g.: sparse or strided matrices)
+template <typename T, typename OUT, typename LHS, typename RHS>
+void trans_product (OUT& out, const LHS& a, bool atrans,
+	const RHS& b, bool btrans)
+{
+	auto lhs = a.template cast<AccumT<T>>();
+	auto rhs = b.template cast<AccumT<T>>();
+	if (atrans && btrans)
+	{
+		out = MatrixT<AccumT<T>>(lhs.transpose() * rhs.transpose()).template cast<T>();
+	}
+	else if (atrans)
+	{
+		out = MatrixT<AccumT<T>>(lhs.transpose() * rhs).template cast<T>();
+	}
+	else if (btrans)
+	{
+		out = MatrixT<AccumT<T>>(lhs * rhs.transpose()).template cast<T>();
+	}
+	else
+	{
+		out = MatrixT<AccumT<T>>(lhs * rhs).template cast<T>();
+	}
+}
+
 /// Return Eigen shape of teq Shape
 DimensionsT shape_convert (teq::Shape shape);
 
@@ -388,28 +388,32 @@ struct iRefEigen : public iEigen
 
 	teq::Once<void*> odata (void) override
 	{
-		teq::Once<void*> out(data(),
-		[this]
-		{
-			if (0 == (--this->ref_ttl_))
-			{
-				this->ref_->device().odata();
-			}
-		});
+		teq::Once<void*> out(data(), [this]{ this->tick(); });
 		return out;
 	}
 
 	teq::Once<const void*> odata (void) const override
 	{
-		teq::Once<const void*> out(data(),
-		[this]
+		teq::Once<const void*> out(data(), [this]{ this->tick(); });
+		return out;
+	}
+
+	/// Count down one use of this reference and
+	/// release the referenced device after the last use
+	void tick (void) const
+	{
+		if (0 == (--this->ref_ttl_))
 		{
-			if (0 == (--this->ref_ttl_))
+			if (auto ref = dynamic_cast<const iRefEigen*>(&this->ref_->device()))
+			{
+				// count down references without reading (possibly copying) their data
+				ref->tick();
+			}
+			else
 			{
 				this->ref_->device().odata();
 			}
-		});
-		return out;
+		}
 	}
 
 	bool valid_for (size_t desired_ttl) const override
@@ -504,6 +508,257 @@ private:
 	size_t incrs_;
 };
 
+/// Element increments of each dimension in a tensor
+using StridesT = std::array<Eigen::Index,teq::rank_cap>;
+
+/// Return element increments of each dimension of densely packed shape
+inline StridesT dense_strides (const teq::Shape& shape)
+{
+	StridesT out;
+	Eigen::Index incr = 1;
+	for (teq::RankT i = 0; i < teq::rank_cap; ++i)
+	{
+		out[i] = incr;
+		incr *= shape.at(i);
+	}
+	return out;
+}
+
+/// Location of a view's elements within its base tensor's data
+struct ViewLayout final
+{
+	/// Tensor owning the viewed data
+	teq::iTensor* base_;
+
+	/// Element offset of the view's first element in base data
+	Eigen::Index offset_;
+
+	/// Element increments in base data of each view dimension
+	StridesT strides_;
+};
+
+/// Eigen Matrix Map reading rows and columns at arbitrary increments
+template <typename T>
+using StridedMatMapT = Eigen::Map<const MatrixT<T>,
+	Eigen::Unaligned,Eigen::Stride<Eigen::Dynamic,Eigen::Dynamic>>;
+
+/// Reference to an offset and strided arrangement of another tensor's data
+/// Data is read in place when the arrangement is densely packed,
+/// otherwise it is copied only when a consumer requests contiguous data
+template <typename T>
+struct TensView final : public iRefEigen
+{
+	TensView (teq::iTensor& ref, const teq::Shape& shape, const ViewLayout& layout) :
+		iRefEigen(ref), shape_(shape), layout_(layout),
+		contiguous_(is_dense(shape, layout.strides_)) {}
+
+	/// Implementation of iDeviceRef
+	void* data (void) override
+	{
+		return (void*) const_cast<const TensView<T>*>(this)->data();
+	}
+
+	/// Implementation of iDeviceRef
+	const void* data (void) const override
+	{
+		auto base = (const T*) layout_.base_->device().data();
+		if (nullptr == base || contiguous_)
+		{
+			return nullptr == base ? nullptr : base + layout_.offset_;
+		}
+		if (stale_)
+		{
+			materialize(base + layout_.offset_);
+			stale_ = false;
+		}
+		return copy_.data();
+	}
+
+	/// Implementation of iEigen
+	void assign (size_t ttl, RTMemptrT&) override
+	{
+		extend_life(ttl);
+		stale_ = true;
+	}
+
+	/// Return layout of this view in its base tensor
+	const ViewLayout& get_layout (void) const
+	{
+		return layout_;
+	}
+
+	/// Return true if view data is read in place
+	bool is_contiguous (void) const
+	{
+		return contiguous_;
+	}
+
+	/// Return true if view can be read as a matrix without copying
+	bool is_strided_2d (void) const
+	{
+		for (teq::RankT i = 2; i < teq::rank_cap; ++i)
+		{
+			if (shape_.at(i) > 1)
+			{
+				return false;
+			}
+		}
+		return layout_.strides_[0] >= 0 && layout_.strides_[1] >= 0;
+	}
+
+	/// Return matrix map of 2-d view read in place from base data
+	/// where the map counts as a single use of this reference
+	teq::Once<StridedMatMapT<T>> omatrix (void) const
+	{
+		auto base = (const T*) layout_.base_->device().data();
+		if (nullptr == base)
+		{
+			global::fatal("cannot get strided matmap from nullptr");
+		}
+		teq::Once<StridedMatMapT<T>> out(StridedMatMapT<T>(
+			base + layout_.offset_, shape_.at(1), shape_.at(0),
+			Eigen::Stride<Eigen::Dynamic,Eigen::Dynamic>(
+				layout_.strides_[1], layout_.strides_[0])),
+			[this]{ this->tick(); });
+		return out;
+	}
+
+private:
+	static bool is_dense (const teq::Shape& shape, const StridesT& strides)
+	{
+		Eigen::Index incr = 1;
+		for (teq::RankT i = 0; i < teq::rank_cap; ++i)
+		{
+			if (shape.at(i) > 1)
+			{
+				if (strides[i] != incr)
+				{
+					return false;
+				}
+				incr *= shape.at(i);
+			}
+		}
+		return true;
+	}
+
+	void materialize (const T* src) const
+	{
+		size_t n = shape_.n_elems();
+		copy_.resize(n);
+		teq::ShapeT coord;
+		std::fill(coord.begin(), coord.end(), 0);
+		Eigen::Index inner = layout_.strides_[0];
+		teq::DimT ninner = shape_.at(0);
+		Eigen::Index pos = 0;
+		for (size_t i = 0; i < n; i += ninner)
+		{
+			for (teq::DimT j = 0; j < ninner; ++j)
+			{
+				copy_[i + j] = src[pos + j * inner];
+			}
+			// advance outer dimensions like an odometer
+			for (teq::RankT d = 1; d < teq::rank_cap; ++d)
+			{
+				if (++coord[d] < shape_.at(d))
+				{
+					pos += layout_.strides_[d];
+					break;
+				}
+				pos -= layout_.strides_[d] * (shape_.at(d) - 1);
+				coord[d] = 0;
+			}
+		}
+	}
+
+	teq::Shape shape_;
+
+	ViewLayout layout_;
+
+	bool contiguous_;
+
+	/// Contiguous copy of view for consumers that cannot read strides
+	mutable std::vector<T> copy_;
+
+	mutable bool stale_ = true;
+};
+
+/// Return layout of tensor's data, composing onto its base if it is a view
+template <typename T>
+inline ViewLayout view_layout (teq::iTensor& tens)
+{
+	if (auto view = dynamic_cast<const TensView<T>*>(&tens.device()))
+	{
+		return view->get_layout();
+	}
+	return ViewLayout{&tens, 0, dense_strides(tens.shape())};
+}
+
+/// Return true if tensor is a view that is read as a
+/// strided matrix without copying
+template <typename T>
+inline bool is_strided_view (const teq::iTensor& tens)
+{
+	auto view = dynamic_cast<const TensView<T>*>(&tens.device());
+	return nullptr != view && false == view->is_contiguous() &&
+		view->is_strided_2d();
+}
+
+/// Matrix operator reading 2-d views in place as strided matrices
+template <typename T>
+struct StridedMatOp final : public iTmpEigen<T>
+{
+	using OpF = std::function<void(MatMapT<T>&,const std::vector<StridedMatMapT<T>>&)>;
+
+	StridedMatOp (const teq::Shape& outshape, const teq::CTensT& args, OpF op) :
+		outshape_(outshape), op_(op), args_(args) {}
+
+	/// Implementation of iEigen
+	void assign (size_t ttl, RTMemptrT& runtime) override
+	{
+		if (this->data_.is_expired())
+		{
+			this->data_.borrow(runtime, outshape_.n_elems(), ttl);
+		}
+		else
+		{
+			this->data_.extend_life(ttl);
+		}
+		auto out = make_matmap(this->data_.get(), outshape_);
+		std::vector<StridedMatMapT<T>> args;
+		std::vector<teq::Once<StridedMatMapT<T>>> onces;
+		args.reserve(args_.size());
+		onces.reserve(args_.size());
+		for (auto& arg : args_)
+		{
+			if (is_strided_view<T>(*arg))
+			{
+				onces.push_back(static_cast<const TensView<T>&>(
+					arg->device()).omatrix());
+			}
+			else
+			{
+				teq::Once<const void*> argdata = arg->device().odata();
+				assert(nullptr != argdata.get());
+				auto shape = arg->shape();
+				StridedMatMapT<T> mat((const T*) argdata.get(),
+					shape.at(1), shape.at(0),
+					Eigen::Stride<Eigen::Dynamic,Eigen::Dynamic>(shape.at(0), 1));
+				onces.push_back(teq::Once<StridedMatMapT<T>>(mat, std::move(argdata)));
+			}
+			args.push_back(onces.back().get());
+		}
+		op_(out, args);
+	}
+
+private:
+	teq::Shape outshape_;
+
+	OpF op_;
+
+	/// Tensor operator arguments
+	teq::CTensT args_;
+};
+
 template <typename T>
 struct TensAssign final : public iRefEigen
 {
@@ -543,6 +798,70 @@ private:
 	AssignF assign_;
 };
 
+/// Assignment of groups of arguments ordered by {target,gradient,states...}
+/// where every target and state is a mutable leaf updated in place
+/// by a single call to apply for each group
+template <typename T>
+struct TensApply final : public iRefEigen
+{
+	using ApplyF = std::function<void(std::vector<TensMapT<T>>&)>;
+
+	TensApply (const teq::TensptrsT& args, size_t group_size, ApplyF apply) :
+		iRefEigen(*args.front()), group_size_(group_size), apply_(apply)
+	{
+		args_.reserve(args.size());
+		std::transform(args.begin(), args.end(), std::back_inserter(args_),
+		[](teq::TensptrT arg)
+		{
+			return arg.get();
+		});
+	}
+
+	/// Implementation of iDeviceRef
+	void* data (void) override
+	{
+		return this->ref_->device().data();
+	}
+
+	/// Implementation of iDeviceRef
+	const void* data (void) const override
+	{
+		return this->ref_->device().data();
+	}
+
+	/// Implementation of iEigen
+	void assign (size_t ttl, RTMemptrT&) override
+	{
+		extend_life(ttl);
+		std::vector<TensMapT<T>> group;
+		group.reserve(group_size_);
+		for (size_t i = 0, n = args_.size(); i + group_size_ <= n; i += group_size_)
+		{
+			auto next_version = args_[i + 1]->get_meta().state_version() + 1;
+			group.clear();
+			for (size_t j = 0; j < group_size_; ++j)
+			{
+				teq::iTensor* arg = args_[i + j];
+				if (j != 1)
+				{
+					static_cast<iMutableLeaf*>(arg)->upversion(next_version);
+				}
+				group.push_back(make_tensmap(
+					(T*) arg->device().data(), arg->shape()));
+			}
+			apply_(group);
+		}
+	}
+
+private:
+	/// Grouped assignment arguments
+	teq::TensT args_;
+
+	size_t group_size_;
+
+	ApplyF apply_;
+};
+
 struct Device final : public teq::iDevice
 {
 	Device (size_t max_version = std::numeric_limits<size_t>::max()) :
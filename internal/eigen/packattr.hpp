@@ -17,6 +17,20 @@ using PairVecT = std::vector<std::pair<T,T>>;
 
 using OptDimsT = std::optional<teq::DimsT>;
 
+/// Scalar coefficients of an operator (e.g.: optimizer hyperparameters)
+using CoefsT = std::vector<double>;
+
+/// Storage type of symmetrically quantized values
+#ifdef EGEN_FULLTYPE
+using QuantT = int8_t;
+#else
+using QuantT = int32_t;
+#endif
+
+/// Largest magnitude of a quantized value, so products of quantized
+/// values accumulate in int32 without overflow for long dot products
+const int32_t quant_limit = 127;
+
 template <typename T>
 std::string to_string (const PairVecT<T>& pairs)
 {
@@ -351,6 +365,30 @@ struct Packer<teq::TensptrT>
 	}
 };
 
+template <>
+struct Packer<CoefsT>
+{
+	static std::string key_;
+
+	std::string get_key (void) const
+	{
+		return key_;
+	}
+
+	void pack (marsh::iAttributed& attrib, CoefsT coefs) const
+	{
+		attrib.add_attr(key_,
+			std::make_unique<marsh::NumArray<double>>(coefs));
+	}
+
+	void unpack (CoefsT& out, const marsh::iAttributed& attrib) const
+	{
+		auto attr = get_attr(*this, attrib);
+		auto& narr = static_cast<const marsh::NumArray<double>&>(*attr);
+		out = narr.contents_;
+	}
+};
+
 void pack_attr (marsh::iAttributed& attrib);
 
 template <typename T, typename ...ARGS>
@@ -362,6 +400,37 @@ void pack_attr (marsh::iAttributed& attrib, T attr_val, ARGS... args)
 
 OptDimsT unpack_extend (teq::Shape inshape, const marsh::iAttributed& attrib);
 
+/// Populate pooling windows and strides from dimension pairs attribute
+/// where each pair is encoded as {window, stride} of corresponding rank
+/// Ranks without pairs have windows and strides of 1
+void unpack_pool (teq::ShapeT& windows, teq::ShapeT& strides,
+	const marsh::iAttributed& attrib);
+
+/// Strides and zero paddings of 2D convolution along width and height
+struct Conv2dAttrs final
+{
+	/// Strides along {width, height}
+	std::pair<teq::DimT,teq::DimT> strides_ = {1, 1};
+
+	/// Paddings along width (first) and height (second)
+	/// each encoded as {before, after}
+	std::pair<teq::DimT,teq::DimT> xpad_ = {0, 0};
+
+	std::pair<teq::DimT,teq::DimT> ypad_ = {0, 0};
+};
+
+/// Return 2D convolution attributes where dimensions attribute holds
+/// {width stride, height stride} and dimension pairs attribute holds
+/// {width padding, height padding}, defaulting to stride 1 and no padding
+Conv2dAttrs unpack_conv2d (const marsh::iAttributed& attrib);
+
+/// Return output shape of an optimizer update given argument shapes
+/// grouped by {target,gradient,states...} of group_size arguments each
+/// where gradient and states match their target shape, except the last
+/// state of each group which holds 1 element if has_step is true
+teq::Shape apply_shape (const std::string& opname,
+	const teq::ShapesT& shapes, size_t group_size, bool has_step = false);
+
 }
 
 #endif // EIGEN_PACKATTR_HPP
@@ -14,6 +14,7 @@
 
 #include "internal/eigen/device.hpp"
 #include "internal/eigen/packattr.hpp"
+#include "internal/eigen/sparse.hpp"
 
 namespace eigen
 {
@@ -37,6 +38,441 @@ inline std::array<T,N> dim_copy (std::vector<T> d)
 	return out;
 }
 
+/// Populate keep with shape where ranks are reduced to 1 and
+/// bcast with the broadcast that restores keep back to shape
+inline void reduce_broadcast (DimensionsT& keep, DimensionsT& bcast,
+	teq::Shape shape, const teq::RanksT& ranks)
+{
+	keep = shape_convert(shape);
+	std::fill(bcast.begin(), bcast.end(), 1);
+	for (teq::RankT rank : ranks)
+	{
+		bcast[rank] = keep[rank];
+		keep[rank] = 1;
+	}
+}
+
+/// Populate eigen windows and strides of pooling attributes
+inline void pool_windows (DimensionsT& windows, DimensionsT& strides,
+	const marsh::iAttributed& attrib)
+{
+	teq::ShapeT wins, strs;
+	unpack_pool(wins, strs, attrib);
+	std::copy(wins.begin(), wins.end(), windows.begin());
+	std::copy(strs.begin(), strs.end(), strides.begin());
+}
+
+/// Increment window offset in column-major order
+/// Return false once every offset in windows is visited
+inline bool next_offset (DimensionsT& offset, const DimensionsT& windows)
+{
+	for (size_t i = 0; i < teq::rank_cap; ++i)
+	{
+		if (++offset[i] < windows[i])
+		{
+			return true;
+		}
+		offset[i] = 0;
+	}
+	return false;
+}
+
+/// Populate stop indices of strided slice starting at offset
+/// that visits every pooled output coordinate
+inline void pool_stop (DimensionsT& stop, const DimensionsT& offset,
+	const DimensionsT& pooldims, const DimensionsT& strides)
+{
+	for (size_t i = 0; i < teq::rank_cap; ++i)
+	{
+		stop[i] = offset[i] + (pooldims[i] - 1) * strides[i] + 1;
+	}
+}
+
+/// Dimensions of 2D convolution between image of shape
+/// [in,width,height,batch] and kernel of shape [out,in,kwidth,kheight]
+struct Conv2dParams final
+{
+	Conv2dParams (teq::Shape imgshape, teq::Shape kernshape,
+		const marsh::iAttributed& attrib) :
+		nin_(imgshape.at(0)), width_(imgshape.at(1)),
+		height_(imgshape.at(2)), nbatch_(imgshape.at(3)),
+		nout_(kernshape.at(0)), kwidth_(kernshape.at(2)),
+		kheight_(kernshape.at(3))
+	{
+		Conv2dAttrs attrs = unpack_conv2d(attrib);
+		xstride_ = attrs.strides_.first;
+		ystride_ = attrs.strides_.second;
+		xpad_ = attrs.xpad_.first;
+		ypad_ = attrs.ypad_.first;
+		owidth_ = (width_ + attrs.xpad_.first +
+			attrs.xpad_.second - kwidth_) / xstride_ + 1;
+		oheight_ = (height_ + attrs.ypad_.first +
+			attrs.ypad_.second - kheight_) / ystride_ + 1;
+	}
+
+	/// Return number of elements in each image patch
+	Eigen::Index patch_size (void) const
+	{
+		return nin_ * kwidth_ * kheight_;
+	}
+
+	/// Return number of image patches across all batches
+	Eigen::Index npatches (void) const
+	{
+		return owidth_ * oheight_ * nbatch_;
+	}
+
+	/// Return true if image patches are exactly the image
+	bool is_pointwise (void) const
+	{
+		return 1 == kwidth_ && 1 == kheight_ &&
+			1 == xstride_ && 1 == ystride_ &&
+			width_ == owidth_ && height_ == oheight_;
+	}
+
+	Eigen::Index nin_;
+
+	Eigen::Index width_;
+
+	Eigen::Index height_;
+
+	Eigen::Index nbatch_;
+
+	Eigen::Index nout_;
+
+	Eigen::Index kwidth_;
+
+	Eigen::Index kheight_;
+
+	Eigen::Index owidth_;
+
+	Eigen::Index oheight_;
+
+	Eigen::Index xstride_;
+
+	Eigen::Index ystride_;
+
+	Eigen::Index xpad_;
+
+	Eigen::Index ypad_;
+};
+
+/// Copy every kernel-sized patch of img into a row of cols (im2col)
+/// such that cols is a [npatches,patch_size] row-major matrix
+/// Zero paddings are written into cols without padding img
+template <typename T>
+void im2col (T* cols, const T* img, const Conv2dParams& p)
+{
+	Eigen::Index nin = p.nin_;
+	for (Eigen::Index b = 0; b < p.nbatch_; ++b)
+	{
+		const T* bimg = img + b * nin * p.width_ * p.height_;
+		for (Eigen::Index oy = 0; oy < p.oheight_; ++oy)
+		{
+			for (Eigen::Index ox = 0; ox < p.owidth_; ++ox)
+			{
+				for (Eigen::Index ky = 0; ky < p.kheight_; ++ky)
+				{
+					Eigen::Index iy = oy * p.ystride_ + ky - p.ypad_;
+					for (Eigen::Index kx = 0; kx < p.kwidth_; ++kx, cols += nin)
+					{
+						Eigen::Index ix = ox * p.xstride_ + kx - p.xpad_;
+						if (iy < 0 || iy >= p.height_ || ix < 0 || ix >= p.width_)
+						{
+							std::fill(cols, cols + nin, (T) 0);
+							continue;
+						}
+						const T* pixel = bimg + (ix + iy * p.width_) * nin;
+						std::copy(pixel, pixel + nin, cols);
+					}
+				}
+			}
+		}
+	}
+}
+
+/// Accumulate every row of cols into its kernel-sized patch of img (col2im)
+/// This function is the adjoint of im2col
+template <typename T>
+void col2im (T* img, const T* cols, const Conv2dParams& p)
+{
+	Eigen::Index nin = p.nin_;
+	std::fill(img, img + nin * p.width_ * p.height_ * p.nbatch_, (T) 0);
+	for (Eigen::Index b = 0; b < p.nbatch_; ++b)
+	{
+		T* bimg = img + b * nin * p.width_ * p.height_;
+		for (Eigen::Index oy = 0; oy < p.oheight_; ++oy)
+		{
+			for (Eigen::Index ox = 0; ox < p.owidth_; ++ox)
+			{
+				for (Eigen::Index ky = 0; ky < p.kheight_; ++ky)
+				{
+					Eigen::Index iy = oy * p.ystride_ + ky - p.ypad_;
+					for (Eigen::Index kx = 0; kx < p.kwidth_; ++kx, cols += nin)
+					{
+						Eigen::Index ix = ox * p.xstride_ + kx - p.xpad_;
+						if (iy < 0 || iy >= p.height_ || ix < 0 || ix >= p.width_)
+						{
+							continue;
+						}
+						T* pixel = bimg + (ix + iy * p.width_) * nin;
+						for (Eigen::Index i = 0; i < nin; ++i)
+						{
+							pixel[i] += cols[i];
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+/// Dimensions of fused recurrent cells where input has shape [indim,...],
+/// states have shape [hidden,...] and weights of every gate are
+/// concatenated along the first dimension into shape [ngates*hidden,indim+hidden]
+struct CellParams final
+{
+	CellParams (teq::Shape inshape, teq::Shape stateshape) :
+		indim_(inshape.at(0)), hidden_(stateshape.at(0)),
+		nbatch_(stateshape.n_elems() / stateshape.at(0)) {}
+
+	Eigen::Index indim_;
+
+	Eigen::Index hidden_;
+
+	/// Number of input vectors processed by the cell at once
+	Eigen::Index nbatch_;
+};
+
+template <typename T>
+using RowMapT = Eigen::Map<Eigen::Matrix<T,1,Eigen::Dynamic>>;
+
+/// Populate gates as [nbatch,4*hidden] row-major matrix of activated
+/// LSTM gates ordered {candidate,forget,input,output} from one GEMM
+/// against input and one against hidden instead of concatenating them
+template <typename T>
+void lstm_gates (MatrixT<T>& gates, T* input, T* hidden,
+	T* weight, T* bias, const CellParams& p)
+{
+	Eigen::Index hid = p.hidden_;
+	MatMapT<T> w(weight, p.indim_ + hid, 4 * hid);
+	gates.noalias() = MatMapT<T>(input, p.nbatch_, p.indim_) * w.topRows(p.indim_);
+	gates.noalias() += MatMapT<T>(hidden, p.nbatch_, hid) * w.bottomRows(hid);
+	if (nullptr != bias)
+	{
+		gates.rowwise() += RowMapT<T>(bias, 4 * hid);
+	}
+	gates.leftCols(hid) = gates.leftCols(hid).unaryExpr(
+		Eigen::internal::scalar_tanh_op<T>());
+	gates.rightCols(3 * hid) = gates.rightCols(3 * hid).unaryExpr(
+		Eigen::internal::scalar_logistic_op<T>());
+}
+
+/// Populate out as [nbatch,2*hidden] row-major matrix holding
+/// {next state,next hidden} of LSTM cell
+template <typename T>
+void lstm_cell (T* out, T* input, T* hidden, T* state,
+	T* weight, T* bias, const CellParams& p)
+{
+	Eigen::Index hid = p.hidden_;
+	MatrixT<T> gates(p.nbatch_, 4 * hid);
+	lstm_gates(gates, input, hidden, weight, bias, p);
+	MatMapT<T> outmat(out, p.nbatch_, 2 * hid);
+	MatMapT<T> prev(state, p.nbatch_, hid);
+	outmat.leftCols(hid).array() =
+		gates.leftCols(hid).array() * gates.middleCols(2 * hid, hid).array() +
+		prev.array() * gates.middleCols(hid, hid).array();
+	outmat.rightCols(hid).array() =
+		outmat.leftCols(hid).array() * gates.rightCols(hid).array();
+}
+
+/// Populate dgates with gradient of LSTM gates before activation and
+/// dstate with gradient of previous state given supgrad,
+/// the gradient of {next state,next hidden}
+template <typename T>
+void lstm_cell_grad (MatrixT<T>& dgates, MatrixT<T>& dstate,
+	T* input, T* hidden, T* state, T* weight, T* bias,
+	T* supgrad, const CellParams& p)
+{
+	Eigen::Index hid = p.hidden_;
+	MatrixT<T> gates(p.nbatch_, 4 * hid);
+	lstm_gates(gates, input, hidden, weight, bias, p);
+	auto cand = gates.leftCols(hid).array();
+	auto forget = gates.middleCols(hid, hid).array();
+	auto in = gates.middleCols(2 * hid, hid).array();
+	auto out = gates.rightCols(hid).array();
+
+	MatMapT<T> prev(state, p.nbatch_, hid);
+	MatMapT<T> grad(supgrad, p.nbatch_, 2 * hid);
+	MatrixT<T> next = (cand * in + prev.array() * forget).matrix();
+	// next hidden = next state * out gate, so next state collects both grads
+	dstate = (grad.leftCols(hid).array() +
+		grad.rightCols(hid).array() * out).matrix();
+
+	dgates.resize(p.nbatch_, 4 * hid);
+	dgates.leftCols(hid).array() =
+		dstate.array() * in * ((T) 1 - cand * cand);
+	dgates.middleCols(hid, hid).array() =
+		dstate.array() * prev.array() * forget * ((T) 1 - forget);
+	dgates.middleCols(2 * hid, hid).array() =
+		dstate.array() * cand * in * ((T) 1 - in);
+	dgates.rightCols(hid).array() =
+		grad.rightCols(hid).array() * next.array() * out * ((T) 1 - out);
+	dstate.array() *= forget;
+}
+
+/// Populate gates as [nbatch,3*hidden] row-major matrix of activated
+/// GRU gates ordered {update,reset,candidate} and reset with the
+/// reset gate applied to state, which the candidate gate reads instead of state
+template <typename T>
+void gru_gates (MatrixT<T>& gates, MatrixT<T>& reset,
+	T* input, T* state, T* weight, T* bias, const CellParams& p)
+{
+	Eigen::Index hid = p.hidden_;
+	MatMapT<T> w(weight, p.indim_ + hid, 3 * hid);
+	MatMapT<T> prev(state, p.nbatch_, hid);
+	auto wstate = w.bottomRows(hid);
+	gates.noalias() = MatMapT<T>(input, p.nbatch_, p.indim_) * w.topRows(p.indim_);
+	gates.leftCols(2 * hid).noalias() += prev * wstate.leftCols(2 * hid);
+	if (nullptr != bias)
+	{
+		gates.rowwise() += RowMapT<T>(bias, 3 * hid);
+	}
+	gates.leftCols(2 * hid) = gates.leftCols(2 * hid).unaryExpr(
+		Eigen::internal::scalar_logistic_op<T>());
+	reset = (gates.middleCols(hid, hid).array() * prev.array()).matrix();
+	gates.rightCols(hid).noalias() += reset * wstate.rightCols(hid);
+	gates.rightCols(hid) = gates.rightCols(hid).unaryExpr(
+		Eigen::internal::scalar_tanh_op<T>());
+}
+
+/// Populate out as [nbatch,hidden] row-major matrix holding next state of GRU cell
+template <typename T>
+void gru_cell (T* out, T* input, T* state,
+	T* weight, T* bias, const CellParams& p)
+{
+	Eigen::Index hid = p.hidden_;
+	MatrixT<T> gates(p.nbatch_, 3 * hid);
+	MatrixT<T> reset(p.nbatch_, hid);
+	gru_gates(gates, reset, input, state, weight, bias, p);
+	auto update = gates.leftCols(hid).array();
+	MatMapT<T>(out, p.nbatch_, hid).array() =
+		update * MatMapT<T>(state, p.nbatch_, hid).array() +
+		((T) 1 - update) * gates.rightCols(hid).array();
+}
+
+/// Populate dgates with gradient of GRU gates before activation,
+/// dstate with gradient of previous state and reset with
+/// the reset gate applied to state given supgrad, the gradient of next state
+template <typename T>
+void gru_cell_grad (MatrixT<T>& dgates, MatrixT<T>& dstate, MatrixT<T>& reset,
+	T* input, T* state, T* weight, T* bias, T* supgrad, const CellParams& p)
+{
+	Eigen::Index hid = p.hidden_;
+	MatrixT<T> gates(p.nbatch_, 3 * hid);
+	gru_gates(gates, reset, input, state, weight, bias, p);
+	auto update = gates.leftCols(hid).array();
+	auto rgate = gates.middleCols(hid, hid).array();
+	auto cand = gates.rightCols(hid).array();
+
+	MatMapT<T> w(weight, p.indim_ + hid, 3 * hid);
+	MatMapT<T> prev(state, p.nbatch_, hid);
+	MatMapT<T> grad(supgrad, p.nbatch_, hid);
+	auto wstate = w.bottomRows(hid);
+
+	dgates.resize(p.nbatch_, 3 * hid);
+	dgates.leftCols(hid).array() = grad.array() *
+		(prev.array() - cand) * update * ((T) 1 - update);
+	dgates.rightCols(hid).array() = grad.array() *
+		((T) 1 - update) * ((T) 1 - cand * cand);
+	MatrixT<T> dreset = dgates.rightCols(hid) * wstate.rightCols(hid).transpose();
+	dgates.middleCols(hid, hid).array() = dreset.array() *
+		prev.array() * rgate * ((T) 1 - rgate);
+
+	dstate = (grad.array() * update + dreset.array() * rgate).matrix();
+	dstate.noalias() += dgates.leftCols(2 * hid) *
+		wstate.leftCols(2 * hid).transpose();
+}
+
+/// Fatal if any argument of quantized operator opname
+/// does not hold QuantT values
+inline void check_quantized (const std::string& opname,
+	const teq::CTensT& args)
+{
+	auto qtype = egen::get_type<QuantT>();
+	for (auto arg : args)
+	{
+		auto argtype = (egen::_GENERATED_DTYPE) arg->get_meta().type_code();
+		if (argtype != qtype)
+		{
+			global::fatalf("cannot %s argument of type %s (requires %s)",
+				opname.c_str(), egen::name_type(argtype).c_str(),
+				egen::name_type(qtype).c_str());
+		}
+	}
+}
+
+/// Return multipliers of n output channels given coefficients attribute
+/// holding either one multiplier for every channel or one per channel
+inline Eigen::VectorXd quant_multipliers (
+	const marsh::iAttributed& attrib, Eigen::Index n)
+{
+	CoefsT coefs;
+	Packer<CoefsT>().unpack(coefs, attrib);
+	if (1 == coefs.size())
+	{
+		return Eigen::VectorXd::Constant(n, coefs.front());
+	}
+	if ((size_t) n != coefs.size())
+	{
+		global::fatalf("cannot rescale %d channels with %d multipliers",
+			n, coefs.size());
+	}
+	return Eigen::Map<const Eigen::VectorXd>(coefs.data(), n);
+}
+
+/// Sizes of blocks of a shape around dimension dim,
+/// where elements at index i of dim are at inner_ * (i + n_ * o) + j
+/// for every outer index o and inner index j
+struct IndexBlocks final
+{
+	IndexBlocks (teq::Shape shape, teq::RankT dim) :
+		inner_(std::accumulate(shape.begin(), shape.begin() + dim,
+			(size_t) 1, std::multiplies<size_t>())),
+		n_(shape.at(dim)),
+		outer_(shape.n_elems() / (inner_ * n_)) {}
+
+	size_t inner_;
+
+	size_t n_;
+
+	size_t outer_;
+};
+
+/// Return indices held by tensor, fatal if any index is outside [0,limit)
+inline std::vector<size_t> read_indices (const std::string& opname,
+	const teq::iTensor& indices, size_t limit)
+{
+	size_t n = indices.shape().n_elems();
+	std::vector<double> raw(n);
+	{
+		teq::Once<const void*> data = indices.device().odata();
+		egen::type_convert(raw.data(), data.get(),
+			(egen::_GENERATED_DTYPE) indices.get_meta().type_code(), n);
+	}
+	std::vector<size_t> out(n);
+	for (size_t i = 0; i < n; ++i)
+	{
+		if (raw[i] < 0 || raw[i] >= limit)
+		{
+			global::fatalf("cannot %s with index %f outside of [0,%d)",
+				opname.c_str(), raw[i], limit);
+		}
+		out[i] = raw[i];
+	}
+	return out;
+}
+
 }
 
 #define _ARRAY_SWITCH(ARR, CASE)switch (ARR.size()) {\
@@ -54,7 +490,8 @@ inline std::array<T,N> dim_copy (std::vector<T> d)
 #define _EIGEN_RSUM_CASE(ARR, N)\
 return std::make_shared<PermTensOp<T>>(outshape,teq::CTensT{&in},\
 [ARR,outdims](TensorT<T>& out, const std::vector<TensMapT<T>>& args){\
-	out = args[0].sum(::eigen::internal::dim_copy<N>(ARR)).reshape(outdims);\
+	out = args[0].template cast<AccumT<T>>().sum(::eigen::internal::dim_copy<N>(ARR))\
+		.template cast<T>().reshape(outdims);\
 });
 
 /// Return Eigen data object representing reduction where aggregation is sum
@@ -74,7 +511,8 @@ EigenptrT reduce_sum (teq::Shape outshape, const teq::iTensor& in, const marsh::
 #define _EIGEN_RPROD_CASE(ARR, N)\
 return std::make_shared<PermTensOp<T>>(outshape,teq::CTensT{&in},\
 [ARR,outdims](TensorT<T>& out, const std::vector<TensMapT<T>>& args){\
-	out = args[0].prod(::eigen::internal::dim_copy<N>(ARR)).reshape(outdims);\
+	out = args[0].template cast<AccumT<T>>().prod(::eigen::internal::dim_copy<N>(ARR))\
+		.template cast<T>().reshape(outdims);\
 });
 
 /// Return Eigen data object representing reduction where aggregation is prod
@@ -154,6 +592,197 @@ EigenptrT argmax (teq::Shape outshape, const teq::iTensor& in, const marsh::iAtt
 	});
 }
 
+#define _EIGEN_SOFTMAX_CASE(ARR, N)\
+return std::make_shared<PermTensOp<T>>(outshape,teq::CTensT{&in},\
+[ARR,keepdims,bcast](TensorT<T>& out, const std::vector<TensMapT<T>>& args){\
+	auto red = ::eigen::internal::dim_copy<N>(ARR);\
+	TensorT<T> mx = args[0].maximum(red).reshape(keepdims);\
+	out = (args[0] - mx.broadcast(bcast)).exp();\
+	TensorT<T> total = out.sum(red).reshape(keepdims);\
+	out = out / total.broadcast(bcast);\
+});
+
+/// Return Eigen data object representing softmax normalized across ranks
+/// Maximum across ranks is subtracted before exponentiation to avoid overflow
+template <typename T>
+EigenptrT softmax (teq::Shape outshape, const teq::iTensor& in, const marsh::iAttributed& attrib)
+{
+	std::set<teq::RankT> ranks;
+	Packer<std::set<teq::RankT>>().unpack(ranks, attrib);
+	teq::RanksT vranks(ranks.begin(), ranks.end());
+
+	DimensionsT keepdims, bcast;
+	internal::reduce_broadcast(keepdims, bcast, outshape, vranks);
+	_ARRAY_SWITCH(vranks, _EIGEN_SOFTMAX_CASE)
+}
+
+#undef _EIGEN_SOFTMAX_CASE
+
+#define _EIGEN_LOG_SOFTMAX_CASE(ARR, N)\
+return std::make_shared<PermTensOp<T>>(outshape,teq::CTensT{&in},\
+[ARR,keepdims,bcast](TensorT<T>& out, const std::vector<TensMapT<T>>& args){\
+	auto red = ::eigen::internal::dim_copy<N>(ARR);\
+	TensorT<T> mx = args[0].maximum(red).reshape(keepdims);\
+	out = args[0] - mx.broadcast(bcast);\
+	TensorT<T> lse = out.exp().sum(red).log().reshape(keepdims);\
+	out = out - lse.broadcast(bcast);\
+});
+
+/// Return Eigen data object representing log of softmax across ranks
+/// computed as (in - max) - log(sum(exp(in - max)))
+template <typename T>
+EigenptrT log_softmax (teq::Shape outshape, const teq::iTensor& in, const marsh::iAttributed& attrib)
+{
+	std::set<teq::RankT> ranks;
+	Packer<std::set<teq::RankT>>().unpack(ranks, attrib);
+	teq::RanksT vranks(ranks.begin(), ranks.end());
+
+	DimensionsT keepdims, bcast;
+	internal::reduce_broadcast(keepdims, bcast, outshape, vranks);
+	_ARRAY_SWITCH(vranks, _EIGEN_LOG_SOFTMAX_CASE)
+}
+
+#undef _EIGEN_LOG_SOFTMAX_CASE
+
+#define _EIGEN_SOFTMAX_XENT_CASE(ARR, N)\
+return std::make_shared<PermTensOp<T>>(outshape,teq::CTensT{&labels,&logits},\
+[ARR,keepdims,bcast](TensorT<T>& out, const std::vector<TensMapT<T>>& args){\
+	auto red = ::eigen::internal::dim_copy<N>(ARR);\
+	TensorT<T> mx = args[1].maximum(red).reshape(keepdims);\
+	TensorT<T> lse = (args[1] - mx.broadcast(bcast)).exp().sum(red).log().reshape(keepdims);\
+	out = (args[0] * ((lse + mx).broadcast(bcast) - args[1])).sum(red).reshape(keepdims);\
+});
+
+/// Return Eigen data object representing cross entropy between labels and
+/// softmax of logits across ranks, reducing ranks by sum
+/// Logits are never normalized into an intermediate softmax, so
+/// -labels * log_softmax(logits) is evaluated in a single reduction
+template <typename T>
+EigenptrT softmax_cross_entropy (teq::Shape outshape, const teq::iTensor& labels,
+	const teq::iTensor& logits, const marsh::iAttributed& attrib)
+{
+	std::set<teq::RankT> ranks;
+	Packer<std::set<teq::RankT>>().unpack(ranks, attrib);
+	teq::RanksT vranks(ranks.begin(), ranks.end());
+
+	DimensionsT keepdims, bcast;
+	internal::reduce_broadcast(keepdims, bcast, logits.shape(), vranks);
+	_ARRAY_SWITCH(vranks, _EIGEN_SOFTMAX_XENT_CASE)
+}
+
+#undef _EIGEN_SOFTMAX_XENT_CASE
+
+/// Return Eigen data object representing maximum within each pooling window
+/// Each window offset is read as a strided slice of in, so
+/// pooling never materializes intermediate copies of in
+template <typename T>
+EigenptrT max_pool (teq::Shape outshape, const teq::iTensor& in, const marsh::iAttributed& attrib)
+{
+	DimensionsT windows, strides;
+	internal::pool_windows(windows, strides, attrib);
+
+	DimensionsT outdims = shape_convert(outshape);
+	return std::make_shared<PermTensOp<T>>(outshape,teq::CTensT{&in},
+	[windows,strides,outdims](TensorT<T>& out, const std::vector<TensMapT<T>>& args)
+	{
+		DimensionsT offset, stop;
+		std::fill(offset.begin(), offset.end(), 0);
+		internal::pool_stop(stop, offset, outdims, strides);
+		out = args[0].stridedSlice(offset, stop, strides);
+		while (internal::next_offset(offset, windows))
+		{
+			internal::pool_stop(stop, offset, outdims, strides);
+			out = out.cwiseMax(args[0].stridedSlice(offset, stop, strides));
+		}
+	});
+}
+
+/// Return Eigen data object representing mean within each pooling window
+template <typename T>
+EigenptrT avg_pool (teq::Shape outshape, const teq::iTensor& in, const marsh::iAttributed& attrib)
+{
+	DimensionsT windows, strides;
+	internal::pool_windows(windows, strides, attrib);
+
+	T nwindow = (T) std::accumulate(windows.begin(), windows.end(),
+		(Eigen::Index) 1, std::multiplies<Eigen::Index>());
+	DimensionsT outdims = shape_convert(outshape);
+	return std::make_shared<PermTensOp<T>>(outshape,teq::CTensT{&in},
+	[windows,strides,outdims,nwindow](TensorT<T>& out, const std::vector<TensMapT<T>>& args)
+	{
+		DimensionsT offset, stop;
+		std::fill(offset.begin(), offset.end(), 0);
+		internal::pool_stop(stop, offset, outdims, strides);
+		out = args[0].stridedSlice(offset, stop, strides);
+		while (internal::next_offset(offset, windows))
+		{
+			internal::pool_stop(stop, offset, outdims, strides);
+			out += args[0].stridedSlice(offset, stop, strides);
+		}
+		out = out / nwindow;
+	});
+}
+
+/// Return Eigen data object that scatters supgrad of max_pool to the
+/// first element of each window in that equals the pooled maximum
+template <typename T>
+EigenptrT max_pool_grad (teq::Shape outshape, const teq::iTensor& in,
+	const teq::iTensor& pooled, const teq::iTensor& supgrad,
+	const marsh::iAttributed& attrib)
+{
+	DimensionsT windows, strides;
+	internal::pool_windows(windows, strides, attrib);
+
+	DimensionsT pooldims = shape_convert(pooled.shape());
+	return std::make_shared<PermTensOp<T>>(outshape,teq::CTensT{&in,&pooled,&supgrad},
+	[windows,strides,pooldims](TensorT<T>& out, const std::vector<TensMapT<T>>& args)
+	{
+		// pending is 1 where a window has yet to route its gradient
+		TensorT<T> pending(pooldims);
+		pending.setConstant((T) 1);
+		out.setZero();
+		DimensionsT offset, stop;
+		std::fill(offset.begin(), offset.end(), 0);
+		do
+		{
+			internal::pool_stop(stop, offset, pooldims, strides);
+			TensorT<T> hit = pending * (args[0].stridedSlice(
+				offset, stop, strides) == args[1]).template cast<T>();
+			out.stridedSlice(offset, stop, strides) += hit * args[2];
+			pending -= hit;
+		}
+		while (internal::next_offset(offset, windows));
+	});
+}
+
+/// Return Eigen data object that spreads supgrad of avg_pool
+/// evenly across each window
+template <typename T>
+EigenptrT avg_pool_grad (teq::Shape outshape, const teq::iTensor& supgrad,
+	const marsh::iAttributed& attrib)
+{
+	DimensionsT windows, strides;
+	internal::pool_windows(windows, strides, attrib);
+
+	T nwindow = (T) std::accumulate(windows.begin(), windows.end(),
+		(Eigen::Index) 1, std::multiplies<Eigen::Index>());
+	DimensionsT pooldims = shape_convert(supgrad.shape());
+	return std::make_shared<PermTensOp<T>>(outshape,teq::CTensT{&supgrad},
+	[windows,strides,pooldims,nwindow](TensorT<T>& out, const std::vector<TensMapT<T>>& args)
+	{
+		out.setZero();
+		DimensionsT offset, stop;
+		std::fill(offset.begin(), offset.end(), 0);
+		do
+		{
+			internal::pool_stop(stop, offset, pooldims, strides);
+			out.stridedSlice(offset, stop, strides) += args[0];
+		}
+		while (internal::next_offset(offset, windows));
+		out = out / nwindow;
+	});
+}
+
 /// Return Eigen data object representing data broadcast across dimensions
 template <typename T>
 EigenptrT extend (teq::Shape outshape, const teq::iTensor& in, const marsh::iAttributed& attrib)
@@ -313,6 +942,64 @@ EigenptrT scatter (teq::Shape outshape, const teq::iTensor& in, const marsh::iAt
 	});
 }
 
+/// Return Eigen data object selecting slices of params
+/// at every index in indices along dimension attribute
+template <typename T>
+EigenptrT gather (teq::Shape outshape, const teq::iTensor& params,
+	const teq::iTensor& indices, const marsh::iAttributed& attrib)
+{
+	teq::RankT dim;
+	Packer<teq::RankT>().unpack(dim, attrib);
+	internal::IndexBlocks blocks(params.shape(), dim);
+	return std::make_shared<PermTensOp<T>>(outshape, teq::CTensT{&params},
+	[blocks,&indices](TensorT<T>& out, const std::vector<TensMapT<T>>& args)
+	{
+		auto idx = internal::read_indices("GATHER", indices, blocks.n_);
+		size_t nidx = idx.size();
+		const T* in = args[0].data();
+		T* dst = out.data();
+		for (size_t o = 0; o < blocks.outer_; ++o)
+		{
+			for (size_t i = 0; i < nidx; ++i)
+			{
+				const T* src = in + blocks.inner_ * (idx[i] + blocks.n_ * o);
+				std::copy(src, src + blocks.inner_,
+					dst + blocks.inner_ * (i + nidx * o));
+			}
+		}
+	});
+}
+
+/// Return Eigen data object adding slices of updates into zeros of outshape
+/// at every index in indices along dimension attribute
+/// This function is the reverse of gather
+template <typename T>
+EigenptrT scatter_add (teq::Shape outshape, const teq::iTensor& updates,
+	const teq::iTensor& indices, const marsh::iAttributed& attrib)
+{
+	teq::RankT dim;
+	Packer<teq::RankT>().unpack(dim, attrib);
+	internal::IndexBlocks blocks(outshape, dim);
+	return std::make_shared<PermTensOp<T>>(outshape, teq::CTensT{&updates},
+	[blocks,&indices](TensorT<T>& out, const std::vector<TensMapT<T>>& args)
+	{
+		auto idx = internal::read_indices("SCATTER_ADD", indices, blocks.n_);
+		size_t nidx = idx.size();
+		const T* src = args[0].data();
+		T* dst = out.data();
+		out.setZero();
+		for (size_t o = 0; o < blocks.outer_; ++o)
+		{
+			for (size_t i = 0; i < nidx; ++i)
+			{
+				internal::RowMapT<T>(dst + blocks.inner_ * (idx[i] + blocks.n_ * o),
+					blocks.inner_) += internal::RowMapT<T>(
+					(T*) src + blocks.inner_ * (i + nidx * o), blocks.inner_);
+			}
+		}
+	});
+}
+
 template <typename T>
 EigenptrT reverse (teq::Shape outshape, const teq::iTensor& in, const marsh::iAttributed& attrib)
 {
@@ -438,7 +1125,7 @@ EigenptrT sin (teq::Shape outshape, const teq::iTensor& in)
 		out = args[0].unaryExpr(std::function<T(const T&)>(
 		[](const T& a) -> T
 		{
-			return std::sin(a);
+			return (T) std::sin(a);
 		}));
 	});
 }
@@ -468,7 +1155,7 @@ EigenptrT cos (teq::Shape outshape, const teq::iTensor& in)
 		out = args[0].unaryExpr(std::function<T(const T&)>(
 		[](const T& a) -> T
 		{
-			return std::cos(a);
+			return (T) std::cos(a);
 		}));
 	});
 }
@@ -493,7 +1180,7 @@ EigenptrT tan (teq::Shape outshape, const teq::iTensor& in)
 		out = args[0].unaryExpr(std::function<T(const T&)>(
 		[](const T& a) -> T
 		{
-			return std::tan(a);
+			return (T) std::tan(a);
 		}));
 	});
 }
@@ -591,7 +1278,7 @@ EigenptrT sigmoid (teq::Shape outshape, const teq::iTensor& in)
 		return std::make_shared<PermMatOp<T>>(outshape,teq::CTensT{&in},
 		[](MatrixT<T>& out, const std::vector<MatMapT<T>>& args)
 		{
-			out = args[0].unaryExpr(Eigen::internal::scalar_sigmoid_op<T>());
+			out = args[0].unaryExpr(Eigen::internal::scalar_logistic_op<T>());
 		});
 	}
 	return std::make_shared<PermTensOp<T>>(outshape,teq::CTensT{&in},
@@ -674,7 +1361,7 @@ EigenptrT pow (teq::Shape outshape, const teq::iTensor& a, const teq::iTensor& b
 			std::function<T(const T&,const T&)>(
 			[](const T& a, const T& b) -> T
 			{
-				return std::pow(a, b);
+				return (T) std::pow(a, b);
 			}));
 		});
 	}
@@ -685,7 +1372,7 @@ EigenptrT pow (teq::Shape outshape, const teq::iTensor& a, const teq::iTensor& b
 		std::function<T(const T&,const T&)>(
 		[](const T& a, const T& b) -> T
 		{
-			return std::pow(a, b);
+			return (T) std::pow(a, b);
 		}));
 	});
 }
@@ -832,7 +1519,7 @@ EigenptrT eq (teq::Shape outshape, const teq::iTensor& a, const teq::iTensor& b)
 			std::function<T(const T&,const T&)>(
 			[](const T& a, const T& b) -> T
 			{
-				return a == b;
+				return (T) (a == b);
 			}));
 		});
 	}
@@ -843,7 +1530,7 @@ EigenptrT eq (teq::Shape outshape, const teq::iTensor& a, const teq::iTensor& b)
 		std::function<T(const T&,const T&)>(
 		[](const T& a, const T& b) -> T
 		{
-			return a == b;
+			return (T) (a == b);
 		}));
 	});
 }
@@ -864,7 +1551,7 @@ EigenptrT neq (teq::Shape outshape, const teq::iTensor& a, const teq::iTensor& b
 			std::function<T(const T&,const T&)>(
 			[](const T& a, const T& b) -> T
 			{
-				return a != b;
+				return (T) (a != b);
 			}));
 		});
 	}
@@ -875,7 +1562,7 @@ EigenptrT neq (teq::Shape outshape, const teq::iTensor& a, const teq::iTensor& b
 		std::function<T(const T&,const T&)>(
 		[](const T& a, const T& b) -> T
 		{
-			return a != b;
+			return (T) (a != b);
 		}));
 	});
 }
@@ -896,7 +1583,7 @@ EigenptrT lt (teq::Shape outshape, const teq::iTensor& a, const teq::iTensor& b)
 			std::function<T(const T&,const T&)>(
 			[](const T& a, const T& b) -> T
 			{
-				return a < b;
+				return (T) (a < b);
 			}));
 		});
 	}
@@ -907,7 +1594,7 @@ EigenptrT lt (teq::Shape outshape, const teq::iTensor& a, const teq::iTensor& b)
 		std::function<T(const T&,const T&)>(
 		[](const T& a, const T& b) -> T
 		{
-			return a < b;
+			return (T) (a < b);
 		}));
 	});
 }
@@ -928,7 +1615,7 @@ EigenptrT gt (teq::Shape outshape, const teq::iTensor& a, const teq::iTensor& b)
 			std::function<T(const T&,const T&)>(
 			[](const T& a, const T& b) -> T
 			{
-				return a > b;
+				return (T) (a > b);
 			}));
 		});
 	}
@@ -939,7 +1626,7 @@ EigenptrT gt (teq::Shape outshape, const teq::iTensor& a, const teq::iTensor& b)
 		std::function<T(const T&,const T&)>(
 		[](const T& a, const T& b) -> T
 		{
-			return a > b;
+			return (T) (a > b);
 		}));
 	});
 }
@@ -987,59 +1674,18 @@ EigenptrT max (teq::Shape outshape, const teq::iTensor& a, const teq::iTensor& b
 }
 
 /// Given arguments a, and b, for every pair of mapped elements sharing the
-/// same index apply std::uniform_distributon function
+/// same index generate a value uniformly between the pair
+/// Values are filled in bulk from a stream split for this operator
 /// Only accept 2 arguments
-template <typename T, typename std::enable_if<std::is_integral<T>::value>::type* = nullptr>
-EigenptrT rand_uniform (teq::Shape outshape, const teq::iTensor& a, const teq::iTensor& b)
-{
-	if (is_2d(outshape))
-	{
-		// use matrix when possible
-		return std::make_shared<PermMatOp<T>>(outshape,teq::CTensT{&a,&b},
-		[](MatrixT<T>& out, const std::vector<MatMapT<T>>& args)
-		{
-			auto generator = global::get_generator();
-			out = args[0].binaryExpr(args[1],
-			std::function<T(const T&,const T&)>(
-			[&generator](const T& a, const T& b)
-			{ return generator->unif_int(a, b); }));
-		});
-	}
-	return std::make_shared<PermTensOp<T>>(outshape,teq::CTensT{&a,&b},
-	[](TensorT<T>& out, const std::vector<TensMapT<T>>& args)
-	{
-		auto generator = global::get_generator();
-		out = args[0].binaryExpr(args[1],
-		std::function<T(const T&,const T&)>(
-		[&generator](const T& a, const T& b)
-		{ return generator->unif_int(a, b); }));
-	});
-}
-
-template <typename T, typename std::enable_if<!std::is_integral<T>::value>::type* = nullptr>
+template <typename T>
 EigenptrT rand_uniform (teq::Shape outshape, const teq::iTensor& a, const teq::iTensor& b)
 {
-	if (is_2d(outshape))
-	{
-		// use matrix when possible
-		return std::make_shared<PermMatOp<T>>(outshape,teq::CTensT{&a,&b},
-		[](MatrixT<T>& out, const std::vector<MatMapT<T>>& args)
-		{
-			auto generator = global::get_generator();
-			out = args[0].binaryExpr(args[1],
-			std::function<T(const T&,const T&)>(
-			[&generator](const T& a, const T& b)
-			{ return generator->unif_dec(a, b); }));
-		});
-	}
+	auto generator = global::split_generator(global::get_generator());
 	return std::make_shared<PermTensOp<T>>(outshape,teq::CTensT{&a,&b},
-	[](TensorT<T>& out, const std::vector<TensMapT<T>>& args)
+	[generator](TensorT<T>& out, const std::vector<TensMapT<T>>& args)
 	{
-		auto generator = global::get_generator();
-		out = args[0].binaryExpr(args[1],
-		std::function<T(const T&,const T&)>(
-		[&generator](const T& a, const T& b)
-		{ return generator->unif_dec(a, b); }));
+		global::unif_fill<T>(*generator, out.data(),
+			args[0].data(), args[1].data(), out.size());
 	});
 }
 
@@ -1069,7 +1715,9 @@ EigenptrT select (teq::Shape outshape, const teq::iTensor& condition,
 #define _EIGEN_MATMUL_CASE(ARR, N)\
 return std::make_shared<PermTensOp<T>>(outshape,teq::CTensT{&a,&b},\
 [ARR,outdims](TensorT<T>& out, const std::vector<TensMapT<T>>& args){\
-	out = args[1].contract(args[0], internal::dim_copy<N>(ARR)).reshape(outdims);\
+	out = args[1].template cast<AccumT<T>>().contract(\
+		args[0].template cast<AccumT<T>>(), internal::dim_copy<N>(ARR))\
+		.template cast<T>().reshape(outdims);\
 });
 
 /// Only applies to 2-d tensors
@@ -1080,20 +1728,46 @@ EigenptrT contract (teq::Shape outshape, const teq::iTensor& a, const teq::iTens
 	PairVecT<teq::RankT> dims;
 	Packer<PairVecT<teq::RankT>>().unpack(dims, attrib);
 
+	auto ashape = a.shape();
+	auto bshape = b.shape();
+	if (is_2d(ashape) && is_2d(bshape) && dims.size() == 1)
+	{
+		// multiply sparse leaves without reading their dense data,
+		// transposing whichever side contracts along its other dimension
+		bool atrans = dims[0].first == 1;
+		bool btrans = dims[0].second == 0;
+		auto asparse = as_sparse<T>(a);
+		auto bsparse = as_sparse<T>(b);
+		if (nullptr != asparse && nullptr == bsparse)
+		{
+			return std::make_shared<PermMatOp<T>>(outshape,teq::CTensT{&b},
+			[asparse,atrans,btrans](MatrixT<T>& out, const std::vector<MatMapT<T>>& args)
+			{
+				trans_product<T>(out, asparse->sparse(), atrans, args[0], btrans);
+			});
+		}
+		if (nullptr == asparse && nullptr != bsparse)
+		{
+			return std::make_shared<PermMatOp<T>>(outshape,teq::CTensT{&a},
+			[bsparse,atrans,btrans](MatrixT<T>& out, const std::vector<MatMapT<T>>& args)
+			{
+				trans_product<T>(out, args[0], atrans, bsparse->sparse(), btrans);
+			});
+		}
+	}
 	for (auto& d : dims)
 	{
 		// contract reverses left, right arguments
 		std::swap(d.first, d.second);
 	}
-	auto ashape = a.shape();
-	auto bshape = b.shape();
 	if (is_2d(ashape) && is_2d(bshape) &&
 		dims.size() == 1 && dims[0].first == 1 && dims[0].second == 0)
 	{
 		return std::make_shared<PermMatOp<T>>(outshape,teq::CTensT{&a,&b},
 		[](MatrixT<T>& out, const std::vector<MatMapT<T>>& args)
 		{
-			out = args[0] * args[1];
+			out = (args[0].template cast<AccumT<T>>() *
+				args[1].template cast<AccumT<T>>()).template cast<T>();
 		});
 	}
 	DimensionsT outdims = shape_convert(outshape);
@@ -1127,8 +1801,9 @@ EigenptrT matmul (teq::Shape outshape, const teq::iTensor& a, const teq::iTensor
 			for (size_t i = 0; i < nbatches; ++i)
 			{
 				make_matmap(odata + i * osize, os) =
-					make_matmap(adata + i * asize, as) *
-					make_matmap(bdata + i * bsize, bs);
+					(make_matmap(adata + i * asize, as).template cast<AccumT<T>>() *
+					make_matmap(bdata + i * bsize, bs).template cast<AccumT<T>>()
+					).template cast<T>();
 			}
 		});
 	}
@@ -1186,6 +1861,245 @@ EigenptrT convolution (teq::Shape outshape, const teq::iTensor& input,
 	});
 }
 
+/// Apply 2D convolution of kernel of shape [out,in,kwidth,kheight]
+/// across image of shape [in,width,height,batch] by lowering image
+/// patches to a matrix (im2col) and multiplying it with kernel
+/// Output has shape [out,owidth,oheight,batch]
+template <typename T>
+EigenptrT conv2d (teq::Shape outshape, const teq::iTensor& image,
+	const teq::iTensor& kernel, const marsh::iAttributed& attrib)
+{
+	internal::Conv2dParams params(image.shape(), kernel.shape(), attrib);
+	return std::make_shared<PermTensOp<T>>(outshape,teq::CTensT{&image,&kernel},
+	[params](TensorT<T>& out, const std::vector<TensMapT<T>>& args)
+	{
+		Eigen::Index npatches = params.npatches();
+		Eigen::Index psize = params.patch_size();
+		MatMapT<T> kern(args[1].data(), psize, params.nout_);
+		MatMapT<T> outmat(out.data(), npatches, params.nout_);
+		if (params.is_pointwise())
+		{
+			outmat.noalias() = MatMapT<T>(args[0].data(), npatches, psize) * kern;
+			return;
+		}
+		MatrixT<T> cols(npatches, psize);
+		internal::im2col(cols.data(), args[0].data(), params);
+		outmat.noalias() = cols * kern;
+	});
+}
+
+/// Return Eigen data object representing gradient of conv2d with
+/// respect to its image given kernel and gradient of conv2d output
+template <typename T>
+EigenptrT conv2d_image_grad (teq::Shape outshape, const teq::iTensor& kernel,
+	const teq::iTensor& supgrad, const marsh::iAttributed& attrib)
+{
+	internal::Conv2dParams params(outshape, kernel.shape(), attrib);
+	return std::make_shared<PermTensOp<T>>(outshape,teq::CTensT{&kernel,&supgrad},
+	[params](TensorT<T>& out, const std::vector<TensMapT<T>>& args)
+	{
+		Eigen::Index npatches = params.npatches();
+		Eigen::Index psize = params.patch_size();
+		MatMapT<T> kern(args[0].data(), psize, params.nout_);
+		MatMapT<T> grad(args[1].data(), npatches, params.nout_);
+		if (params.is_pointwise())
+		{
+			MatMapT<T>(out.data(), npatches, psize).noalias() =
+				grad * kern.transpose();
+			return;
+		}
+		MatrixT<T> cols(npatches, psize);
+		cols.noalias() = grad * kern.transpose();
+		internal::col2im(out.data(), cols.data(), params);
+	});
+}
+
+/// Return Eigen data object representing gradient of conv2d with
+/// respect to its kernel given image and gradient of conv2d output
+template <typename T>
+EigenptrT conv2d_kernel_grad (teq::Shape outshape, const teq::iTensor& image,
+	const teq::iTensor& supgrad, const marsh::iAttributed& attrib)
+{
+	internal::Conv2dParams params(image.shape(), outshape, attrib);
+	return std::make_shared<PermTensOp<T>>(outshape,teq::CTensT{&image,&supgrad},
+	[params](TensorT<T>& out, const std::vector<TensMapT<T>>& args)
+	{
+		Eigen::Index npatches = params.npatches();
+		Eigen::Index psize = params.patch_size();
+		MatMapT<T> grad(args[1].data(), npatches, params.nout_);
+		MatMapT<T> outmat(out.data(), psize, params.nout_);
+		if (params.is_pointwise())
+		{
+			outmat.noalias() = MatMapT<T>(
+				args[0].data(), npatches, psize).transpose() * grad;
+			return;
+		}
+		MatrixT<T> cols(npatches, psize);
+		internal::im2col(cols.data(), args[0].data(), params);
+		outmat.noalias() = cols.transpose() * grad;
+	});
+}
+
+/// Return Eigen data object representing {next state,next hidden} of
+/// LSTM cell concatenated along the first dimension given
+/// group {input,hidden,state,weight[,bias]}
+/// All gates are computed from weight concatenated by
+/// {candidate,forget,input,output} followed by one elementwise pass
+template <typename T>
+EigenptrT lstm_cell (teq::Shape outshape, const teq::TensptrsT& group)
+{
+	internal::CellParams params(group[0]->shape(), group[1]->shape());
+	bool has_bias = group.size() > 4;
+	teq::CTensT args;
+	args.reserve(group.size());
+	std::transform(group.begin(), group.end(), std::back_inserter(args),
+	[](teq::TensptrT arg)
+	{
+		return arg.get();
+	});
+	return std::make_shared<PermTensOp<T>>(outshape,args,
+	[params,has_bias](TensorT<T>& out, const std::vector<TensMapT<T>>& args)
+	{
+		internal::lstm_cell(out.data(), args[0].data(), args[1].data(),
+			args[2].data(), args[3].data(),
+			has_bias ? args[4].data() : nullptr, params);
+	});
+}
+
+/// Return Eigen data object representing gradient of LSTM cell
+/// with respect to argument at rank attribute given group
+/// {input,hidden,state,weight[,bias],supgrad}
+template <typename T>
+EigenptrT lstm_cell_grad (teq::Shape outshape,
+	const teq::TensptrsT& group, const marsh::iAttributed& attrib)
+{
+	teq::RankT target;
+	Packer<teq::RankT>().unpack(target, attrib);
+	internal::CellParams params(group[0]->shape(), group[1]->shape());
+	bool has_bias = group.size() > 5;
+	teq::CTensT args;
+	args.reserve(group.size());
+	std::transform(group.begin(), group.end(), std::back_inserter(args),
+	[](teq::TensptrT arg)
+	{
+		return arg.get();
+	});
+	return std::make_shared<PermTensOp<T>>(outshape,args,
+	[params,has_bias,target](TensorT<T>& out, const std::vector<TensMapT<T>>& args)
+	{
+		Eigen::Index hid = params.hidden_;
+		MatrixT<T> dgates, dstate;
+		internal::lstm_cell_grad(dgates, dstate, args[0].data(),
+			args[1].data(), args[2].data(), args[3].data(),
+			has_bias ? args[4].data() : nullptr, args.back().data(), params);
+		MatMapT<T> w(args[3].data(), params.indim_ + hid, 4 * hid);
+		switch (target)
+		{
+			case 0: // input
+				MatMapT<T>(out.data(), params.nbatch_, params.indim_).noalias() =
+					dgates * w.topRows(params.indim_).transpose();
+				break;
+			case 1: // hidden
+				MatMapT<T>(out.data(), params.nbatch_, hid).noalias() =
+					dgates * w.bottomRows(hid).transpose();
+				break;
+			case 2: // state
+				MatMapT<T>(out.data(), params.nbatch_, hid) = dstate;
+				break;
+			case 3: // weight
+			{
+				MatMapT<T> dweight(out.data(), params.indim_ + hid, 4 * hid);
+				dweight.topRows(params.indim_).noalias() = MatMapT<T>(
+					args[0].data(), params.nbatch_, params.indim_).transpose() * dgates;
+				dweight.bottomRows(hid).noalias() = MatMapT<T>(
+					args[1].data(), params.nbatch_, hid).transpose() * dgates;
+			}
+				break;
+			default: // bias
+				internal::RowMapT<T>(out.data(), 4 * hid) = dgates.colwise().sum();
+		}
+	});
+}
+
+/// Return Eigen data object representing next state of GRU cell
+/// given group {input,state,weight[,bias]}
+/// All gates are computed from weight concatenated by
+/// {update,reset,candidate} followed by one elementwise pass
+template <typename T>
+EigenptrT gru_cell (teq::Shape outshape, const teq::TensptrsT& group)
+{
+	internal::CellParams params(group[0]->shape(), group[1]->shape());
+	bool has_bias = group.size() > 3;
+	teq::CTensT args;
+	args.reserve(group.size());
+	std::transform(group.begin(), group.end(), std::back_inserter(args),
+	[](teq::TensptrT arg)
+	{
+		return arg.get();
+	});
+	return std::make_shared<PermTensOp<T>>(outshape,args,
+	[params,has_bias](TensorT<T>& out, const std::vector<TensMapT<T>>& args)
+	{
+		internal::gru_cell(out.data(), args[0].data(), args[1].data(),
+			args[2].data(), has_bias ? args[3].data() : nullptr, params);
+	});
+}
+
+/// Return Eigen data object representing gradient of GRU cell
+/// with respect to argument at rank attribute given group
+/// {input,state,weight[,bias],supgrad}
+template <typename T>
+EigenptrT gru_cell_grad (teq::Shape outshape,
+	const teq::TensptrsT& group, const marsh::iAttributed& attrib)
+{
+	teq::RankT target;
+	Packer<teq::RankT>().unpack(target, attrib);
+	internal::CellParams params(group[0]->shape(), group[1]->shape());
+	bool has_bias = group.size() > 4;
+	teq::CTensT args;
+	args.reserve(group.size());
+	std::transform(group.begin(), group.end(), std::back_inserter(args),
+	[](teq::TensptrT arg)
+	{
+		return arg.get();
+	});
+	return std::make_shared<PermTensOp<T>>(outshape,args,
+	[params,has_bias,target](TensorT<T>& out, const std::vector<TensMapT<T>>& args)
+	{
+		Eigen::Index hid = params.hidden_;
+		MatrixT<T> dgates, dstate, reset;
+		internal::gru_cell_grad(dgates, dstate, reset, args[0].data(),
+			args[1].data(), args[2].data(),
+			has_bias ? args[3].data() : nullptr, args.back().data(), params);
+		MatMapT<T> w(args[2].data(), params.indim_ + hid, 3 * hid);
+		switch (target)
+		{
+			case 0: // input
+				MatMapT<T>(out.data(), params.nbatch_, params.indim_).noalias() =
+					dgates * w.topRows(params.indim_).transpose();
+				break;
+			case 1: // state
+				MatMapT<T>(out.data(), params.nbatch_, hid) = dstate;
+				break;
+			case 2: // weight
+			{
+				MatMapT<T> dweight(out.data(), params.indim_ + hid, 3 * hid);
+				dweight.topRows(params.indim_).noalias() = MatMapT<T>(
+					args[0].data(), params.nbatch_, params.indim_).transpose() * dgates;
+				// candidate gate reads reset state instead of state
+				dweight.bottomRows(hid).leftCols(2 * hid).noalias() = MatMapT<T>(
+					args[1].data(), params.nbatch_, hid).transpose() *
+					dgates.leftCols(2 * hid);
+				dweight.bottomRows(hid).rightCols(hid).noalias() =
+					reset.transpose() * dgates.rightCols(hid);
+			}
+				break;
+			default: // bias
+				internal::RowMapT<T>(out.data(), 3 * hid) = dgates.colwise().sum();
+		}
+	});
+}
+
 template <typename T>
 EigenptrT assign (teq::iTensor& target, const teq::iTensor& source)
 {
@@ -1236,6 +2150,246 @@ EigenptrT assign_div (teq::iTensor& target, const teq::iTensor& source)
 	});
 }
 
+/// Return Eigen data object subtracting matmul(permute(indicator,{1,0}),source)
+/// from target, where target rows are only updated if their indices
+/// are columns of nonzero values in a sparse indicator
+template <typename T>
+EigenptrT sparse_assign_sub (teq::iTensor& target,
+	const teq::iTensor& indicator, const teq::iTensor& source)
+{
+	auto sparse = as_sparse<T>(indicator);
+	return std::make_shared<TensAssign<T>>(target, source,
+	[sparse,&indicator](TensMapT<T>& target, const TensMapT<T>& source)
+	{
+		auto tmat = tensmap_to_matmap(target);
+		MatMapT<T> smat((T*) source.data(),
+			source.dimension(1), source.dimension(0));
+		if (nullptr == sparse)
+		{
+			auto imat = make_matmap((T*) indicator.device().data(),
+				indicator.shape());
+			tmat -= (imat.transpose().template cast<AccumT<T>>() *
+				smat.template cast<AccumT<T>>()).template cast<T>();
+			return;
+		}
+		auto& smatrix = sparse->sparse();
+		for (Eigen::Index row = 0, n = smatrix.outerSize(); row < n; ++row)
+		{
+			for (typename SparseMatT<T>::InnerIterator it(smatrix, row); it; ++it)
+			{
+				tmat.row(it.col()) -= (T) it.value() * smat.row(row);
+			}
+		}
+	});
+}
+
+/// Return Eigen data object subtracting slices of source from target at
+/// every index in indices along dimension attribute, where only slices of
+/// target at indices are updated
+template <typename T>
+EigenptrT scatter_assign_sub (teq::iTensor& target, const teq::iTensor& indices,
+	const teq::iTensor& source, const marsh::iAttributed& attrib)
+{
+	teq::RankT dim;
+	Packer<teq::RankT>().unpack(dim, attrib);
+	internal::IndexBlocks blocks(target.shape(), dim);
+	return std::make_shared<TensAssign<T>>(target, source,
+	[blocks,&indices](TensMapT<T>& target, const TensMapT<T>& source)
+	{
+		auto idx = internal::read_indices("SCATTER_ASSIGN_SUB", indices, blocks.n_);
+		size_t nidx = idx.size();
+		T* dst = target.data();
+		const T* src = source.data();
+		for (size_t o = 0; o < blocks.outer_; ++o)
+		{
+			for (size_t i = 0; i < nidx; ++i)
+			{
+				internal::RowMapT<T>(dst + blocks.inner_ * (idx[i] + blocks.n_ * o),
+					blocks.inner_) -= internal::RowMapT<T>(
+					(T*) src + blocks.inner_ * (i + nidx * o), blocks.inner_);
+			}
+		}
+	});
+}
+
+/// Return Eigen data object applying stochastic gradient descent
+/// to groups {variable,gradient} given coefficients {learning_rate}
+template <typename T>
+EigenptrT apply_sgd (const teq::TensptrsT& groups, const marsh::iAttributed& attrib)
+{
+	CoefsT coefs;
+	Packer<CoefsT>().unpack(coefs, attrib);
+	T lr = (T) coefs.at(0);
+	return std::make_shared<TensApply<T>>(groups, 2,
+	[lr](std::vector<TensMapT<T>>& group)
+	{
+		group[0] -= group[1] * lr;
+	});
+}
+
+/// Return Eigen data object applying adagrad to groups
+/// {variable,gradient,accumulator} given coefficients {learning_rate,epsilon}
+template <typename T>
+EigenptrT apply_adagrad (const teq::TensptrsT& groups, const marsh::iAttributed& attrib)
+{
+	CoefsT coefs;
+	Packer<CoefsT>().unpack(coefs, attrib);
+	T lr = (T) coefs.at(0);
+	T epsilon = (T) coefs.at(1);
+	return std::make_shared<TensApply<T>>(groups, 3,
+	[lr,epsilon](std::vector<TensMapT<T>>& group)
+	{
+		group[2] += group[1].square();
+		group[0] -= group[1] * lr / (group[2].sqrt() + epsilon);
+	});
+}
+
+/// Return Eigen data object applying rmsprop to groups
+/// {variable,gradient,mean_square} given coefficients
+/// {learning_rate,discount_factor,epsilon}
+template <typename T>
+EigenptrT apply_rmsprop (const teq::TensptrsT& groups, const marsh::iAttributed& attrib)
+{
+	CoefsT coefs;
+	Packer<CoefsT>().unpack(coefs, attrib);
+	T lr = (T) coefs.at(0);
+	T discount = (T) coefs.at(1);
+	T nodiscount = (T) (1 - coefs.at(1));
+	T epsilon = (T) coefs.at(2);
+	return std::make_shared<TensApply<T>>(groups, 3,
+	[lr,discount,nodiscount,epsilon](std::vector<TensMapT<T>>& group)
+	{
+		group[2] = group[2] * discount + group[1].square() * nodiscount;
+		group[0] -= group[1] * lr / (group[2].sqrt() + epsilon);
+	});
+}
+
+/// Return Eigen data object applying adam to groups
+/// {variable,gradient,moment1,moment2,step} where step has 1 element
+/// given coefficients {step_rate,decay1,decay2,epsilon}
+template <typename T>
+EigenptrT apply_adam (const teq::TensptrsT& groups, const marsh::iAttributed& attrib)
+{
+	CoefsT coefs;
+	Packer<CoefsT>().unpack(coefs, attrib);
+	double step_rate = coefs.at(0);
+	double decay1 = coefs.at(1);
+	double decay2 = coefs.at(2);
+	double epsilon = coefs.at(3);
+	return std::make_shared<TensApply<T>>(groups, 5,
+	[step_rate,decay1,decay2,epsilon](std::vector<TensMapT<T>>& group)
+	{
+		T& t = *group[4].data();
+		t += (T) 1;
+		// fold bias corrections into the step and epsilon:
+		// m / (1 - decay1^t) / (sqrt(v / (1 - decay2^t)) + epsilon) =
+		// (m * sqrt(1 - decay2^t) / (1 - decay1^t)) / (sqrt(v) + epsilon * sqrt(1 - decay2^t))
+		double corr2 = std::sqrt(1 - std::pow(decay2, (double) t));
+		T step = (T) (step_rate * corr2 / (1 - std::pow(decay1, (double) t)));
+		T eps = (T) (epsilon * corr2);
+		group[2] = group[2] * (T) decay1 + group[1] * (T) (1 - decay1);
+		group[3] = group[3] * (T) decay2 + group[1].square() * (T) (1 - decay2);
+		group[0] -= group[2] * step / (group[3].sqrt() + eps);
+	});
+}
+
+#define _EIGEN_QUANTIZE_CASE(INTYPE)\
+return std::make_shared<PermTensOp<T,INTYPE>>(outshape,teq::CTensT{input.get()},\
+[inv_scale](TensorT<T>& out, const std::vector<TensMapT<INTYPE>>& args){\
+	out = (args[0].template cast<double>() * inv_scale).round()\
+		.cwiseMax((double) -quant_limit).cwiseMin((double) quant_limit)\
+		.template cast<T>();\
+});
+
+/// Return Eigen data object symmetrically quantizing input to integers
+/// in [-quant_limit,quant_limit] given coefficients {scale} where
+/// input is approximately output * scale
+template <typename T>
+EigenptrT quantize (teq::Shape outshape, const teq::TensptrT& input,
+	const marsh::iAttributed& attrib)
+{
+	CoefsT coefs;
+	Packer<CoefsT>().unpack(coefs, attrib);
+	double inv_scale = 1. / coefs.at(0);
+	auto intype = (egen::_GENERATED_DTYPE) input->get_meta().type_code();
+	EigenptrT out;
+	TYPE_LOOKUP(_EIGEN_QUANTIZE_CASE, intype);
+	return out;
+}
+
+#undef _EIGEN_QUANTIZE_CASE
+
+/// Return Eigen data object multiplying quantized matrices a and b
+/// accumulating in int32, then rescaling each output column by its
+/// multiplier (see internal::quant_multipliers) in the same pass
+template <typename T>
+EigenptrT quant_matmul (teq::Shape outshape, const teq::iTensor& a,
+	const teq::iTensor& b, const marsh::iAttributed& attrib)
+{
+	internal::check_quantized("QUANT_MATMUL", {&a,&b});
+	auto ashape = a.shape();
+	auto bshape = b.shape();
+	teq::Shape os({outshape.at(0), outshape.at(1)});
+	teq::Shape as({ashape.at(0), ashape.at(1)});
+	teq::Shape bs({bshape.at(0), bshape.at(1)});
+	size_t nbatches = outshape.n_elems() / os.n_elems();
+	Eigen::VectorXd multipliers = internal::quant_multipliers(attrib, os.at(0));
+	return std::make_shared<PermTensOp<T,QuantT>>(outshape,teq::CTensT{&a,&b},
+	[nbatches,os,as,bs,multipliers](TensorT<T>& out, const std::vector<TensMapT<QuantT>>& args)
+	{
+		auto odata = out.data();
+		auto adata = args[0].data();
+		auto bdata = args[1].data();
+		size_t osize = os.n_elems(),
+			asize = as.n_elems(),
+			bsize = bs.n_elems();
+		MatrixT<int32_t> acc;
+		for (size_t i = 0; i < nbatches; ++i)
+		{
+			acc.noalias() =
+				make_matmap(adata + i * asize, as).template cast<int32_t>() *
+				make_matmap(bdata + i * bsize, bs).template cast<int32_t>();
+			make_matmap(odata + i * osize, os) = (acc.template cast<double>() *
+				multipliers.asDiagonal()).template cast<T>();
+		}
+	});
+}
+
+/// Apply 2D convolution of quantized kernel of shape [out,in,kwidth,kheight]
+/// across quantized image of shape [in,width,height,batch] as conv2d does,
+/// accumulating in int32, then rescaling each output channel by its
+/// multiplier (see internal::quant_multipliers) in the same pass
+template <typename T>
+EigenptrT quant_conv2d (teq::Shape outshape, const teq::iTensor& image,
+	const teq::iTensor& kernel, const marsh::iAttributed& attrib)
+{
+	internal::check_quantized("QUANT_CONV2D", {&image,&kernel});
+	internal::Conv2dParams params(image.shape(), kernel.shape(), attrib);
+	Eigen::VectorXd multipliers = internal::quant_multipliers(attrib, params.nout_);
+	return std::make_shared<PermTensOp<T,QuantT>>(outshape,teq::CTensT{&image,&kernel},
+	[params,multipliers](TensorT<T>& out, const std::vector<TensMapT<QuantT>>& args)
+	{
+		Eigen::Index npatches = params.npatches();
+		Eigen::Index psize = params.patch_size();
+		MatMapT<QuantT> kern(args[1].data(), psize, params.nout_);
+		MatrixT<int32_t> acc;
+		if (params.is_pointwise())
+		{
+			acc.noalias() = MatMapT<QuantT>(args[0].data(), npatches, psize)
+				.template cast<int32_t>() * kern.template cast<int32_t>();
+		}
+		else
+		{
+			MatrixT<QuantT> cols(npatches, psize);
+			internal::im2col(cols.data(), args[0].data(), params);
+			acc.noalias() = cols.template cast<int32_t>() *
+				kern.template cast<int32_t>();
+		}
+		MatMapT<T>(out.data(), npatches, params.nout_) =
+			(acc.template cast<double>() * multipliers.asDiagonal()).template cast<T>();
+	});
+}
+
 #define _EIGEN_CAST_CASE(INTYPE)\
 return std::make_shared<PermTensOp<T,INTYPE>>(input->shape(),teq::CTensT{input.get()},\
 [](TensorT<T>& out, const std::vector<TensMapT<INTYPE>>& args){\
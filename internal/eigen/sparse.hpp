@@ -0,0 +1,197 @@
+///
+/// sparse.hpp
+/// eigen
+///
+/// Purpose:
+/// Define sparse leaf interfaces and sparse matrix utilities
+///
+
+#ifndef EIGEN_SPARSE_HPP
+#define EIGEN_SPARSE_HPP
+
+#include "Eigen/SparseCore"
+
+#include "internal/eigen/device.hpp"
+
+namespace eigen
+{
+
+/// Compressed sparse row (CSR) matrix
+template <typename T>
+using SparseMatT = Eigen::SparseMatrix<T,Eigen::RowMajor>;
+
+/// Return CSR matrix of teq shape [ncols,nrows] given nonzero values where
+/// row i holds values[rowptrs[i]:rowptrs[i+1]] at columns colidx[rowptrs[i]:rowptrs[i+1]]
+template <typename T>
+SparseMatT<T> csr_matrix (teq::Shape shape, const std::vector<size_t>& rowptrs,
+	const std::vector<size_t>& colidx, const std::vector<T>& values)
+{
+	size_t nrows = shape.at(1);
+	size_t ncols = shape.at(0);
+	if (shape.n_elems() != nrows * ncols)
+	{
+		global::fatalf("cannot create sparse matrix of non-matrix shape %s",
+			shape.to_string().c_str());
+	}
+	if (rowptrs.size() != nrows + 1 || colidx.size() != values.size() ||
+		rowptrs.back() != values.size())
+	{
+		global::fatalf("cannot create %d by %d csr matrix from %d row pointers "
+			"to %d column indices of %d values", nrows, ncols,
+			rowptrs.size(), colidx.size(), values.size());
+	}
+	std::vector<Eigen::Triplet<T>> entries;
+	entries.reserve(values.size());
+	for (size_t i = 0; i < nrows; ++i)
+	{
+		for (size_t j = rowptrs[i]; j < rowptrs[i + 1]; ++j)
+		{
+			if (colidx[j] >= ncols)
+			{
+				global::fatalf("column index %d out of bounds of %d columns",
+					colidx[j], ncols);
+			}
+			entries.push_back(Eigen::Triplet<T>(i, colidx[j], values[j]));
+		}
+	}
+	SparseMatT<T> out(nrows, ncols);
+	out.setFromTriplets(entries.begin(), entries.end());
+	return out;
+}
+
+/// Return CSR matrix of teq shape [ncols,nrows] given coordinate (COO)
+/// values where values[i] is at row rows[i] and column cols[i]
+/// Values at duplicate coordinates are summed
+template <typename T>
+SparseMatT<T> coo_matrix (teq::Shape shape, const std::vector<size_t>& rows,
+	const std::vector<size_t>& cols, const std::vector<T>& values)
+{
+	size_t nrows = shape.at(1);
+	size_t ncols = shape.at(0);
+	if (shape.n_elems() != nrows * ncols)
+	{
+		global::fatalf("cannot create sparse matrix of non-matrix shape %s",
+			shape.to_string().c_str());
+	}
+	if (rows.size() != values.size() || cols.size() != values.size())
+	{
+		global::fatalf("cannot create coo matrix from %d rows, %d columns "
+			"and %d values", rows.size(), cols.size(), values.size());
+	}
+	std::vector<Eigen::Triplet<T>> entries;
+	entries.reserve(values.size());
+	for (size_t i = 0, n = values.size(); i < n; ++i)
+	{
+		if (rows[i] >= nrows || cols[i] >= ncols)
+		{
+			global::fatalf("coordinate (%d,%d) out of bounds of %d by %d matrix",
+				rows[i], cols[i], nrows, ncols);
+		}
+		entries.push_back(Eigen::Triplet<T>(rows[i], cols[i], values[i]));
+	}
+	SparseMatT<T> out(nrows, ncols);
+	out.setFromTriplets(entries.begin(), entries.end());
+	return out;
+}
+
+/// Leaf holding a sparse matrix
+struct iSparseLeaf : public iMutableLeaf
+{
+	virtual ~iSparseLeaf (void) = default;
+
+	/// Return number of stored (nonzero) values
+	virtual size_t nnz (void) const = 0;
+};
+
+/// Sparse leaf holding CSR matrix of type T and teq shape [ncols,nrows]
+template <typename T>
+struct iSparseMatrix : public iSparseLeaf
+{
+	virtual ~iSparseMatrix (void) = default;
+
+	/// Implementation of iSparseLeaf
+	size_t nnz (void) const override
+	{
+		return sparse().nonZeros();
+	}
+
+	virtual const SparseMatT<T>& sparse (void) const = 0;
+};
+
+/// Return sparse matrix view of tensor if it is a sparse leaf of type T
+/// otherwise return nullptr
+template <typename T>
+inline const iSparseMatrix<T>* as_sparse (const teq::iTensor& tens)
+{
+	return dynamic_cast<const iSparseMatrix<T>*>(&tens);
+}
+
+/// Source device reference of sparse leaves
+/// Dense data is materialized on demand for operators without sparse kernels
+template <typename T>
+struct SparseRef final : public iPermEigen
+{
+	SparseRef (SparseMatT<T> sparse) : sparse_(std::move(sparse)) {}
+
+	/// Implementation of iDeviceRef
+	void* data (void) override
+	{
+		return densify();
+	}
+
+	/// Implementation of iDeviceRef
+	const void* data (void) const override
+	{
+		return densify();
+	}
+
+	teq::Once<void*> odata (void) override
+	{
+		teq::Once<void*> out(data());
+		return out;
+	}
+
+	teq::Once<const void*> odata (void) const override
+	{
+		teq::Once<const void*> out(data());
+		return out;
+	}
+
+	/// Implementation of iEigen
+	void assign (size_t, RTMemptrT&) override {}
+
+	void assign (SparseMatT<T> sparse)
+	{
+		sparse_ = std::move(sparse);
+		if (dense_.size() > 0)
+		{
+			// refresh in place since operators may hold the dense data
+			dense_ = sparse_.toDense();
+		}
+	}
+
+	const SparseMatT<T>& sparse (void) const
+	{
+		return sparse_;
+	}
+
+private:
+	T* densify (void) const
+	{
+		if (0 == dense_.size())
+		{
+			dense_ = sparse_.toDense();
+		}
+		return dense_.data();
+	}
+
+	/// Data Source
+	SparseMatT<T> sparse_;
+
+	/// Dense copy of sparse_, empty until requested
+	mutable MatrixT<T> dense_;
+};
+
+}
+
+#endif // EIGEN_SPARSE_HPP
@@ -23,6 +23,8 @@ std::string Packer<teq::Shape>::key_ = "shape";
 
 std::string Packer<teq::TensptrT>::key_ = "tensor";
 
+std::string Packer<CoefsT>::key_ = "coefficients";
+
 void pack_attr (marsh::iAttributed&) {}
 
 OptDimsT unpack_extend (teq::Shape inshape, const marsh::iAttributed& attrib)
@@ -59,6 +61,103 @@ OptDimsT unpack_extend (teq::Shape inshape, const marsh::iAttributed& attrib)
 	return bcast;
 }
 
+void unpack_pool (teq::ShapeT& windows, teq::ShapeT& strides,
+	const marsh::iAttributed& attrib)
+{
+	PairVecT<teq::DimT> encoding;
+	Packer<PairVecT<teq::DimT>>().unpack(encoding, attrib);
+
+	std::fill(windows.begin(), windows.end(), 1);
+	std::fill(strides.begin(), strides.end(), 1);
+	for (size_t i = 0, n = std::min(encoding.size(),
+		(size_t) teq::rank_cap); i < n; ++i)
+	{
+		if (0 == encoding[i].first || 0 == encoding[i].second)
+		{
+			global::fatalf("cannot pool with zero windows or strides: %s",
+				to_string(encoding).c_str());
+		}
+		windows[i] = encoding[i].first;
+		strides[i] = encoding[i].second;
+	}
+}
+
+Conv2dAttrs unpack_conv2d (const marsh::iAttributed& attrib)
+{
+	Conv2dAttrs out;
+	Packer<teq::DimsT> stridepacker;
+	Packer<PairVecT<teq::DimT>> padpacker;
+	if (nullptr != attrib.get_attr(stridepacker.get_key()))
+	{
+		teq::DimsT strides;
+		stridepacker.unpack(strides, attrib);
+		if (strides.size() > 0)
+		{
+			out.strides_.first = strides[0];
+		}
+		if (strides.size() > 1)
+		{
+			out.strides_.second = strides[1];
+		}
+		if (0 == out.strides_.first || 0 == out.strides_.second)
+		{
+			global::fatalf("cannot convolve with zero strides: %s",
+				fmts::to_string(strides.begin(), strides.end()).c_str());
+		}
+	}
+	if (nullptr != attrib.get_attr(padpacker.get_key()))
+	{
+		PairVecT<teq::DimT> paddings;
+		padpacker.unpack(paddings, attrib);
+		if (paddings.size() > 0)
+		{
+			out.xpad_ = paddings[0];
+		}
+		if (paddings.size() > 1)
+		{
+			out.ypad_ = paddings[1];
+		}
+	}
+	return out;
+}
+
+teq::Shape apply_shape (const std::string& opname,
+	const teq::ShapesT& shapes, size_t group_size, bool has_step)
+{
+	if (shapes.empty())
+	{
+		global::fatal(no_argument_err);
+	}
+	size_t nshapes = shapes.size();
+	if (nshapes % group_size > 0)
+	{
+		global::throw_errf("cannot %s with %d arguments "
+			"(expecting groups of %d)", opname.c_str(),
+			(int) nshapes, (int) group_size);
+	}
+	size_t nmatches = has_step ? group_size - 1 : group_size;
+	for (size_t i = 0; i < nshapes; i += group_size)
+	{
+		const teq::Shape& target = shapes[i];
+		for (size_t j = 1; j < nmatches; ++j)
+		{
+			if (false == shapes[i + j].compatible_after(target, 0))
+			{
+				global::throw_errf("cannot %s with incompatible shapes %s and %s",
+					opname.c_str(), shapes[i + j].to_string().c_str(),
+					target.to_string().c_str());
+			}
+		}
+		if (has_step && 1 != shapes[i + nmatches].n_elems())
+		{
+			global::throw_errf("cannot %s with step of shape %s "
+				"(expecting 1 element)", opname.c_str(),
+				shapes[i + nmatches].to_string().c_str());
+		}
+	}
+	return shapes.front();
+}
+
 }
 
 #endif
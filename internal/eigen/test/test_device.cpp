@@ -151,6 +151,107 @@ TEST(DEVICE, MatOp)
 }
 
 
+
+TEST(DEVICE, TensView)
+{
+	teq::Shape shape({3, 2});
+	std::vector<double> data = {1, 2, 3, 4, 5, 6};
+
+	size_t lifetimes = 0;
+	auto incr_life = [&lifetimes]{ ++lifetimes; };
+
+	MockDeviceRef devref;
+	auto var = make_var(data.data(), devref, shape, "", incr_life);
+
+	auto memory = std::make_shared<MockRuntimeMemory>();
+	EXPECT_CALL(*memory, allocate(_)).Times(0);
+	eigen::RTMemptrT mem = memory;
+
+	// second row is read in place
+	eigen::ViewLayout rowlayout{var.get(), 3, eigen::dense_strides(shape)};
+	eigen::TensView<double> row(*var, teq::Shape({3}), rowlayout);
+	row.assign(1, mem);
+	EXPECT_TRUE(row.is_contiguous());
+	EXPECT_EQ(data.data() + 3, row.data());
+
+	// transpose is copied only when contiguous data is requested
+	eigen::ViewLayout translayout{var.get(), 0, {3, 1, 6, 6, 6, 6, 6, 6}};
+	eigen::TensView<double> trans(*var, teq::Shape({2, 3}), translayout);
+	trans.assign(2, mem);
+	EXPECT_FALSE(trans.is_contiguous());
+	EXPECT_TRUE(trans.is_strided_2d());
+	{
+		auto ptr = (double*) trans.odata().get();
+		std::vector<double> expect = {1, 4, 2, 5, 3, 6};
+		EXPECT_VECEQ(expect, std::vector<double>(ptr, ptr + 6));
+		EXPECT_NE(data.data(), ptr);
+	}
+	EXPECT_EQ(0, lifetimes);
+	trans.odata();
+	EXPECT_EQ(1, lifetimes);
+
+	// views of views compose onto the original data
+	auto viewed = make_var(teq::Shape({2, 3}));
+	EXPECT_CALL(*viewed, device()).WillRepeatedly(ReturnRef(trans));
+	auto layout = eigen::view_layout<double>(*viewed);
+	EXPECT_EQ(var.get(), layout.base_);
+	EXPECT_EQ(0, layout.offset_);
+	EXPECT_EQ(3, layout.strides_[0]);
+	EXPECT_EQ(1, layout.strides_[1]);
+
+	auto dense = eigen::view_layout<double>(*var);
+	EXPECT_EQ(var.get(), dense.base_);
+	EXPECT_EQ(1, dense.strides_[0]);
+	EXPECT_EQ(3, dense.strides_[1]);
+}
+
+
+TEST(DEVICE, StridedMatOp)
+{
+	teq::Shape shape({3, 2});
+	std::vector<double> data = {1, 2, 3, 4, 5, 6};
+	std::vector<double> alloc_mem(9);
+
+	MockDeviceRef devref;
+	auto var = make_var(data.data(), devref, shape);
+
+	eigen::ViewLayout translayout{var.get(), 0, {3, 1, 6, 6, 6, 6, 6, 6}};
+	eigen::TensView<double> trans(*var, teq::Shape({2, 3}), translayout);
+	auto viewed = make_var(teq::Shape({2, 3}));
+	EXPECT_CALL(*viewed, device()).WillRepeatedly(ReturnRef(trans));
+	EXPECT_CALL(Const(*viewed), device()).WillRepeatedly(ReturnRef(trans));
+	EXPECT_TRUE(eigen::is_strided_view<double>(*viewed));
+	EXPECT_FALSE(eigen::is_strided_view<double>(*var));
+
+	auto memory = std::make_shared<MockRuntimeMemory>();
+	{
+		bool init_called = false;
+		eigen::StridedMatOp<double> ref(teq::Shape({3, 3}), teq::CTensT{viewed.get()},
+		[&alloc_mem, &data, &init_called](
+			eigen::MatMapT<double>& out,
+			const std::vector<eigen::StridedMatMapT<double>>& args)
+		{
+			ASSERT_EQ(1, args.size());
+			EXPECT_EQ(alloc_mem.data(), out.data());
+			// transpose is read in place
+			EXPECT_EQ(data.data(), args[0].data());
+			EXPECT_EQ(3, args[0].rows());
+			EXPECT_EQ(2, args[0].cols());
+			EXPECT_EQ(4, args[0](0, 1));
+			EXPECT_EQ(3, args[0](2, 0));
+			init_called = true;
+		});
+
+		auto outbytes = 9 * sizeof(double);
+		EXPECT_CALL(*memory, allocate(outbytes)).Times(1).WillOnce(Return(alloc_mem.data()));
+		EXPECT_CALL(*memory, deallocate(alloc_mem.data(), outbytes)).Times(1);
+		eigen::RTMemptrT mem = memory;
+		ref.assign(1, mem);
+		EXPECT_TRUE(init_called);
+	}
+}
+
+
 TEST(DEVICE, Calc)
 {
 	teq::Shape shape({3});
@@ -185,6 +185,121 @@ TEST(OPERATOR, ArgMax)
 }
 
 
+static void test_softmax (
+	std::function<eigen::EigenptrT(teq::Shape,
+		const teq::iTensor&,const marsh::Maps& attr)> smax,
+	std::function<double(double,double,double)> expect)
+{
+	std::set<teq::RankT> rranks = {0};
+	marsh::Maps mvalues;
+	eigen::Packer<std::set<teq::RankT>>().pack(mvalues, rranks);
+	std::vector<double> outdata(6);
+	auto memory = std::make_shared<MockRuntimeMemory>();
+
+	{
+		size_t lifetimes = 0;
+		auto incr_life = [&lifetimes]{ ++lifetimes; };
+
+		// second column would overflow exp without subtracting max
+		std::vector<double> orig_raw{1, 2, 3, 1000, 1001, 1002};
+		MockLeaf edge;
+		MockDeviceRef mockdev;
+		make_var(edge, orig_raw.data(), mockdev, teq::Shape({3, 2}), "", incr_life);
+
+#ifndef PERM_OP
+		auto outbytes = 6 * sizeof(double);
+		EXPECT_CALL(*memory, allocate(outbytes)).WillOnce(Return(outdata.data()));
+		EXPECT_CALL(*memory, deallocate(outdata.data(), outbytes)).Times(1);
+#endif
+		auto r = smax(teq::Shape({3, 2}), edge, mvalues);
+
+		auto before = r->data();
+		eigen::RTMemptrT mem = memory;
+		r->assign(1, mem);
+		double* raw = (double*) r->data();
+		ASSERT_NE(nullptr, raw);
+#ifndef PERM_OP
+		EXPECT_EQ(nullptr, before);
+		EXPECT_EQ(outdata.data(), raw);
+#endif
+
+		double lse = std::log(std::exp(-2.) + std::exp(-1.) + 1.);
+		for (size_t i = 0; i < 6; ++i)
+		{
+			double shifted = orig_raw[i] - orig_raw[i - i % 3 + 2];
+			EXPECT_DOUBLE_EQ(expect(orig_raw[i], shifted, lse), raw[i]);
+		}
+		EXPECT_EQ(1, lifetimes);
+	}
+}
+
+
+TEST(OPERATOR, Softmax)
+{
+	test_softmax(eigen::softmax<double>,
+		[](double, double shifted, double lse)
+		{ return std::exp(shifted - lse); });
+}
+
+
+TEST(OPERATOR, LogSoftmax)
+{
+	test_softmax(eigen::log_softmax<double>,
+		[](double, double shifted, double lse)
+		{ return shifted - lse; });
+}
+
+
+TEST(OPERATOR, SoftmaxCrossEntropy)
+{
+	std::set<teq::RankT> rranks = {0};
+	marsh::Maps mvalues;
+	eigen::Packer<std::set<teq::RankT>>().pack(mvalues, rranks);
+
+	size_t lifetimes = 0;
+	auto incr_life = [&lifetimes]{ ++lifetimes; };
+
+	std::vector<double> label_raw{0, 0, 1, 0.5, 0.5, 0};
+	MockLeaf labels;
+	MockDeviceRef mockdev;
+	make_var(labels, label_raw.data(), mockdev, teq::Shape({3, 2}), "", incr_life);
+
+	std::vector<double> logit_raw{1, 2, 3, 1000, 1001, 1002};
+	MockLeaf logits;
+	MockDeviceRef mockdev2;
+	make_var(logits, logit_raw.data(), mockdev2, teq::Shape({3, 2}), "", incr_life);
+
+	std::vector<double> outdata(2);
+	auto memory = std::make_shared<MockRuntimeMemory>();
+
+	{
+#ifndef PERM_OP
+		auto outbytes = 2 * sizeof(double);
+		EXPECT_CALL(*memory, allocate(outbytes)).WillOnce(Return(outdata.data()));
+		EXPECT_CALL(*memory, deallocate(outdata.data(), outbytes)).Times(1);
+#endif
+		auto r = eigen::softmax_cross_entropy<double>(
+			teq::Shape({1, 2}), labels, logits, mvalues);
+
+		auto before = r->data();
+		eigen::RTMemptrT mem = memory;
+		r->assign(1, mem);
+		double* raw = (double*) r->data();
+		ASSERT_NE(nullptr, raw);
+#ifndef PERM_OP
+		EXPECT_EQ(nullptr, before);
+		EXPECT_EQ(outdata.data(), raw);
+#endif
+
+		double lse = std::log(std::exp(-2.) + std::exp(-1.) + 1.);
+		EXPECT_DOUBLE_EQ(lse, raw[0]);
+		EXPECT_DOUBLE_EQ(0.5 * ((lse + 1002) - 1000) +
+			0.5 * ((lse + 1002) - 1001), raw[1]);
+		EXPECT_EQ(2, lifetimes);
+	}
+}
+
+
 TEST(OPERATOR, Extend)
 {
 	marsh::Maps mvalues;
@@ -238,9 +353,6 @@ TEST(OPERATOR, Extend)
 
 TEST(OPERATOR, Permute)
 {
-	std::vector<double> outdata(12);
-	std::vector<double> outdata2(12);
-	std::vector<double> outdata3(6);
 	auto memory = std::make_shared<MockRuntimeMemory>();
 	{
 		marsh::Maps mvalues;
@@ -254,28 +366,33 @@ TEST(OPERATOR, Permute)
 		make_var(edge, orig_raw.data(), mockdev, teq::Shape({2, 2, 3}));
 
 		size_t lifetimes = 0;
+#ifdef PERM_OP
 		EXPECT_CALL(Const(mockdev), odata()).WillOnce(Invoke(
 		[&orig_raw, &lifetimes]() -> teq::Once<const void*>
 		{
 			teq::Once<const void*> out(orig_raw.data(), [&lifetimes]{ ++lifetimes; });
 			return out;
 		}));
-
-#ifndef PERM_OP
-		auto outbytes = 12 * sizeof(double);
-		EXPECT_CALL(*memory, allocate(outbytes)).WillOnce(Return(outdata.data()));
-		EXPECT_CALL(*memory, deallocate(outdata.data(), outbytes));
+#else
+		// views only release their input after their data is read
+		EXPECT_CALL(mockdev, odata()).WillOnce(Invoke(
+		[&orig_raw, &lifetimes]() -> teq::Once<void*>
+		{
+			teq::Once<void*> out(orig_raw.data(), [&lifetimes]{ ++lifetimes; });
+			return out;
+		}));
+		EXPECT_CALL(*memory, allocate(_)).Times(0);
 #endif
 		auto r = eigen::permute<double>(outshape, edge, mvalues);
 
-		auto before = r->data();
 		eigen::RTMemptrT mem = memory;
 		r->assign(1, mem);
 		double* raw = (double*) r->data();
 		ASSERT_NE(nullptr, raw);
 #ifndef PERM_OP
-		EXPECT_EQ(nullptr, before);
-		EXPECT_EQ(outdata.data(), raw);
+		// non-contiguous views are copied on request
+		EXPECT_NE(orig_raw.data(), raw);
+		r->odata();
 #endif
 
 		std::vector<double> expect_raw = {
@@ -298,28 +415,33 @@ TEST(OPERATOR, Permute)
 		make_var(edge, orig_raw.data(), mockdev, teq::Shape({2, 2, 3}));
 
 		size_t lifetimes = 0;
+#ifdef PERM_OP
 		EXPECT_CALL(Const(mockdev), odata()).WillOnce(Invoke(
 		[&orig_raw, &lifetimes]() -> teq::Once<const void*>
 		{
 			teq::Once<const void*> out(orig_raw.data(), [&lifetimes]{ ++lifetimes; });
 			return out;
 		}));
-
-#ifndef PERM_OP
-		auto outbytes = 12 * sizeof(double);
-		EXPECT_CALL(*memory, allocate(outbytes)).WillOnce(Return(outdata2.data()));
-		EXPECT_CALL(*memory, deallocate(outdata2.data(), outbytes));
+#else
+		// views only release their input after their data is read
+		EXPECT_CALL(mockdev, odata()).WillOnce(Invoke(
+		[&orig_raw, &lifetimes]() -> teq::Once<void*>
+		{
+			teq::Once<void*> out(orig_raw.data(), [&lifetimes]{ ++lifetimes; });
+			return out;
+		}));
+		EXPECT_CALL(*memory, allocate(_)).Times(0);
 #endif
 		auto r = eigen::permute<double>(outshape, edge, mvalues);
 
-		auto before = r->data();
 		eigen::RTMemptrT mem = memory;
 		r->assign(1, mem);
 		double* raw = (double*) r->data();
 		ASSERT_NE(nullptr, raw);
 #ifndef PERM_OP
-		EXPECT_EQ(nullptr, before);
-		EXPECT_EQ(outdata2.data(), raw);
+		// non-contiguous views are copied on request
+		EXPECT_NE(orig_raw.data(), raw);
+		r->odata();
 #endif
 
 		std::vector<double> expect_raw = {
@@ -342,28 +464,33 @@ TEST(OPERATOR, Permute)
 		make_var(edge, orig_raw.data(), mockdev, teq::Shape({2, 3}));
 
 		size_t lifetimes = 0;
+#ifdef PERM_OP
 		EXPECT_CALL(Const(mockdev), odata()).WillOnce(Invoke(
 		[&orig_raw, &lifetimes]() -> teq::Once<const void*>
 		{
 			teq::Once<const void*> out(orig_raw.data(), [&lifetimes]{ ++lifetimes; });
 			return out;
 		}));
-
-#ifndef PERM_OP
-		auto outbytes = 6 * sizeof(double);
-		EXPECT_CALL(*memory, allocate(outbytes)).WillOnce(Return(outdata3.data()));
-		EXPECT_CALL(*memory, deallocate(outdata3.data(), outbytes));
+#else
+		// views only release their input after their data is read
+		EXPECT_CALL(mockdev, odata()).WillOnce(Invoke(
+		[&orig_raw, &lifetimes]() -> teq::Once<void*>
+		{
+			teq::Once<void*> out(orig_raw.data(), [&lifetimes]{ ++lifetimes; });
+			return out;
+		}));
+		EXPECT_CALL(*memory, allocate(_)).Times(0);
 #endif
 		auto r = eigen::permute<double>(outshape, edge, mvalues);
 
-		auto before = r->data();
 		eigen::RTMemptrT mem = memory;
 		r->assign(1, mem);
 		double* raw = (double*) r->data();
 		ASSERT_NE(nullptr, raw);
 #ifndef PERM_OP
-		EXPECT_EQ(nullptr, before);
-		EXPECT_EQ(outdata3.data(), raw);
+		// non-contiguous views are copied on request
+		EXPECT_NE(orig_raw.data(), raw);
+		r->odata();
 #endif
 
 		std::vector<double> expect_raw = {2, 4, 6, 8, 5, 7};
@@ -376,7 +503,6 @@ TEST(OPERATOR, Permute)
 
 TEST(OPERATOR, Slice)
 {
-	std::vector<double> outdata(2);
 	auto memory = std::make_shared<MockRuntimeMemory>();
 
 	std::vector<double> orig_raw{2, 8, 4, 5, 6, 7};
@@ -391,28 +517,33 @@ TEST(OPERATOR, Slice)
 		teq::Shape outshape({2, 1});
 
 		size_t lifetimes = 0;
+#ifdef PERM_OP
 		EXPECT_CALL(Const(mockdev), odata()).WillOnce(Invoke(
 		[&orig_raw, &lifetimes]() -> teq::Once<const void*>
 		{
 			teq::Once<const void*> out(orig_raw.data(), [&lifetimes]{ ++lifetimes; });
 			return out;
 		}));
-
-#ifndef PERM_OP
-		auto outbytes = 2 * sizeof(double);
-		EXPECT_CALL(*memory, allocate(outbytes)).WillOnce(Return(outdata.data()));
-		EXPECT_CALL(*memory, deallocate(outdata.data(), outbytes));
+#else
+		// views only release their input after their data is read
+		EXPECT_CALL(mockdev, odata()).WillOnce(Invoke(
+		[&orig_raw, &lifetimes]() -> teq::Once<void*>
+		{
+			teq::Once<void*> out(orig_raw.data(), [&lifetimes]{ ++lifetimes; });
+			return out;
+		}));
+		EXPECT_CALL(*memory, allocate(_)).Times(0);
 #endif
 		auto r = eigen::slice<double>(outshape, edge, mvalues);
 
-		auto before = r->data();
 		eigen::RTMemptrT mem = memory;
 		r->assign(1, mem);
 		double* raw = (double*) r->data();
 		ASSERT_NE(nullptr, raw);
 #ifndef PERM_OP
-		EXPECT_EQ(nullptr, before);
-		EXPECT_EQ(outdata.data(), raw);
+		// contiguous views read their input in place
+		EXPECT_EQ(orig_raw.data() + 4, raw);
+		r->odata();
 #endif
 
 		std::vector<double> expect_raw = {6, 7};
@@ -2142,33 +2273,37 @@ TEST(OPERATOR, Stride)
 	MockDeviceRef mockdev;
 	make_var(edge, orig_raw.data(), mockdev, teq::Shape({2, 3}));
 
-	std::vector<double> outdata(4);
 	auto memory = std::make_shared<MockRuntimeMemory>();
 
 	{
 		size_t lifetimes = 0;
+#ifdef PERM_OP
 		EXPECT_CALL(Const(mockdev), odata()).WillOnce(Invoke(
 		[&orig_raw, &lifetimes]() -> teq::Once<const void*>
 		{
 			teq::Once<const void*> out(orig_raw.data(), [&lifetimes]{ ++lifetimes; });
 			return out;
 		}));
-
-#ifndef PERM_OP
-		auto outbytes = 4 * sizeof(double);
-		EXPECT_CALL(*memory, allocate(outbytes)).WillOnce(Return(outdata.data()));
-		EXPECT_CALL(*memory, deallocate(outdata.data(), outbytes)).Times(1);
+#else
+		// views only release their input after their data is read
+		EXPECT_CALL(mockdev, odata()).WillOnce(Invoke(
+		[&orig_raw, &lifetimes]() -> teq::Once<void*>
+		{
+			teq::Once<void*> out(orig_raw.data(), [&lifetimes]{ ++lifetimes; });
+			return out;
+		}));
+		EXPECT_CALL(*memory, allocate(_)).Times(0);
 #endif
 		auto r = eigen::stride<double>(outshape, edge, mvalues);
 
-		auto before = r->data();
 		eigen::RTMemptrT mem = memory;
 		r->assign(1, mem);
 		double* raw = (double*) r->data();
 		ASSERT_NE(nullptr, raw);
 #ifndef PERM_OP
-		EXPECT_EQ(nullptr, before);
-		EXPECT_EQ(outdata.data(), raw);
+		// non-contiguous views are copied on request
+		EXPECT_NE(orig_raw.data(), raw);
+		r->odata();
 #endif
 
 		std::vector<double> expect_raw = {
@@ -2233,35 +2368,38 @@ TEST(OPERATOR, Scatter)
 }
 
 
-TEST(OPERATOR, Reverse)
+static void test_pool (
+	std::function<eigen::EigenptrT(teq::Shape,
+		const teq::iTensor&,const marsh::Maps& attr)> pool,
+	std::vector<double> expect_raw)
 {
-	std::vector<double> outdata(6);
-	auto memory = std::make_shared<MockRuntimeMemory>();
-
+	// window of 2x2 striding 2 along dimension 0 and 1 along dimension 1
 	marsh::Maps mvalues;
-	eigen::Packer<std::set<teq::RankT>>().pack(mvalues, {1});
+	eigen::Packer<eigen::PairVecT<teq::DimT>>().pack(mvalues, {{2, 2}, {2, 1}});
 
-	teq::Shape outshape({2, 3});
-	std::vector<double> orig_raw{2, 8, 4, 5, 6, 7};
-	MockLeaf edge;
-	MockDeviceRef mockdev;
-	make_var(edge, orig_raw.data(), mockdev, outshape);
+	teq::Shape outshape({2, 2});
+	std::vector<double> outdata(4);
+	auto memory = std::make_shared<MockRuntimeMemory>();
 
-	size_t lifetimes = 0;
-	EXPECT_CALL(Const(mockdev), odata()).WillOnce(Invoke(
-	[&orig_raw, &lifetimes]() -> teq::Once<const void*>
 	{
-		teq::Once<const void*> out(orig_raw.data(), [&lifetimes]{ ++lifetimes; });
-		return out;
-	}));
+		size_t lifetimes = 0;
+		auto incr_life = [&lifetimes]{ ++lifetimes; };
+
+		std::vector<double> orig_raw{
+			1, 5, 3, 4,
+			2, 2, 8, 0,
+			7, 1, 1, 1,
+		};
+		MockLeaf edge;
+		MockDeviceRef mockdev;
+		make_var(edge, orig_raw.data(), mockdev, teq::Shape({4, 3}), "", incr_life);
 
-	{
 #ifndef PERM_OP
-		auto outbytes = 6 * sizeof(double);
+		auto outbytes = 4 * sizeof(double);
 		EXPECT_CALL(*memory, allocate(outbytes)).WillOnce(Return(outdata.data()));
 		EXPECT_CALL(*memory, deallocate(outdata.data(), outbytes)).Times(1);
 #endif
-		auto r = eigen::reverse<double>(outshape, edge, mvalues);
+		auto r = pool(outshape, edge, mvalues);
 
 		auto before = r->data();
 		eigen::RTMemptrT mem = memory;
@@ -2273,9 +2411,6 @@ TEST(OPERATOR, Reverse)
 		EXPECT_EQ(outdata.data(), raw);
 #endif
 
-		std::vector<double> expect_raw = {
-			6, 7, 4, 5, 2, 8
-		};
 		std::vector<double> got_raw(raw, raw + outshape.n_elems());
 		EXPECT_VECEQ(expect_raw, got_raw);
 		EXPECT_EQ(1, lifetimes);
@@ -2283,43 +2418,58 @@ TEST(OPERATOR, Reverse)
 }
 
 
-TEST(OPERATOR, Concat)
+TEST(OPERATOR, MaxPool)
 {
-	std::vector<double> outdata(9);
-	auto memory = std::make_shared<MockRuntimeMemory>();
+	test_pool(eigen::max_pool<double>, {5, 8, 7, 8});
+}
 
-	marsh::Maps mvalues;
-	eigen::Packer<teq::RankT>().pack(mvalues, 0);
 
-	teq::Shape outshape({3, 3});
-	std::vector<double> orig_rawa{2, 8, 4, 5, 7, 6};
-	std::vector<double> orig_rawb{1, 0, 3};
-	MockDeviceRef mockdeva;
-	MockDeviceRef mockdevb;
-	auto edgea = make_var(orig_rawa.data(), mockdeva, teq::Shape({2, 3}));
-	auto edgeb = make_var(orig_rawb.data(), mockdevb, teq::Shape({1, 3}));
+TEST(OPERATOR, AvgPool)
+{
+	test_pool(eigen::avg_pool<double>, {2.5, 3.75, 3, 2.5});
+}
+
+
+TEST(OPERATOR, MaxPoolGrad)
+{
+	marsh::Maps mvalues;
+	eigen::Packer<eigen::PairVecT<teq::DimT>>().pack(mvalues, {{2, 2}, {2, 1}});
 
 	size_t lifetimes = 0;
-	EXPECT_CALL(Const(mockdeva), odata()).WillOnce(Invoke(
-	[&orig_rawa, &lifetimes]() -> teq::Once<const void*>
-	{
-		teq::Once<const void*> out(orig_rawa.data(), [&lifetimes]{ ++lifetimes; });
-		return out;
-	}));
-	EXPECT_CALL(Const(mockdevb), odata()).WillOnce(Invoke(
-	[&orig_rawb, &lifetimes]() -> teq::Once<const void*>
-	{
-		teq::Once<const void*> out(orig_rawb.data(), [&lifetimes]{ ++lifetimes; });
-		return out;
-	}));
+	auto incr_life = [&lifetimes]{ ++lifetimes; };
+
+	// 5 appears twice in the first window,
+	// but only its first occurrence receives the gradient
+	std::vector<double> orig_raw{
+		1, 5, 3, 4,
+		5, 2, 8, 0,
+		7, 1, 1, 1,
+	};
+	MockLeaf edge;
+	MockDeviceRef mockdev;
+	make_var(edge, orig_raw.data(), mockdev, teq::Shape({4, 3}), "", incr_life);
+
+	std::vector<double> pooled_raw{5, 8, 7, 8};
+	MockLeaf pooled;
+	MockDeviceRef mockdev2;
+	make_var(pooled, pooled_raw.data(), mockdev2, teq::Shape({2, 2}), "", incr_life);
+
+	std::vector<double> grad_raw{1, 2, 3, 4};
+	MockLeaf grad;
+	MockDeviceRef mockdev3;
+	make_var(grad, grad_raw.data(), mockdev3, teq::Shape({2, 2}), "", incr_life);
+
+	teq::Shape outshape({4, 3});
+	std::vector<double> outdata(12);
+	auto memory = std::make_shared<MockRuntimeMemory>();
 
 	{
 #ifndef PERM_OP
-		auto outbytes = 9 * sizeof(double);
+		auto outbytes = 12 * sizeof(double);
 		EXPECT_CALL(*memory, allocate(outbytes)).WillOnce(Return(outdata.data()));
 		EXPECT_CALL(*memory, deallocate(outdata.data(), outbytes)).Times(1);
 #endif
-		auto r = eigen::concat<double>(outshape, teq::TensptrsT{edgea, edgeb}, mvalues);
+		auto r = eigen::max_pool_grad<double>(outshape, edge, pooled, grad, mvalues);
 
 		auto before = r->data();
 		eigen::RTMemptrT mem = memory;
@@ -2331,43 +2481,208 @@ TEST(OPERATOR, Concat)
 		EXPECT_EQ(outdata.data(), raw);
 #endif
 
+		// overlapping windows accumulate gradients of their shared maximum
 		std::vector<double> expect_raw = {
-			2, 8, 1,
-			4, 5, 0,
-			7, 6, 3,
+			0, 1, 0, 0,
+			0, 0, 6, 0,
+			3, 0, 0, 0,
 		};
 		std::vector<double> got_raw(raw, raw + outshape.n_elems());
 		EXPECT_VECEQ(expect_raw, got_raw);
-		EXPECT_EQ(2, lifetimes);
+		EXPECT_EQ(3, lifetimes);
 	}
 }
 
 
-#define _DBLARRCHECK(ARR, ARR2, GBOOL) { std::stringstream arrs, arrs2;\
-	fmts::to_stream(arrs, ARR.begin(), ARR.end());\
-	fmts::to_stream(arrs2, ARR2.begin(), ARR2.end());\
-	GBOOL(std::equal(ARR.begin(), ARR.end(), ARR2.begin())) <<\
-		"expect list " << arrs.str() << ", got " << arrs2.str() << " instead"; }
-#define ASSERT_ARRDBLEQ(ARR, ARR2) { std::stringstream arrs, arrs2;\
-	fmts::to_stream(arrs, ARR.begin(), ARR.end());\
-	fmts::to_stream(arrs2, ARR2.begin(), ARR2.end());\
-	ASSERT_EQ(ARR.size(), ARR2.size()) <<\
-		"expect list " << arrs.str() << ", got " << arrs2.str() << " instead";\
-	for (size_t i = 0, n = ARR.size(); i < n; ++i){\
-		ASSERT_DOUBLE_EQ(ARR[i], ARR2[i]) <<\
-			"expect list " << arrs.str() << ", got " << arrs2.str() << " instead";\
-	} }
+TEST(OPERATOR, AvgPoolGrad)
+{
+	marsh::Maps mvalues;
+	eigen::Packer<eigen::PairVecT<teq::DimT>>().pack(mvalues, {{2, 2}, {2, 1}});
 
+	size_t lifetimes = 0;
+	auto incr_life = [&lifetimes]{ ++lifetimes; };
 
-static void elementary_unary (
-	std::function<eigen::EigenptrT(teq::Shape,const teq::iTensor&)> f,
-	std::function<double(double)> unary,
-	std::vector<double> invec = {-2, 8, -4, -5, 7, 6})
-{
-	std::vector<double> outdata(6);
-	auto memory = std::make_shared<MockRuntimeMemory>();
+	std::vector<double> grad_raw{4, 8, 12, 16};
+	MockLeaf grad;
+	MockDeviceRef mockdev;
+	make_var(grad, grad_raw.data(), mockdev, teq::Shape({2, 2}), "", incr_life);
 
-	std::vector<double> expect;
+	teq::Shape outshape({4, 3});
+	std::vector<double> outdata(12);
+	auto memory = std::make_shared<MockRuntimeMemory>();
+
+	{
+#ifndef PERM_OP
+		auto outbytes = 12 * sizeof(double);
+		EXPECT_CALL(*memory, allocate(outbytes)).WillOnce(Return(outdata.data()));
+		EXPECT_CALL(*memory, deallocate(outdata.data(), outbytes)).Times(1);
+#endif
+		auto r = eigen::avg_pool_grad<double>(outshape, grad, mvalues);
+
+		auto before = r->data();
+		eigen::RTMemptrT mem = memory;
+		r->assign(1, mem);
+		double* raw = (double*) r->data();
+		ASSERT_NE(nullptr, raw);
+#ifndef PERM_OP
+		EXPECT_EQ(nullptr, before);
+		EXPECT_EQ(outdata.data(), raw);
+#endif
+
+		std::vector<double> expect_raw = {
+			1, 1, 2, 2,
+			4, 4, 6, 6,
+			3, 3, 4, 4,
+		};
+		std::vector<double> got_raw(raw, raw + outshape.n_elems());
+		EXPECT_VECEQ(expect_raw, got_raw);
+		EXPECT_EQ(1, lifetimes);
+	}
+}
+
+
+TEST(OPERATOR, Reverse)
+{
+	auto memory = std::make_shared<MockRuntimeMemory>();
+
+	marsh::Maps mvalues;
+	eigen::Packer<std::set<teq::RankT>>().pack(mvalues, {1});
+
+	teq::Shape outshape({2, 3});
+	std::vector<double> orig_raw{2, 8, 4, 5, 6, 7};
+	MockLeaf edge;
+	MockDeviceRef mockdev;
+	make_var(edge, orig_raw.data(), mockdev, outshape);
+
+	size_t lifetimes = 0;
+#ifdef PERM_OP
+	EXPECT_CALL(Const(mockdev), odata()).WillOnce(Invoke(
+	[&orig_raw, &lifetimes]() -> teq::Once<const void*>
+	{
+		teq::Once<const void*> out(orig_raw.data(), [&lifetimes]{ ++lifetimes; });
+		return out;
+	}));
+#else
+	// views only release their input after their data is read
+	EXPECT_CALL(mockdev, odata()).WillOnce(Invoke(
+	[&orig_raw, &lifetimes]() -> teq::Once<void*>
+	{
+		teq::Once<void*> out(orig_raw.data(), [&lifetimes]{ ++lifetimes; });
+		return out;
+	}));
+#endif
+
+	{
+#ifndef PERM_OP
+		EXPECT_CALL(*memory, allocate(_)).Times(0);
+#endif
+		auto r = eigen::reverse<double>(outshape, edge, mvalues);
+
+		eigen::RTMemptrT mem = memory;
+		r->assign(1, mem);
+		double* raw = (double*) r->data();
+		ASSERT_NE(nullptr, raw);
+#ifndef PERM_OP
+		// non-contiguous views are copied on request
+		EXPECT_NE(orig_raw.data(), raw);
+		r->odata();
+#endif
+
+		std::vector<double> expect_raw = {
+			6, 7, 4, 5, 2, 8
+		};
+		std::vector<double> got_raw(raw, raw + outshape.n_elems());
+		EXPECT_VECEQ(expect_raw, got_raw);
+		EXPECT_EQ(1, lifetimes);
+	}
+}
+
+
+TEST(OPERATOR, Concat)
+{
+	std::vector<double> outdata(9);
+	auto memory = std::make_shared<MockRuntimeMemory>();
+
+	marsh::Maps mvalues;
+	eigen::Packer<teq::RankT>().pack(mvalues, 0);
+
+	teq::Shape outshape({3, 3});
+	std::vector<double> orig_rawa{2, 8, 4, 5, 7, 6};
+	std::vector<double> orig_rawb{1, 0, 3};
+	MockDeviceRef mockdeva;
+	MockDeviceRef mockdevb;
+	auto edgea = make_var(orig_rawa.data(), mockdeva, teq::Shape({2, 3}));
+	auto edgeb = make_var(orig_rawb.data(), mockdevb, teq::Shape({1, 3}));
+
+	size_t lifetimes = 0;
+	EXPECT_CALL(Const(mockdeva), odata()).WillOnce(Invoke(
+	[&orig_rawa, &lifetimes]() -> teq::Once<const void*>
+	{
+		teq::Once<const void*> out(orig_rawa.data(), [&lifetimes]{ ++lifetimes; });
+		return out;
+	}));
+	EXPECT_CALL(Const(mockdevb), odata()).WillOnce(Invoke(
+	[&orig_rawb, &lifetimes]() -> teq::Once<const void*>
+	{
+		teq::Once<const void*> out(orig_rawb.data(), [&lifetimes]{ ++lifetimes; });
+		return out;
+	}));
+
+	{
+#ifndef PERM_OP
+		auto outbytes = 9 * sizeof(double);
+		EXPECT_CALL(*memory, allocate(outbytes)).WillOnce(Return(outdata.data()));
+		EXPECT_CALL(*memory, deallocate(outdata.data(), outbytes)).Times(1);
+#endif
+		auto r = eigen::concat<double>(outshape, teq::TensptrsT{edgea, edgeb}, mvalues);
+
+		auto before = r->data();
+		eigen::RTMemptrT mem = memory;
+		r->assign(1, mem);
+		double* raw = (double*) r->data();
+		ASSERT_NE(nullptr, raw);
+#ifndef PERM_OP
+		EXPECT_EQ(nullptr, before);
+		EXPECT_EQ(outdata.data(), raw);
+#endif
+
+		std::vector<double> expect_raw = {
+			2, 8, 1,
+			4, 5, 0,
+			7, 6, 3,
+		};
+		std::vector<double> got_raw(raw, raw + outshape.n_elems());
+		EXPECT_VECEQ(expect_raw, got_raw);
+		EXPECT_EQ(2, lifetimes);
+	}
+}
+
+
+#define _DBLARRCHECK(ARR, ARR2, GBOOL) { std::stringstream arrs, arrs2;\
+	fmts::to_stream(arrs, ARR.begin(), ARR.end());\
+	fmts::to_stream(arrs2, ARR2.begin(), ARR2.end());\
+	GBOOL(std::equal(ARR.begin(), ARR.end(), ARR2.begin())) <<\
+		"expect list " << arrs.str() << ", got " << arrs2.str() << " instead"; }
+#define ASSERT_ARRDBLEQ(ARR, ARR2) { std::stringstream arrs, arrs2;\
+	fmts::to_stream(arrs, ARR.begin(), ARR.end());\
+	fmts::to_stream(arrs2, ARR2.begin(), ARR2.end());\
+	ASSERT_EQ(ARR.size(), ARR2.size()) <<\
+		"expect list " << arrs.str() << ", got " << arrs2.str() << " instead";\
+	for (size_t i = 0, n = ARR.size(); i < n; ++i){\
+		ASSERT_DOUBLE_EQ(ARR[i], ARR2[i]) <<\
+			"expect list " << arrs.str() << ", got " << arrs2.str() << " instead";\
+	} }
+
+
+static void elementary_unary (
+	std::function<eigen::EigenptrT(teq::Shape,const teq::iTensor&)> f,
+	std::function<double(double)> unary,
+	std::vector<double> invec = {-2, 8, -4, -5, 7, 6})
+{
+	std::vector<double> outdata(6);
+	auto memory = std::make_shared<MockRuntimeMemory>();
+
+	std::vector<double> expect;
 	std::transform(invec.begin(), invec.end(), std::back_inserter(expect),
 	[&](double e){ return unary(e); });
 	{
@@ -2644,6 +2959,382 @@ TEST(OPERATOR, Convolution)
 }
 
 
+TEST(OPERATOR, Conv2d)
+{
+	// pad width by 1 before the image and stride 2 along width
+	marsh::Maps mvalues;
+	eigen::Packer<teq::DimsT>().pack(mvalues, {2, 1});
+	eigen::Packer<eigen::PairVecT<teq::DimT>>().pack(mvalues, {{1, 0}, {0, 0}});
+
+	size_t lifetimes = 0;
+	auto incr_life = [&lifetimes]{ ++lifetimes; };
+
+	std::vector<double> orig_raw{
+		1, 2, 3,
+		4, 5, 6,
+		7, 8, 9,
+	};
+	MockLeaf image;
+	MockDeviceRef mockdev;
+	make_var(image, orig_raw.data(), mockdev, teq::Shape({1, 3, 3, 1}), "", incr_life);
+
+	std::vector<double> orig_raw2{1, 2, 3, 4};
+	MockLeaf kernel;
+	MockDeviceRef mockdev2;
+	make_var(kernel, orig_raw2.data(), mockdev2, teq::Shape({1, 1, 2, 2}), "", incr_life);
+
+	teq::Shape outshape({1, 2, 2, 1});
+	std::vector<double> outdata(4);
+	auto memory = std::make_shared<MockRuntimeMemory>();
+
+	{
+#ifndef PERM_OP
+		auto outbytes = 4 * sizeof(double);
+		EXPECT_CALL(*memory, allocate(outbytes)).WillOnce(Return(outdata.data()));
+		EXPECT_CALL(*memory, deallocate(outdata.data(), outbytes)).Times(1);
+#endif
+		auto r = eigen::conv2d<double>(outshape, image, kernel, mvalues);
+
+		auto before = r->data();
+		eigen::RTMemptrT mem = memory;
+		r->assign(1, mem);
+		double* raw = (double*) r->data();
+		ASSERT_NE(nullptr, raw);
+#ifndef PERM_OP
+		EXPECT_EQ(nullptr, before);
+		EXPECT_EQ(outdata.data(), raw);
+#endif
+
+		// windows of the first output column only overlap padding and image column 0
+		std::vector<double> expect_raw = {
+			2 * 1 + 4 * 4, 1 * 2 + 2 * 3 + 3 * 5 + 4 * 6,
+			2 * 4 + 4 * 7, 1 * 5 + 2 * 6 + 3 * 8 + 4 * 9,
+		};
+		std::vector<double> got_raw(raw, raw + outshape.n_elems());
+		EXPECT_VECEQ(expect_raw, got_raw);
+		EXPECT_EQ(2, lifetimes);
+	}
+}
+
+
+TEST(OPERATOR, Conv2dImageGrad)
+{
+	marsh::Maps mvalues;
+
+	size_t lifetimes = 0;
+	auto incr_life = [&lifetimes]{ ++lifetimes; };
+
+	std::vector<double> orig_raw{1, 2, 3, 4};
+	MockLeaf kernel;
+	MockDeviceRef mockdev;
+	make_var(kernel, orig_raw.data(), mockdev, teq::Shape({1, 1, 2, 2}), "", incr_life);
+
+	std::vector<double> orig_raw2{1, 1, 1, 1};
+	MockLeaf grad;
+	MockDeviceRef mockdev2;
+	make_var(grad, orig_raw2.data(), mockdev2, teq::Shape({1, 2, 2, 1}), "", incr_life);
+
+	teq::Shape outshape({1, 3, 3, 1});
+	std::vector<double> outdata(9);
+	auto memory = std::make_shared<MockRuntimeMemory>();
+
+	{
+#ifndef PERM_OP
+		auto outbytes = 9 * sizeof(double);
+		EXPECT_CALL(*memory, allocate(outbytes)).WillOnce(Return(outdata.data()));
+		EXPECT_CALL(*memory, deallocate(outdata.data(), outbytes)).Times(1);
+#endif
+		auto r = eigen::conv2d_image_grad<double>(outshape, kernel, grad, mvalues);
+
+		auto before = r->data();
+		eigen::RTMemptrT mem = memory;
+		r->assign(1, mem);
+		double* raw = (double*) r->data();
+		ASSERT_NE(nullptr, raw);
+#ifndef PERM_OP
+		EXPECT_EQ(nullptr, before);
+		EXPECT_EQ(outdata.data(), raw);
+#endif
+
+		// each image element accumulates kernel elements of windows covering it
+		std::vector<double> expect_raw = {
+			1, 1 + 2, 2,
+			1 + 3, 1 + 2 + 3 + 4, 2 + 4,
+			3, 3 + 4, 4,
+		};
+		std::vector<double> got_raw(raw, raw + outshape.n_elems());
+		EXPECT_VECEQ(expect_raw, got_raw);
+		EXPECT_EQ(2, lifetimes);
+	}
+}
+
+
+TEST(OPERATOR, Conv2dKernelGrad)
+{
+	marsh::Maps mvalues;
+
+	size_t lifetimes = 0;
+	auto incr_life = [&lifetimes]{ ++lifetimes; };
+
+	std::vector<double> orig_raw{
+		1, 2, 3,
+		4, 5, 6,
+		7, 8, 9,
+	};
+	MockLeaf image;
+	MockDeviceRef mockdev;
+	make_var(image, orig_raw.data(), mockdev, teq::Shape({1, 3, 3, 1}), "", incr_life);
+
+	std::vector<double> orig_raw2{1, 0, 0, 2};
+	MockLeaf grad;
+	MockDeviceRef mockdev2;
+	make_var(grad, orig_raw2.data(), mockdev2, teq::Shape({1, 2, 2, 1}), "", incr_life);
+
+	teq::Shape outshape({1, 1, 2, 2});
+	std::vector<double> outdata(4);
+	auto memory = std::make_shared<MockRuntimeMemory>();
+
+	{
+#ifndef PERM_OP
+		auto outbytes = 4 * sizeof(double);
+		EXPECT_CALL(*memory, allocate(outbytes)).WillOnce(Return(outdata.data()));
+		EXPECT_CALL(*memory, deallocate(outdata.data(), outbytes)).Times(1);
+#endif
+		auto r = eigen::conv2d_kernel_grad<double>(outshape, image, grad, mvalues);
+
+		auto before = r->data();
+		eigen::RTMemptrT mem = memory;
+		r->assign(1, mem);
+		double* raw = (double*) r->data();
+		ASSERT_NE(nullptr, raw);
+#ifndef PERM_OP
+		EXPECT_EQ(nullptr, before);
+		EXPECT_EQ(outdata.data(), raw);
+#endif
+
+		std::vector<double> expect_raw = {
+			1 + 2 * 5, 2 + 2 * 6,
+			4 + 2 * 8, 5 + 2 * 9,
+		};
+		std::vector<double> got_raw(raw, raw + outshape.n_elems());
+		EXPECT_VECEQ(expect_raw, got_raw);
+		EXPECT_EQ(2, lifetimes);
+	}
+}
+
+static double sigmoid (double x)
+{
+	return 1 / (1 + std::exp(-x));
+}
+
+
+static void cell_test (
+	std::function<eigen::EigenptrT(teq::Shape,const teq::TensptrsT&)> f,
+	teq::Shape outshape, std::vector<std::vector<double>>& datas,
+	const std::vector<teq::Shape>& shapes, const std::vector<double>& expect)
+{
+	size_t lifetimes = 0;
+	auto incr_life = [&lifetimes]{ ++lifetimes; };
+
+	size_t nargs = datas.size();
+	std::vector<MockDeviceRef> mockdevs(nargs);
+	teq::TensptrsT group;
+	for (size_t i = 0; i < nargs; ++i)
+	{
+		group.push_back(make_var(datas[i].data(), mockdevs[i],
+			shapes[i], "", incr_life));
+	}
+
+	size_t n = outshape.n_elems();
+	std::vector<double> outdata(n);
+	auto memory = std::make_shared<MockRuntimeMemory>();
+	{
+#ifndef PERM_OP
+		auto outbytes = n * sizeof(double);
+		EXPECT_CALL(*memory, allocate(outbytes)).WillOnce(Return(outdata.data()));
+		EXPECT_CALL(*memory, deallocate(outdata.data(), outbytes)).Times(1);
+#endif
+		auto r = f(outshape, group);
+
+		auto before = r->data();
+		eigen::RTMemptrT mem = memory;
+		r->assign(1, mem);
+		double* raw = (double*) r->data();
+		ASSERT_NE(nullptr, raw);
+#ifndef PERM_OP
+		EXPECT_EQ(nullptr, before);
+		EXPECT_EQ(outdata.data(), raw);
+#endif
+
+		ASSERT_EQ(expect.size(), n);
+		for (size_t i = 0; i < n; ++i)
+		{
+			EXPECT_NEAR(expect[i], raw[i], 1e-9) << "at index " << i;
+		}
+		EXPECT_EQ(nargs, lifetimes);
+	}
+}
+
+
+TEST(OPERATOR, LstmCell)
+{
+	// input dimension and hidden dimension of 1 over batch of 2,
+	// weight row 0 multiplies input and row 1 multiplies hidden
+	std::vector<std::vector<double>> datas = {
+		{0.5, -1},
+		{0.2, 0.4},
+		{1, -0.5},
+		{
+			0.1, 0.2, 0.3, 0.4,
+			-0.3, 0.5, -0.1, 0.2,
+		},
+		{0.1, -0.1, 0.2, 0},
+	};
+	std::vector<double> expect;
+	for (size_t b = 0; b < 2; ++b)
+	{
+		double x = datas[0][b];
+		double h = datas[1][b];
+		double c = datas[2][b];
+		auto& w = datas[3];
+		auto& bias = datas[4];
+		double cand = std::tanh(w[0] * x + w[4] * h + bias[0]);
+		double forget = sigmoid(w[1] * x + w[5] * h + bias[1]);
+		double in = sigmoid(w[2] * x + w[6] * h + bias[2]);
+		double out = sigmoid(w[3] * x + w[7] * h + bias[3]);
+		double next = cand * in + c * forget;
+		expect.push_back(next);
+		expect.push_back(next * out);
+	}
+	cell_test(eigen::lstm_cell<double>, teq::Shape({2, 2}), datas,
+		{teq::Shape({1, 2}), teq::Shape({1, 2}), teq::Shape({1, 2}),
+		teq::Shape({4, 2}), teq::Shape({4})}, expect);
+
+	// without bias
+	datas.pop_back();
+	expect.clear();
+	for (size_t b = 0; b < 2; ++b)
+	{
+		double x = datas[0][b];
+		double h = datas[1][b];
+		double c = datas[2][b];
+		auto& w = datas[3];
+		double next = std::tanh(w[0] * x + w[4] * h) *
+			sigmoid(w[2] * x + w[6] * h) + c * sigmoid(w[1] * x + w[5] * h);
+		expect.push_back(next);
+		expect.push_back(next * sigmoid(w[3] * x + w[7] * h));
+	}
+	cell_test(eigen::lstm_cell<double>, teq::Shape({2, 2}), datas,
+		{teq::Shape({1, 2}), teq::Shape({1, 2}), teq::Shape({1, 2}),
+		teq::Shape({4, 2})}, expect);
+}
+
+
+TEST(OPERATOR, LstmCellGrad)
+{
+	std::vector<std::vector<double>> datas = {
+		{0.5, -1},
+		{0.2, 0.4},
+		{1, -0.5},
+		{
+			0.1, 0.2, 0.3, 0.4,
+			-0.3, 0.5, -0.1, 0.2,
+		},
+		{0.3, 1, -2, 0.5},
+	};
+	std::vector<double> expect;
+	for (size_t b = 0; b < 2; ++b)
+	{
+		double x = datas[0][b];
+		double h = datas[1][b];
+		auto& w = datas[3];
+		auto& grad = datas[4];
+		double forget = sigmoid(w[1] * x + w[5] * h);
+		double out = sigmoid(w[3] * x + w[7] * h);
+		expect.push_back((grad[2 * b] + grad[2 * b + 1] * out) * forget);
+	}
+
+	marsh::Maps mvalues;
+	eigen::Packer<teq::RankT>().pack(mvalues, 2);
+	cell_test(
+		[&mvalues](teq::Shape outshape, const teq::TensptrsT& group)
+		{
+			return eigen::lstm_cell_grad<double>(outshape, group, mvalues);
+		}, teq::Shape({1, 2}), datas,
+		{teq::Shape({1, 2}), teq::Shape({1, 2}), teq::Shape({1, 2}),
+		teq::Shape({4, 2}), teq::Shape({2, 2})}, expect);
+}
+
+
+TEST(OPERATOR, GruCell)
+{
+	std::vector<std::vector<double>> datas = {
+		{0.5, -1},
+		{1, -0.5},
+		{
+			0.1, 0.2, 0.3,
+			-0.3, 0.5, -0.1,
+		},
+		{0.1, -0.1, 0.2},
+	};
+	std::vector<double> expect;
+	for (size_t b = 0; b < 2; ++b)
+	{
+		double x = datas[0][b];
+		double s = datas[1][b];
+		auto& w = datas[2];
+		auto& bias = datas[3];
+		double update = sigmoid(w[0] * x + w[3] * s + bias[0]);
+		double reset = sigmoid(w[1] * x + w[4] * s + bias[1]);
+		double cand = std::tanh(w[2] * x + w[5] * reset * s + bias[2]);
+		expect.push_back(update * s + (1 - update) * cand);
+	}
+	cell_test(eigen::gru_cell<double>, teq::Shape({1, 2}), datas,
+		{teq::Shape({1, 2}), teq::Shape({1, 2}),
+		teq::Shape({3, 2}), teq::Shape({3})}, expect);
+}
+
+
+TEST(OPERATOR, GruCellGrad)
+{
+	std::vector<std::vector<double>> datas = {
+		{0.5, -1},
+		{1, -0.5},
+		{
+			0.1, 0.2, 0.3,
+			-0.3, 0.5, -0.1,
+		},
+		{2, -1},
+	};
+	// gradient with respect to input
+	std::vector<double> expect;
+	for (size_t b = 0; b < 2; ++b)
+	{
+		double x = datas[0][b];
+		double s = datas[1][b];
+		auto& w = datas[2];
+		double grad = datas[3][b];
+		double update = sigmoid(w[0] * x + w[3] * s);
+		double reset = sigmoid(w[1] * x + w[4] * s);
+		double cand = std::tanh(w[2] * x + w[5] * reset * s);
+		double dupdate = grad * (s - cand) * update * (1 - update);
+		double dcand = grad * (1 - update) * (1 - cand * cand);
+		double dreset = dcand * w[5] * s * reset * (1 - reset);
+		expect.push_back(dupdate * w[0] + dreset * w[1] + dcand * w[2]);
+	}
+
+	marsh::Maps mvalues;
+	eigen::Packer<teq::RankT>().pack(mvalues, 0);
+	cell_test(
+		[&mvalues](teq::Shape outshape, const teq::TensptrsT& group)
+		{
+			return eigen::gru_cell_grad<double>(outshape, group, mvalues);
+		}, teq::Shape({1, 2}), datas,
+		{teq::Shape({1, 2}), teq::Shape({1, 2}),
+		teq::Shape({3, 2}), teq::Shape({1, 2})}, expect);
+}
+
+
 TEST(OPERATOR, Assign)
 {
 	teq::Shape outshape({2, 3});
@@ -2879,4 +3570,74 @@ TEST(OPERATOR, Cast)
 }
 
 
+#ifdef EGEN_FULLTYPE
+
+
+TEST(OPERATOR, CastHalf)
+{
+	std::vector<Eigen::half> outdata(6);
+	auto memory = std::make_shared<MockRuntimeMemory>();
+
+	teq::Shape outshape({2, 3});
+	std::vector<float> a{2.5, 8.5, -4.25, 5, 0.125, 7};
+	MockDeviceRef mockdev;
+	MockMeta mockmeta;
+	auto edgea = make_var(a.data(), mockdev, outshape);
+	EXPECT_CALL(*edgea, get_meta()).WillRepeatedly(ReturnRef(mockmeta));
+	EXPECT_CALL(mockmeta, type_label()).WillRepeatedly(Return(egen::name_type(egen::FLOAT)));
+	EXPECT_CALL(mockmeta, type_code()).WillRepeatedly(Return(egen::FLOAT));
+
+#ifndef PERM_OP
+	auto outbytes = 6 * sizeof(Eigen::half);
+	EXPECT_CALL(*memory, allocate(outbytes)).WillOnce(Return(outdata.data()));
+	EXPECT_CALL(*memory, deallocate(outdata.data(), outbytes)).Times(1);
+#endif
+	auto r = eigen::cast<Eigen::half>(edgea);
+
+	eigen::RTMemptrT mem = memory;
+	r->assign(1, mem);
+	Eigen::half* raw = (Eigen::half*) r->data();
+	ASSERT_NE(nullptr, raw);
+
+	// every value is exactly representable in 16 bits
+	for (size_t i = 0, n = outshape.n_elems(); i < n; ++i)
+	{
+		EXPECT_EQ(a[i], (float) raw[i]);
+	}
+}
+
+
+TEST(OPERATOR, HalfReduceSumAccumulatesInFloat)
+{
+	std::set<teq::RankT> rranks = {0};
+	marsh::Maps mvalues;
+	eigen::Packer<std::set<teq::RankT>>().pack(mvalues, rranks);
+	std::vector<Eigen::half> outdata(1);
+	auto memory = std::make_shared<MockRuntimeMemory>();
+
+	// summing in half drifts to ~105 due to rounding on every addition
+	teq::DimT n = 1000;
+	std::vector<Eigen::half> tenths(n, Eigen::half(0.1));
+	MockLeaf edge;
+	MockDeviceRef mockdev;
+	make_var(edge, tenths.data(), mockdev, teq::Shape({n}));
+
+#ifndef PERM_OP
+	auto outbytes = sizeof(Eigen::half);
+	EXPECT_CALL(*memory, allocate(outbytes)).WillOnce(Return(outdata.data()));
+	EXPECT_CALL(*memory, deallocate(outdata.data(), outbytes)).Times(1);
+#endif
+	auto r = eigen::reduce_sum<Eigen::half>(teq::Shape(), edge, mvalues);
+
+	eigen::RTMemptrT mem = memory;
+	r->assign(1, mem);
+	Eigen::half* raw = (Eigen::half*) r->data();
+	ASSERT_NE(nullptr, raw);
+	EXPECT_EQ(100.f, (float) raw[0]);
+}
+
+
+#endif // EGEN_FULLTYPE
+
+
 #endif // DISABLE_EIGEN_OPERATOR_TEST
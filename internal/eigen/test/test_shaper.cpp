@@ -280,6 +280,33 @@ TEST_F(SHAPER, Scatter)
 }
 
 
+TEST_F(SHAPER, Pool)
+{
+	EXPECT_CALL(*logger_, supports_level(An<const std::string&>())).WillRepeatedly(Return(false));
+	EXPECT_CALL(*logger_, supports_level(logs::throw_err_level)).WillRepeatedly(Return(true));
+
+	egen::ShapeParser<egen::MAX_POOL> parser;
+	marsh::Maps pooled;
+	eigen::Packer<eigen::PairVecT<teq::DimT>>().pack(pooled, {{1, 1}, {3, 2}, {2, 2}});
+
+	EXPECT_CALL(*logger_, supports_level(logs::fatal_level)).WillOnce(Return(true));
+	EXPECT_CALL(*logger_, log(logs::fatal_level, eigen::no_argument_err, _)).Times(1).WillOnce(Throw(exam::TestException(eigen::no_argument_err)));
+	EXPECT_FATAL(parser(pooled, {}), eigen::no_argument_err.c_str());
+
+	teq::Shape inshape({3, 8, 7, 2});
+	teq::Shape expect({3, 3, 3, 2});
+	teq::Shape got = parser(pooled, {inshape});
+
+	EXPECT_ARREQ(expect, got);
+
+	teq::Shape badshape({3, 2, 7, 2});
+	std::string fatalmsg = fmts::sprintf("cannot pool with window 3 larger "
+		"than dimension 1 of shape %s", badshape.to_string().c_str());
+	EXPECT_CALL(*logger_, log(logs::throw_err_level, fatalmsg, _)).Times(1).WillOnce(Throw(exam::TestException(fatalmsg)));
+	EXPECT_FATAL(parser(pooled, {badshape}), fatalmsg.c_str());
+}
+
+
 TEST_F(SHAPER, Matmul)
 {
 	EXPECT_CALL(*logger_, supports_level(An<const std::string&>())).WillRepeatedly(Return(false));
@@ -377,6 +404,100 @@ TEST_F(SHAPER, Conv)
 }
 
 
+TEST_F(SHAPER, Conv2d)
+{
+	EXPECT_CALL(*logger_, supports_level(An<const std::string&>())).WillRepeatedly(Return(false));
+	EXPECT_CALL(*logger_, supports_level(logs::throw_err_level)).WillRepeatedly(Return(true));
+
+	egen::ShapeParser<egen::CONV2D> parser;
+
+	teq::Shape imgshape({4, 10, 9, 2});
+	teq::Shape kernshape({3, 4, 5, 6});
+
+	marsh::Maps defaults;
+	teq::Shape expect({3, 6, 4, 2});
+	EXPECT_ARREQ(expect, parser(defaults, {imgshape, kernshape}));
+
+	marsh::Maps attrs;
+	eigen::Packer<teq::DimsT>().pack(attrs, {2, 3});
+	eigen::Packer<eigen::PairVecT<teq::DimT>>().pack(attrs, {{1, 1}, {2, 1}});
+	teq::Shape expect2({3, 4, 3, 2});
+	EXPECT_ARREQ(expect2, parser(attrs, {imgshape, kernshape}));
+
+	teq::Shape badkern({3, 2, 5, 6});
+	std::string fatalmsg = "cannot CONV2D image [4\\10\\9\\2\\1\\1\\1\\1] "
+		"and kernel [3\\2\\5\\6\\1\\1\\1\\1] with mismatching input channels";
+	EXPECT_CALL(*logger_, log(logs::throw_err_level, fatalmsg, _)).Times(1).WillOnce(Throw(exam::TestException(fatalmsg)));
+	EXPECT_FATAL(parser(defaults, {imgshape, badkern}), fatalmsg.c_str());
+
+	teq::Shape bigkern({3, 4, 11, 6});
+	std::string fatalmsg1 = "cannot CONV2D a kernel of shape [3\\4\\11\\6\\1\\1\\1\\1] "
+		"against smaller padded image of shape [4\\10\\9\\2\\1\\1\\1\\1]";
+	EXPECT_CALL(*logger_, log(logs::throw_err_level, fatalmsg1, _)).Times(1).WillOnce(Throw(exam::TestException(fatalmsg1)));
+	EXPECT_FATAL(parser(defaults, {imgshape, bigkern}), fatalmsg1.c_str());
+}
+
+TEST_F(SHAPER, LstmCell)
+{
+	EXPECT_CALL(*logger_, supports_level(An<const std::string&>())).WillRepeatedly(Return(false));
+	EXPECT_CALL(*logger_, supports_level(logs::throw_err_level)).WillRepeatedly(Return(true));
+
+	egen::ShapeParser<egen::LSTM_CELL> parser;
+
+	teq::Shape inshape({5, 3});
+	teq::Shape hidshape({4, 3});
+	teq::Shape weightshape({16, 9});
+	teq::Shape biasshape({16});
+
+	marsh::Maps attrs;
+	teq::Shape expect({8, 3});
+	EXPECT_ARREQ(expect, parser(attrs, {inshape, hidshape, hidshape, weightshape}));
+	EXPECT_ARREQ(expect, parser(attrs, {inshape, hidshape, hidshape, weightshape, biasshape}));
+
+	teq::Shape badweight({16, 5});
+	std::string fatalmsg = "cannot LSTM_CELL with weight [16\\5\\1\\1\\1\\1\\1\\1] "
+		"(expecting [16\\9\\1\\1\\1\\1\\1\\1])";
+	EXPECT_CALL(*logger_, log(logs::throw_err_level, fatalmsg, _)).Times(1).WillOnce(Throw(exam::TestException(fatalmsg)));
+	EXPECT_FATAL(parser(attrs, {inshape, hidshape, hidshape, badweight}), fatalmsg.c_str());
+
+	teq::Shape badin({5, 2});
+	std::string fatalmsg1 = "cannot LSTM_CELL with input [5\\2\\1\\1\\1\\1\\1\\1] "
+		"and hidden [4\\3\\1\\1\\1\\1\\1\\1] of incompatible shapes";
+	EXPECT_CALL(*logger_, log(logs::throw_err_level, fatalmsg1, _)).Times(1).WillOnce(Throw(exam::TestException(fatalmsg1)));
+	EXPECT_FATAL(parser(attrs, {badin, hidshape, hidshape, weightshape}), fatalmsg1.c_str());
+}
+
+TEST_F(SHAPER, ApplyGroups)
+{
+	EXPECT_CALL(*logger_, supports_level(An<const std::string&>())).WillRepeatedly(Return(false));
+	EXPECT_CALL(*logger_, supports_level(logs::throw_err_level)).WillRepeatedly(Return(true));
+
+	egen::ShapeParser<egen::APPLY_ADAM> parser;
+
+	teq::Shape ashape({4, 3});
+	teq::Shape bshape({5});
+	teq::Shape step;
+
+	marsh::Maps attrs;
+	EXPECT_ARREQ(ashape, parser(attrs, {ashape, ashape, ashape, ashape, step}));
+	EXPECT_ARREQ(ashape, parser(attrs, {ashape, ashape, ashape, ashape, step,
+		bshape, bshape, bshape, bshape, step}));
+
+	std::string fatalmsg = "cannot APPLY_ADAM with 4 arguments (expecting groups of 5)";
+	EXPECT_CALL(*logger_, log(logs::throw_err_level, fatalmsg, _)).Times(1).WillOnce(Throw(exam::TestException(fatalmsg)));
+	EXPECT_FATAL(parser(attrs, {ashape, ashape, ashape, ashape}), fatalmsg.c_str());
+
+	std::string fatalmsg1 = "cannot APPLY_ADAM with incompatible shapes "
+		"[5\\1\\1\\1\\1\\1\\1\\1] and [4\\3\\1\\1\\1\\1\\1\\1]";
+	EXPECT_CALL(*logger_, log(logs::throw_err_level, fatalmsg1, _)).Times(1).WillOnce(Throw(exam::TestException(fatalmsg1)));
+	EXPECT_FATAL(parser(attrs, {ashape, ashape, bshape, ashape, step}), fatalmsg1.c_str());
+
+	std::string fatalmsg2 = "cannot APPLY_ADAM with step of shape "
+		"[4\\3\\1\\1\\1\\1\\1\\1] (expecting 1 element)";
+	EXPECT_CALL(*logger_, log(logs::throw_err_level, fatalmsg2, _)).Times(1).WillOnce(Throw(exam::TestException(fatalmsg2)));
+	EXPECT_FATAL(parser(attrs, {ashape, ashape, ashape, ashape, ashape}), fatalmsg2.c_str());
+}
+
 TEST_F(SHAPER, ConcatBinary)
 {
 	EXPECT_CALL(*logger_, supports_level(An<const std::string&>())).WillRepeatedly(Return(false));
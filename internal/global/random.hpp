@@ -8,6 +8,10 @@
 #ifndef GLOBAL_RANDOM_HPP
 #define GLOBAL_RANDOM_HPP
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
 #include <random>
 #include <type_traits>
 
@@ -24,6 +28,61 @@ namespace global
 template <typename T>
 using GenF = std::function<T()>;
 
+/// Counter-based Philox4x32-10 engine
+/// The i-th value of a stream only depends on the seed, the stream id, and i,
+/// so disjoint ranges of a stream can be generated in any order or in parallel
+struct Philox final
+{
+	using BlockT = std::array<uint32_t,4>;
+
+	Philox (uint64_t seed = 0, uint64_t stream = 0) :
+		seed_(seed), stream_(stream) {}
+
+	/// Return stream deterministically derived from this stream by substream id
+	Philox split (uint64_t substream) const;
+
+	/// Return the 128 random bits of block at index
+	BlockT block (uint64_t index) const
+	{
+		BlockT ctr = {
+			(uint32_t) index, (uint32_t) (index >> 32),
+			(uint32_t) stream_, (uint32_t) (stream_ >> 32),
+		};
+		uint32_t k0 = (uint32_t) seed_;
+		uint32_t k1 = (uint32_t) (seed_ >> 32);
+		for (size_t i = 0; i < 10; ++i)
+		{
+			uint64_t p0 = (uint64_t) 0xD2511F53 * ctr[0];
+			uint64_t p1 = (uint64_t) 0xCD9E8D57 * ctr[2];
+			ctr = {
+				(uint32_t) (p1 >> 32) ^ ctr[1] ^ k0, (uint32_t) p1,
+				(uint32_t) (p0 >> 32) ^ ctr[3] ^ k1, (uint32_t) p0,
+			};
+			k0 += 0x9E3779B9;
+			k1 += 0xBB67AE85;
+		}
+		return ctr;
+	}
+
+	/// Fill out with n decimals uniformly generated in [0, 1)
+	/// starting from the offset-th value of the stream
+	void fill_unif (double* out, size_t n, uint64_t offset) const;
+
+	/// Fill out with n standard normal decimals
+	/// starting from the offset-th value of the stream
+	void fill_norm (double* out, size_t n, uint64_t offset) const;
+
+	/// Fill out with n integers each counting successes of ntrials
+	/// with probability prob, consuming n * ntrials values of the stream
+	/// starting from the offset-th value
+	void fill_binom (int64_t* out, size_t n, uint64_t offset,
+		int64_t ntrials, double prob) const;
+
+	uint64_t seed_;
+
+	uint64_t stream_;
+};
+
 struct iGenerator
 {
 	virtual ~iGenerator (void) = default;
@@ -57,6 +116,41 @@ struct iGenerator
 	/// Return generator function that normally generate decimal with mean and stdev
 	virtual GenF<double> norm_decgen (
 		const double& mean, const double& stdev) const = 0;
+
+	/// Fill out with n decimals uniformly generated between a and b
+	virtual void unif_decs (double* out, size_t n,
+		const double& lower, const double& upper) const
+	{
+		for (size_t i = 0; i < n; ++i)
+		{
+			out[i] = unif_dec(lower, upper);
+		}
+	}
+
+	/// Fill out with n decimals normally generated with mean and stdev
+	virtual void norm_decs (double* out, size_t n,
+		const double& mean, const double& stdev) const
+	{
+		for (size_t i = 0; i < n; ++i)
+		{
+			out[i] = norm_dec(mean, stdev);
+		}
+	}
+
+	/// Fill out with n binomially generated integers
+	/// of ntrials with probability prob
+	virtual void binom_ints (int64_t* out, size_t n,
+		const int64_t& ntrials, const double& prob) const
+	{
+		for (size_t i = 0; i < n; ++i)
+		{
+			out[i] = 0;
+			for (int64_t j = 0; j < ntrials; ++j)
+			{
+				out[i] += unif_dec(0, 1) < prob;
+			}
+		}
+	}
 };
 
 using GenPtrT = std::shared_ptr<iGenerator>;
@@ -67,6 +161,10 @@ struct iRandGenerator : public iGenerator
 
 	/// Seed the random engine using seed specified
 	virtual void seed (size_t s) = 0;
+
+	/// Return generator of a new stream deterministically
+	/// derived from this generator's stream
+	virtual GenPtrT split (void) const = 0;
 };
 
 void set_generator (GenPtrT gen, CfgMapptrT ctx = context());
@@ -75,8 +173,92 @@ GenPtrT get_generator (const CfgMapptrT& ctx = context());
 
 void seed (size_t s, const CfgMapptrT& ctx = context());
 
+/// Return generator split from gen if gen supports streams, otherwise gen
+/// Operators split generators on construction so every operator
+/// draws from its own reproducible stream regardless of evaluation order
+GenPtrT split_generator (GenPtrT gen);
+
+/// Fill out with n integers uniformly generated between lower[i] and upper[i]
+template <typename T, typename std::enable_if<std::is_integral<T>::value>::type* = nullptr>
+void unif_fill (const iGenerator& gen,
+	T* out, const T* lower, const T* upper, size_t n)
+{
+	std::vector<double> unifs(n);
+	gen.unif_decs(unifs.data(), n, 0, 1);
+	for (size_t i = 0; i < n; ++i)
+	{
+		T range = upper[i] - lower[i];
+		out[i] = lower[i] + std::min(range,
+			(T) (unifs[i] * ((double) range + 1)));
+	}
+}
+
+/// Fill out with n decimals uniformly generated between lower[i] and upper[i]
+template <typename T, typename std::enable_if<!std::is_integral<T>::value>::type* = nullptr>
+void unif_fill (const iGenerator& gen,
+	T* out, const T* lower, const T* upper, size_t n)
+{
+	std::vector<double> unifs(n);
+	gen.unif_decs(unifs.data(), n, 0, 1);
+	for (size_t i = 0; i < n; ++i)
+	{
+		out[i] = lower[i] + (upper[i] - lower[i]) * (T) unifs[i];
+	}
+}
+
+/// Seed shared by a Randomizer and every stream split from it
+struct RandomKey final
+{
+	std::atomic<uint64_t> seed_{0};
+
+	/// Number of times seeded, streams restart when this changes
+	std::atomic<uint64_t> epoch_{0};
+};
+
+/// Position in a stream shared by a Randomizer
+/// and the generator functions it returns
+struct RandomStream final
+{
+	RandomStream (std::shared_ptr<RandomKey> key, uint64_t id) :
+		key_(key), id_(id), epoch_(key->epoch_.load()) {}
+
+	/// Return engine of this stream under the current seed
+	Philox engine (void) const
+	{
+		return Philox(key_->seed_, id_);
+	}
+
+	/// Return offset of n values reserved from this stream
+	/// Reservations are atomic so concurrent callers draw disjoint values
+	uint64_t reserve (size_t n);
+
+	/// Return id of the next stream split from this stream
+	uint64_t reserve_split (void);
+
+	std::shared_ptr<RandomKey> key_;
+
+	uint64_t id_;
+
+private:
+	/// Restart stream if reseeded since last reservation
+	void sync (void);
+
+	std::atomic<uint64_t> epoch_;
+
+	std::atomic<uint64_t> offset_{0};
+
+	std::atomic<uint64_t> nsplits_{0};
+};
+
+using RandStreamptrT = std::shared_ptr<RandomStream>;
+
 struct Randomizer final : public iRandGenerator
 {
+	Randomizer (void) : stream_(std::make_shared<RandomStream>(
+		std::make_shared<RandomKey>(), 0)) {}
+
+	Randomizer (RandStreamptrT stream) : stream_(stream) {}
+
 	/// Implementation of iGenerator
 	std::string get_str (void) const override
 	{
@@ -86,22 +268,25 @@ struct Randomizer final : public iRandGenerator
 	/// Implementation of iGenerator
 	int64_t unif_int (const int64_t& lower, const int64_t& upper) const override
 	{
-		std::uniform_int_distribution<int64_t> dist(lower, upper);
-		return dist(rengine_);
+		int64_t out;
+		unif_fill<int64_t>(*this, &out, &lower, &upper, 1);
+		return out;
 	}
 
 	/// Implementation of iGenerator
 	double unif_dec (const double& lower, const double& upper) const override
 	{
-		std::uniform_real_distribution<double> dist(lower, upper);
-		return dist(rengine_);
+		double out;
+		unif_decs(&out, 1, lower, upper);
+		return out;
 	}
 
 	/// Implementation of iGenerator
 	double norm_dec (const double& mean, const double& stdev) const override
 	{
-		std::normal_distribution<double> dist(mean, stdev);
-		return dist(rengine_);
+		double out;
+		norm_decs(&out, 1, mean, stdev);
+		return out;
 	}
 
 	/// Implementation of iGenerator
@@ -114,33 +299,56 @@ struct Randomizer final : public iRandGenerator
 	GenF<int64_t> unif_intgen (
 		const int64_t& lower, const int64_t& upper) const override
 	{
-		std::uniform_int_distribution<int64_t> dist(lower, upper);
-		return std::bind(dist, rengine_);
+		auto gen = std::make_shared<Randomizer>(stream_);
+		return [gen, lower, upper]{ return gen->unif_int(lower, upper); };
 	}
 
 	/// Implementation of iGenerator
 	GenF<double> unif_decgen (
 		const double& lower, const double& upper) const override
 	{
-		std::uniform_real_distribution<double> dist(lower, upper);
-		return std::bind(dist, rengine_);
+		auto gen = std::make_shared<Randomizer>(stream_);
+		return [gen, lower, upper]{ return gen->unif_dec(lower, upper); };
 	}
 
 	/// Implementation of iGenerator
 	GenF<double> norm_decgen (
 		const double& mean, const double& stdev) const override
 	{
-		std::normal_distribution<double> dist(mean, stdev);
-		return std::bind(dist, rengine_);
+		auto gen = std::make_shared<Randomizer>(stream_);
+		return [gen, mean, stdev]{ return gen->norm_dec(mean, stdev); };
 	}
 
+	/// Implementation of iGenerator
+	void unif_decs (double* out, size_t n,
+		const double& lower, const double& upper) const override;
+
+	/// Implementation of iGenerator
+	void norm_decs (double* out, size_t n,
+		const double& mean, const double& stdev) const override;
+
+	/// Implementation of iGenerator
+	void binom_ints (int64_t* out, size_t n,
+		const int64_t& ntrials, const double& prob) const override;
+
 	/// Implementation of iRandGenerator
 	void seed (size_t s) override
 	{
-		rengine_.seed(s);
+		stream_->key_->seed_ = s;
+		++stream_->key_->epoch_;
+	}
+
+	/// Implementation of iRandGenerator
+	GenPtrT split (void) const override;
+
+	/// Return engine of this generator's stream under the current seed
+	Philox engine (void) const
+	{
+		return stream_->engine();
 	}
 
-	mutable std::default_random_engine rengine_;
+private:
+	RandStreamptrT stream_;
 
 	mutable boost::uuids::random_generator uengine_;
 };
@@ -5,6 +5,146 @@
 namespace global
 {
 
+/// Key of the engine deriving split stream ids, independent of the seed
+/// so streams keep their ids when reseeded
+static const uint64_t split_key = 0x5851F42D4C957F2D;
+
+/// Return decimal in [0, 1) using 53 bits of hi and lo
+static inline double to_unit (uint32_t hi, uint32_t lo)
+{
+	return ((hi >> 5) * 67108864. + (lo >> 6)) * (1. / 9007199254740992.);
+}
+
+/// Fill out with n values starting from offset of a stream
+/// where every block yields a pair of values
+template <typename F>
+static void fill_pairs (const Philox& engine,
+	double* out, size_t n, uint64_t offset, F pair)
+{
+	size_t i = 0;
+	if (n > 0 && offset % 2)
+	{
+		out[i++] = pair(engine.block(offset / 2)).second;
+	}
+	uint64_t first = (offset + i) / 2;
+	size_t nblocks = (n - i) / 2;
+	double* dst = out + i;
+	for (size_t j = 0; j < nblocks; ++j)
+	{
+		auto values = pair(engine.block(first + j));
+		dst[2 * j] = values.first;
+		dst[2 * j + 1] = values.second;
+	}
+	i += 2 * nblocks;
+	if (i < n)
+	{
+		out[i] = pair(engine.block((offset + i) / 2)).first;
+	}
+}
+
+Philox Philox::split (uint64_t substream) const
+{
+	auto b = Philox(split_key, stream_).block(substream);
+	return Philox(seed_, ((uint64_t) b[1] << 32) | b[0]);
+}
+
+void Philox::fill_unif (double* out, size_t n, uint64_t offset) const
+{
+	fill_pairs(*this, out, n, offset,
+	[](const BlockT& b)
+	{
+		return std::pair<double,double>{
+			to_unit(b[0], b[1]), to_unit(b[2], b[3])};
+	});
+}
+
+void Philox::fill_norm (double* out, size_t n, uint64_t offset) const
+{
+	// box-muller transform of each block's pair of uniform decimals
+	fill_pairs(*this, out, n, offset,
+	[](const BlockT& b)
+	{
+		double radius = std::sqrt(-2 * std::log(1 - to_unit(b[0], b[1])));
+		double theta = 2 * 3.14159265358979323846 * to_unit(b[2], b[3]);
+		return std::pair<double,double>{
+			radius * std::cos(theta), radius * std::sin(theta)};
+	});
+}
+
+void Philox::fill_binom (int64_t* out, size_t n, uint64_t offset,
+	int64_t ntrials, double prob) const
+{
+	if (ntrials < 1)
+	{
+		std::fill(out, out + n, 0);
+		return;
+	}
+	std::vector<double> trials(ntrials);
+	for (size_t i = 0; i < n; ++i)
+	{
+		fill_unif(trials.data(), ntrials, offset + i * ntrials);
+		out[i] = std::count_if(trials.begin(), trials.end(),
+			[prob](double trial) { return trial < prob; });
+	}
+}
+
+void Randomizer::unif_decs (double* out, size_t n,
+	const double& lower, const double& upper) const
+{
+	engine().fill_unif(out, n, stream_->reserve(n));
+	double range = upper - lower;
+	for (size_t i = 0; i < n; ++i)
+	{
+		out[i] = lower + range * out[i];
+	}
+}
+
+void Randomizer::norm_decs (double* out, size_t n,
+	const double& mean, const double& stdev) const
+{
+	engine().fill_norm(out, n, stream_->reserve(n));
+	for (size_t i = 0; i < n; ++i)
+	{
+		out[i] = mean + stdev * out[i];
+	}
+}
+
+void Randomizer::binom_ints (int64_t* out, size_t n,
+	const int64_t& ntrials, const double& prob) const
+{
+	engine().fill_binom(out, n,
+		stream_->reserve(n * std::max<int64_t>(ntrials, 0)), ntrials, prob);
+}
+
+GenPtrT Randomizer::split (void) const
+{
+	auto id = engine().split(stream_->reserve_split()).stream_;
+	return std::make_shared<Randomizer>(
+		std::make_shared<RandomStream>(stream_->key_, id));
+}
+
+uint64_t RandomStream::reserve (size_t n)
+{
+	sync();
+	return offset_.fetch_add(n);
+}
+
+uint64_t RandomStream::reserve_split (void)
+{
+	sync();
+	return nsplits_++;
+}
+
+void RandomStream::sync (void)
+{
+	uint64_t epoch = key_->epoch_;
+	if (epoch_.exchange(epoch) != epoch)
+	{
+		offset_ = 0;
+		nsplits_ = 0;
+	}
+}
+
 const std::string generator_key = "generator";
 
 void set_generator (GenPtrT gen, CfgMapptrT ctx)
@@ -37,6 +177,15 @@ void seed (size_t s, const CfgMapptrT& ctx)
 	}
 }
 
+GenPtrT split_generator (GenPtrT gen)
+{
+	if (auto rgen = dynamic_cast<iRandGenerator*>(gen.get()))
+	{
+		return rgen->split();
+	}
+	return gen;
+}
+
 }
 
 #endif
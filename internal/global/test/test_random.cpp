@@ -120,4 +120,119 @@ TEST(RANDOM, RandomizerNorm)
 }
 
 
+TEST(RANDOM, PhiloxKnownAnswer)
+{
+	auto zero = global::Philox(0, 0).block(0);
+	EXPECT_EQ(0x6627e8d5, zero[0]);
+	EXPECT_EQ(0xe169c58d, zero[1]);
+	EXPECT_EQ(0xbc57ac4c, zero[2]);
+	EXPECT_EQ(0x9b00dbd8, zero[3]);
+
+	uint64_t ones = std::numeric_limits<uint64_t>::max();
+	auto full = global::Philox(ones, ones).block(ones);
+	EXPECT_EQ(0x408f276d, full[0]);
+	EXPECT_EQ(0x41c83b0e, full[1]);
+	EXPECT_EQ(0xa20bc7c6, full[2]);
+	EXPECT_EQ(0x6d5451fd, full[3]);
+}
+
+
+TEST(RANDOM, PhiloxOffsets)
+{
+	global::Philox engine(7, 3);
+
+	// filling in arbitrary chunks yields the same values as filling at once
+	std::vector<double> whole(11);
+	std::vector<double> chunked(11);
+	engine.fill_unif(whole.data(), 11, 5);
+	engine.fill_unif(chunked.data(), 3, 5);
+	engine.fill_unif(chunked.data() + 3, 1, 8);
+	engine.fill_unif(chunked.data() + 4, 7, 9);
+	EXPECT_EQ(whole, chunked);
+	for (double unif : whole)
+	{
+		EXPECT_LE(0, unif);
+		EXPECT_GT(1, unif);
+	}
+
+	engine.fill_norm(whole.data(), 11, 5);
+	engine.fill_norm(chunked.data(), 4, 5);
+	engine.fill_norm(chunked.data() + 4, 7, 9);
+	EXPECT_EQ(whole, chunked);
+
+	std::vector<double> other(11);
+	engine.split(0).fill_unif(other.data(), 11, 5);
+	engine.fill_unif(whole.data(), 11, 5);
+	EXPECT_NE(whole, other);
+}
+
+
+TEST(RANDOM, RandomizerGenerators)
+{
+	global::Randomizer rand;
+	rand.seed(1);
+
+	// generator functions draw from the same stream instead of replaying it
+	auto agen = rand.unif_decgen(0, 1);
+	auto bgen = rand.unif_decgen(0, 1);
+	std::vector<double> avals(8);
+	std::vector<double> bvals(8);
+	std::generate(avals.begin(), avals.end(), agen);
+	std::generate(bvals.begin(), bvals.end(), bgen);
+	EXPECT_NE(avals, bvals);
+
+	rand.seed(1);
+	std::vector<double> bulk(16);
+	rand.unif_decs(bulk.data(), 16, 0, 1);
+	EXPECT_EQ(avals, std::vector<double>(bulk.begin(), bulk.begin() + 8));
+	EXPECT_EQ(bvals, std::vector<double>(bulk.begin() + 8, bulk.end()));
+}
+
+
+TEST(RANDOM, RandomizerSplit)
+{
+	global::Randomizer rand;
+	rand.seed(2);
+
+	auto first = rand.split();
+	auto second = rand.split();
+	std::vector<double> avals(10);
+	std::vector<double> bvals(10);
+	second->unif_decs(bvals.data(), 10, 0, 1);
+	first->unif_decs(avals.data(), 10, 0, 1);
+	EXPECT_NE(avals, bvals);
+
+	// splits are reproducible regardless of the order streams are drawn
+	rand.seed(2);
+	auto refirst = rand.split();
+	std::vector<double> revals(10);
+	refirst->unif_decs(revals.data(), 10, 0, 1);
+	EXPECT_EQ(avals, revals);
+
+	// reseeding restarts streams that were already split
+	rand.seed(2);
+	first->unif_decs(revals.data(), 10, 0, 1);
+	EXPECT_EQ(avals, revals);
+}
+
+
+TEST(RANDOM, RandomizerBinom)
+{
+	global::Randomizer rand;
+	rand.seed(0);
+
+	size_t n = 10000;
+	std::vector<int64_t> counts(n);
+	rand.binom_ints(counts.data(), n, 10, 0.3);
+	double total = 0;
+	for (int64_t count : counts)
+	{
+		EXPECT_LE(0, count);
+		EXPECT_GE(10, count);
+		total += count;
+	}
+	EXPECT_NEAR(3, total / n, 0.1);
+}
+
+
 #endif // DISABLE_GLOBAL_RANDOM_TEST
@@ -7,12 +7,32 @@
 namespace opt
 {
 
+/// Number of matches found and conversions applied by a rule
+struct RuleStats final
+{
+	size_t matches_ = 0;
+
+	size_t fires_ = 0;
+};
+
+/// Rule statistics indexed by rule position
+using RuleStatsT = std::vector<RuleStats>;
+
 // Returns true if at least one rule is applied.
 // performs a single run of conversion rules,
 // but does not guarantee complete optimization
 // (further optimization may be needed)
 bool optimize (GraphInfo& graph, const OptRulesT& rules);
 
+/// Apply rules in rounds until no rule applies or round_limit rounds pass
+/// Only the first round matches against the whole graph, later rounds
+/// rematch only converted subgraphs and ancestors close enough
+/// to be covered by the deepest rule's pattern
+/// Accumulate per-rule match and conversion counts in stats
+/// Return number of rounds performed
+size_t optimize (GraphInfo& graph, const OptRulesT& rules,
+	RuleStatsT& stats, size_t round_limit);
+
 }
 
 #endif // OPT_APPLY_HPP
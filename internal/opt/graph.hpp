@@ -66,6 +66,9 @@ struct GraphInfo final
 				}
 			}
 			parents_.erase(src);
+			// track parents of tensors introduced by target
+			teq::TensSetT introduced;
+			track_parents(introduced, target.get());
 			// update owners and track changes regarding target
 			owners_.emplace(target.get(), target);
 			sindex_.erase(src);
@@ -91,6 +94,33 @@ struct GraphInfo final
 		}
 	}
 
+	/// Return tens and its ancestors at most depth parent edges above tens
+	teq::TensSetT get_ancestors (teq::iTensor* tens, size_t depth) const
+	{
+		teq::TensSetT out = {tens};
+		teq::TensSetT frontier = {tens};
+		for (size_t i = 0; i < depth && false == frontier.empty(); ++i)
+		{
+			teq::TensSetT next;
+			for (teq::iTensor* child : frontier)
+			{
+				teq::ParentMapT pmap;
+				if (estd::get(pmap, parents_, child))
+				{
+					for (auto& ppair : pmap)
+					{
+						if (out.emplace(ppair.first).second)
+						{
+							next.emplace(ppair.first);
+						}
+					}
+				}
+			}
+			frontier = std::move(next);
+		}
+		return out;
+	}
+
 	teq::TensptrsT get_roots (void) const
 	{
 		return roots_;
@@ -114,6 +144,39 @@ struct GraphInfo final
 	teq::OwnMapT owners_; // todo: cleanup everything properly instead of keeping dangling leaves
 
 	teq::TensMapT<teq::ParentMapT> parents_;
+
+private:
+	void track_parents (teq::TensSetT& introduced, teq::iTensor* tens)
+	{
+		if (estd::has(sindex_.visited_, tens) ||
+			false == introduced.emplace(tens).second)
+		{
+			return;
+		}
+		parents_.emplace(tens, teq::ParentMapT());
+		auto f = dynamic_cast<teq::iFunctor*>(tens);
+		if (nullptr == f)
+		{
+			return;
+		}
+		auto args = f->get_args();
+		for (size_t i = 0, n = args.size(); i < n; ++i)
+		{
+			parents_[args[i].get()][f].args_.push_back(i);
+			track_parents(introduced, args[i].get());
+		}
+		auto attrs = f->ls_attrs();
+		for (auto attr : attrs)
+		{
+			teq::FindTensAttr finder;
+			f->get_attr(attr)->accept(finder);
+			for (auto tensor : finder.tens_)
+			{
+				parents_[tensor.get()][f].attrs_.push_back(attr);
+				track_parents(introduced, tensor.get());
+			}
+		}
+	}
 };
 
 }
@@ -5,30 +5,140 @@
 namespace opt
 {
 
+/// Return number of tensors along the longest path of pattern node
+static size_t pattern_depth (const query::Node& node)
+{
+	if (query::Node::ValCase::kOp != node.val_case())
+	{
+		return 1;
+	}
+	const query::Operator& op = node.op();
+	size_t depth = 0;
+	for (const query::Node& arg : op.args())
+	{
+		depth = std::max(depth, pattern_depth(arg));
+	}
+	for (const auto& attr : op.attrs())
+	{
+		const query::Attribute& pba = attr.second;
+		if (query::Attribute::kNode == pba.attr_case())
+		{
+			depth = std::max(depth, pattern_depth(pba.node()));
+		}
+		else if (query::Attribute::kLayer == pba.attr_case() &&
+			pba.layer().has_input())
+		{
+			depth = std::max(depth, pattern_depth(pba.layer().input()));
+		}
+	}
+	return depth + 1;
+}
+
+/// Add tens and its subgraph not already indexed to out
+static void collect_unindexed (teq::TensSetT& out,
+	teq::iTensor* tens, const teq::TensSetT& indexed)
+{
+	if (estd::has(indexed, tens) || false == out.emplace(tens).second)
+	{
+		return;
+	}
+	if (auto f = dynamic_cast<teq::iFunctor*>(tens))
+	{
+		auto deps = f->get_args();
+		teq::FindTensAttr finder;
+		marsh::Maps attrs;
+		marsh::get_attrs(attrs, *f);
+		attrs.accept(finder);
+		deps.insert(deps.end(), finder.tens_.begin(), finder.tens_.end());
+		for (auto& dep : deps)
+		{
+			collect_unindexed(out, dep.get(), indexed);
+		}
+	}
+}
+
 bool optimize (GraphInfo& graph, const OptRulesT& rules)
 {
-	bool converted = false;
-	for (const OptRule& rule : rules)
+	RuleStatsT stats;
+	optimize(graph, rules, stats, 1);
+	return std::any_of(stats.begin(), stats.end(),
+		[](const RuleStats& stat)
+		{
+			return stat.fires_ > 0;
+		});
+}
+
+size_t optimize (GraphInfo& graph, const OptRulesT& rules,
+	RuleStatsT& stats, size_t round_limit)
+{
+	size_t nrules = rules.size();
+	stats.resize(nrules);
+	size_t reach = 1;
+	// patterns are compiled once and reused every round
+	std::vector<query::Matcher> matchers(nrules);
+	for (size_t i = 0; i < nrules; ++i)
 	{
-		query::QResultsT results;
-		for (auto& match_src : rule.match_srcs_)
+		for (auto& match_src : rules[i].match_srcs_)
 		{
-			auto res = graph.sindex_.match(match_src);
-			results.insert(results.end(), res.begin(), res.end());
+			reach = std::max(reach, pattern_depth(match_src));
+			matchers[i].add(match_src);
 		}
-		if (results.size() > 0)
+	}
+
+	bool full_match = true;
+	teq::TensSetT dirty;
+	size_t round = 0;
+	for (; round < round_limit && (full_match || false == dirty.empty());
+		++round)
+	{
+		teq::TensSetT next_dirty;
+		for (size_t i = 0; i < nrules; ++i)
 		{
-			converted = true;
+			const OptRule& rule = rules[i];
+			const query::Matcher& matcher = matchers[i];
+			query::QResultsT results;
+			for (size_t j = 0, n = matcher.size(); j < n; ++j)
+			{
+				auto res = full_match ?
+					matcher.match(graph.sindex_, j) :
+					matcher.match(graph.sindex_, dirty, j);
+				results.insert(results.end(), res.begin(), res.end());
+			}
+			if (results.empty())
+			{
+				continue;
+			}
 			teq::OwnMapT converts;
 			for (query::QueryResult& result : results)
 			{
 				converts.emplace(result.root_,
 					rule.target_->convert(result.symbs_));
 			}
+			stats[i].matches_ += results.size();
+			stats[i].fires_ += converts.size();
+
+			teq::TensSetT changed;
+			for (auto& convert : converts)
+			{
+				collect_unindexed(changed,
+					convert.second.get(), graph.sindex_.visited_);
+			}
 			graph.replace(converts);
+			// only ancestors within reach of the deepest pattern can newly match
+			for (auto& convert : converts)
+			{
+				auto ancestors = graph.get_ancestors(
+					convert.second.get(), reach - 1);
+				changed.insert(ancestors.begin(), ancestors.end());
+			}
+			// later rules of this round also see the changes
+			dirty.insert(changed.begin(), changed.end());
+			next_dirty.insert(changed.begin(), changed.end());
 		}
+		full_match = false;
+		dirty = std::move(next_dirty);
 	}
-	return converted;
+	return round;
 }
 
 }
@@ -148,5 +148,85 @@ TEST(APPLY, Optimize)
 	ASSERT_EQ(1, roots.size());
 }
 
+TEST(APPLY, OptimizeWorklist)
+{
+	teq::Shape shape({2,3});
+	std::vector<double> data{2, 8, 4, 5, 2, 1};
+	MockDeviceRef mockdev;
+	auto x = make_var<double>(data.data(), mockdev, shape);
+
+	auto sin = make_fnc("SIN", 0, teq::TensptrsT{x});
+	auto neg = make_fnc("NEG", 1, teq::TensptrsT{sin});
+	auto root = make_fnc("EXP", 2, teq::TensptrsT{neg});
+	auto negx = make_fnc("NEG", 1, teq::TensptrsT{x});
+
+	// replacing sin with negx only lets the double negation rule apply next round
+	EXPECT_CALL(*neg, update_child(teq::TensptrT(negx), 0)).Times(1).
+		WillOnce(Invoke(
+		[&](teq::TensptrT, size_t)
+		{
+			EXPECT_CALL(*neg, get_args()).
+				WillRepeatedly(Return(teq::TensptrsT{negx}));
+		}));
+	EXPECT_CALL(*root, update_child(teq::TensptrT(x), 0)).Times(1);
+
+	opt::GraphInfo graph(teq::TensptrsT{root});
+
+	std::string dneg_pattern = "{"
+		"\"op\":{"
+			"\"opname\":\"NEG\","
+			"\"args\":[{"
+				"\"op\":{"
+					"\"opname\":\"NEG\","
+					"\"args\":[{"
+						"\"symb\":\"X\""
+					"}]"
+				"}"
+			"}]"
+		"}"
+	"}";
+	std::string sin_pattern = "{"
+		"\"op\":{"
+			"\"opname\":\"SIN\","
+			"\"args\":[{"
+				"\"symb\":\"X\""
+			"}]"
+		"}"
+	"}";
+
+	opt::OptRulesT rules = {opt::OptRule(), opt::OptRule()};
+	std::stringstream pattern(dneg_pattern);
+	query::json_parse(*rules[0].match_srcs_.Add(), pattern);
+	std::stringstream pattern2(sin_pattern);
+	query::json_parse(*rules[1].match_srcs_.Add(), pattern2);
+	auto dneg_targ = std::make_shared<MockTarget>();
+	auto sin_targ = std::make_shared<MockTarget>();
+	rules[0].target_ = dneg_targ;
+	rules[1].target_ = sin_targ;
+
+	EXPECT_CALL(*sin_targ, convert(_)).Times(1).WillOnce(Return(negx));
+	query::SymbMapT cand;
+	EXPECT_CALL(*dneg_targ, convert(_)).Times(1).WillOnce(Invoke(
+		[&](const query::SymbMapT& candidates) -> teq::TensptrT
+		{
+			cand = candidates;
+			return x;
+		}));
+
+	opt::RuleStatsT stats;
+	size_t nrounds = opt::optimize(graph, rules, stats, 50);
+	// last round finds nothing to convert
+	EXPECT_EQ(3, nrounds);
+
+	ASSERT_HAS(cand, "X");
+	EXPECT_EQ(x.get(), cand.at("X"));
+
+	ASSERT_EQ(2, stats.size());
+	EXPECT_EQ(1, stats[0].matches_);
+	EXPECT_EQ(1, stats[0].fires_);
+	EXPECT_EQ(1, stats[1].matches_);
+	EXPECT_EQ(1, stats[1].fires_);
+}
+
 
 #endif // DISABLE_OPT_APPLY_TEST
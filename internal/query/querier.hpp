@@ -92,74 +92,155 @@ bool equals (
 	QResultsT& candidates, const marsh::iObject* attr,
 	const Attribute& pba, const Query& matcher);
 
+/// Pattern node compiled from query::Node where symbol and capture names
+/// are interned as slots of a bindings vector
+struct CompiledNode final
+{
+	Node::ValCase type_;
+
+	/// Slot of symbol or operator capture, no_slot if not applicable
+	size_t slot_;
+
+	double cst_ = 0;
+
+	const Leaf* leaf_ = nullptr;
+
+	std::string opname_;
+
+	bool commutative_ = false;
+
+	/// Attributes compared by value
+	std::vector<std::pair<std::string,const Attribute*>> val_attrs_;
+
+	/// Attributes whose tensors are matched against compiled nodes
+	/// where layer attributes without input condition map to no_slot
+	std::vector<std::pair<std::string,size_t>> tens_attrs_;
+
+	/// Layer name conditions of tensor attributes (nullptr if not layers)
+	std::vector<const Layer*> layers_;
+
+	std::vector<size_t> args_;
+
+	/// True if subpattern binds no slot, so matches only depend on tensor
+	bool ground_ = true;
+};
+
+/// Matcher of patterns compiled once into a table of hash-consed nodes
+/// shared by every pattern, which is walked over the graph with one
+/// bindings vector that is restored on backtrack instead of copying
+/// partial matches. Subpatterns without symbols are evaluated at most
+/// once per tensor for each call to match
+struct Matcher final
+{
+	static const size_t no_slot = std::numeric_limits<size_t>::max();
+
+	Matcher (void) = default;
+
+	Matcher (const Node& pattern)
+	{
+		add(pattern);
+	}
+
+	Matcher (const Matcher& other) = delete;
+
+	Matcher (Matcher&& other) = default;
+
+	Matcher& operator = (const Matcher& other) = delete;
+
+	Matcher& operator = (Matcher&& other) = default;
+
+	/// Compile pattern and return its pattern index
+	size_t add (const Node& pattern);
+
+	/// Return number of patterns
+	size_t size (void) const
+	{
+		return roots_.size();
+	}
+
+	/// Return matches of pattern at index rooted at tensors indexed by query
+	QResultsT match (const Query& index, size_t pattern = 0) const;
+
+	/// Return matches of pattern at index rooted only at candidates indexed by query
+	QResultsT match (const Query& index,
+		const teq::TensSetT& candidates, size_t pattern = 0) const;
+
+	/// Return matches of every pattern ordered by pattern index where
+	/// patterns with the same root operator share the search for roots
+	std::vector<QResultsT> match_all (const Query& index) const;
+
+private:
+	struct Goal
+	{
+		size_t node_;
+
+		teq::iTensor* tens_;
+
+		const Goal* next_;
+	};
+
+	struct State;
+
+	size_t compile (const Node& node);
+
+	size_t intern (const std::string& symbol);
+
+	void match_root (State& state, size_t pattern, teq::iTensor* root) const;
+
+	bool solve (State& state, const Goal* goal) const;
+
+	bool solve_node (State& state, const Goal& goal) const;
+
+	bool bind (State& state, size_t slot,
+		teq::iTensor* tens, const Goal* next) const;
+
+	bool chain_attrs (State& state, const CompiledNode& node,
+		teq::iFunctor& func, const teq::TensptrsT& args,
+		size_t i, const Goal* next) const;
+
+	bool chain_args (State& state, const CompiledNode& node,
+		const teq::TensptrsT& args, size_t i, const Goal* next) const;
+
+	bool assign_args (State& state, const CompiledNode& node,
+		const teq::TensptrsT& args, std::vector<bool>& used,
+		size_t i, const Goal* next) const;
+
+	bool surface_matches (const CompiledNode& node, teq::iTensor* tens) const;
+
+	bool op_matches (const CompiledNode& node,
+		const teq::iFunctor& func, size_t nargs) const;
+
+	/// Owned copies of compiled patterns referenced by nodes
+	std::vector<std::unique_ptr<Node>> patterns_;
+
+	std::vector<CompiledNode> nodes_;
+
+	/// Compiled node index by structural key for hash-consing
+	types::StrUMapT<size_t> node_keys_;
+
+	/// Root node of each pattern
+	std::vector<size_t> roots_;
+
+	/// Slots bound by each pattern
+	std::vector<std::vector<size_t>> pattern_slots_;
+
+	/// Symbol name of each slot
+	types::StringsT slot_names_;
+
+	types::StrUMapT<size_t> slots_;
+};
+
 struct Query final : public teq::iOnceTraveler
 {
 	QResultsT match (const Node& cond) const
 	{
-		PathsT paths;
-		switch (cond.val_case())
-		{
-			case Node::ValCase::kSymb:
-				paths.reserve(visited_.size());
-				std::transform(visited_.begin(), visited_.end(),
-					std::back_inserter(paths),
-					[](teq::iTensor* node)
-					{
-						return std::make_shared<Path>(node);
-					});
-				symb_filter(paths, cond.symb());
-				break;
-			case Node::ValCase::kCst:
-				paths.reserve(visited_.size());
-				std::transform(visited_.begin(), visited_.end(),
-					std::back_inserter(paths),
-					[](teq::iTensor* node)
-					{
-						return std::make_shared<Path>(node);
-					});
-				leaf_filter(paths, cond.cst());
-				break;
-			case Node::ValCase::kLeaf:
-				paths.reserve(visited_.size());
-				std::transform(visited_.begin(), visited_.end(),
-					std::back_inserter(paths),
-					[](teq::iTensor* node)
-					{
-						return std::make_shared<Path>(node);
-					});
-				leaf_filter(paths, cond.leaf());
-				break;
-			case Node::ValCase::kOp:
-			{
-				TensListT nodes;
-				if (estd::get(nodes, sindex_, cond.op().opname()))
-				{
-					paths.reserve(nodes.size());
-					std::transform(nodes.begin(), nodes.end(),
-						std::back_inserter(paths),
-						[](teq::iTensor* node)
-						{
-							return std::make_shared<Path>(node);
-						});
-					match_helper(paths, cond);
-				}
-			}
-				break;
-			default:
-				global::fatal("cannot look for unknown node");
-		}
-		QResultsT results;
-		QReSetT existing_res;
-		for (PathptrT path : paths)
-		{
-			QueryResult result{path->tens_, path->symbols_};
-			if (false == estd::has(existing_res, result))
-			{
-				results.push_back(result);
-				existing_res.emplace(result);
-			}
-		}
-		return results;
+		return Matcher(cond).match(*this);
+	}
+
+	/// Return matches of cond rooted only at indexed tensors in candidates
+	QResultsT match (const Node& cond, const teq::TensSetT& candidates) const
+	{
+		return Matcher(cond).match(*this, candidates);
 	}
 
 	void erase (teq::iTensor* tens)
@@ -195,189 +276,6 @@ private:
 		deps.insert(deps.end(), finder.tens_.begin(), finder.tens_.end());
 		teq::multi_visit(*this, deps);
 	}
-
-	bool surface_matches (QResultsT& tens, const teq::iFunctor* func,
-		const Operator& cond, const QAttrMapT& pb_attrs) const
-	{
-		if (nullptr == func)
-		{
-			return false;
-		}
-		std::string cop = cond.opname();
-		size_t ncargs = cond.args().size();
-		return func->get_opcode().name_ == cop &&
-			ncargs <= func->get_args().size() &&
-			std::all_of(pb_attrs.begin(), pb_attrs.end(),
-				[&](const auto& pb_attr)
-				{
-					return equals(tens, func->get_attr(pb_attr.first),
-						pb_attr.second, *this);
-				});
-	}
-
-	void noncomm_filter (PathsT& paths, const Operator& cond) const
-	{
-		for (const Node& carg : cond.args())
-		{
-			PathsT children;
-			children.reserve(paths.size());
-			std::transform(paths.begin(), paths.end(),
-				std::back_inserter(children),
-				[](PathptrT& path)
-				{
-					auto args = path->get_args();
-					assert(args.size() > 0);
-					auto arg = args.front();
-					return std::make_shared<Path>(arg.second,
-						PrevT{arg.first, path}, path->symbols_);
-				});
-			match_helper(children, carg);
-			paths.clear();
-			std::transform(children.begin(), children.end(),
-				std::back_inserter(paths),
-				[](PathptrT match)
-				{
-					return match->recall();
-				});
-		}
-	}
-
-	void commutative_filter (PathsT& paths, const Operator& cond) const
-	{
-		const auto& cargs = cond.args();
-		size_t nargs = cargs.size();
-		for (const Node& carg : cargs)
-		{
-			PathsT children;
-			children.reserve(paths.size() * nargs);
-			for (auto& root : paths)
-			{
-				auto args = root->get_args();
-				for (std::pair<size_t,teq::iTensor*>& arg : args)
-				{
-					children.push_back(std::make_shared<Path>(
-						arg.second, PrevT{arg.first, root}, root->symbols_));
-				}
-			}
-			match_helper(children, carg);
-			paths.clear();
-			std::transform(children.begin(), children.end(),
-				std::back_inserter(paths),
-				[](PathptrT match)
-				{
-					return match->recall();
-				});
-		}
-		estd::remove_if(paths,
-			[&](PathptrT root)
-			{
-				return root->memory_.size() != nargs;
-			});
-	}
-
-	void symb_filter (PathsT& paths, std::string cond) const
-	{
-		estd::remove_if(paths,
-			[&](PathptrT root)
-			{
-				return estd::has(root->symbols_, cond) &&
-					root->symbols_[cond] != root->tens_;
-			});
-		for (PathptrT root : paths)
-		{
-			root->symbols_.emplace(cond, root->tens_);
-		}
-	}
-
-	void attr_filter (PathsT& paths, const Operator& cond) const
-	{
-		const QAttrMapT& attrs = cond.attrs();
-		PathsT mpaths;
-		for (const PathptrT& root : paths)
-		{
-			QResultsT attr_matches;
-			if (surface_matches(attr_matches,
-				dynamic_cast<const teq::iFunctor*>(root->tens_), cond, attrs))
-			{
-				for (auto& attr_match : attr_matches)
-				{
-					teq::iTensor* tens;
-					if (std::all_of(attr_match.symbs_.begin(),
-						attr_match.symbs_.end(),
-						[&](const std::pair<std::string,teq::iTensor*>& sp)
-						{
-							return false == estd::get(
-								tens, root->symbols_, sp.first) ||
-								tens == sp.second;
-						}))
-					{
-						PathptrT rclone = std::make_shared<Path>(*root);
-						rclone->symbols_.insert(
-							attr_match.symbs_.begin(), attr_match.symbs_.end());
-						mpaths.push_back(rclone);
-					}
-				}
-				if (attr_matches.empty())
-				{
-					mpaths.push_back(root);
-				}
-			}
-		}
-		paths = PathsT(mpaths.begin(), mpaths.end());
-	}
-
-	template <typename T>
-	void leaf_filter (PathsT& paths, T leaf) const
-	{
-		estd::remove_if(paths,
-			[&](PathptrT root)
-			{
-				return false == equals(
-					dynamic_cast<teq::iLeaf*>(root->tens_), leaf);
-			});
-	}
-
-	void func_filter (PathsT& paths, const Operator& cond) const
-	{
-		attr_filter(paths, cond);
-		if (egen::is_commutative(cond.opname()))
-		{
-			commutative_filter(paths, cond);
-		}
-		else
-		{
-			noncomm_filter(paths, cond);
-		}
-		if (Operator::kCapture == cond.nullable_capture_case())
-		{
-			symb_filter(paths, cond.capture());
-		}
-	}
-
-	void match_helper (PathsT& paths, const Node& cond) const
-	{
-		if (paths.empty())
-		{
-			return;
-		}
-		switch (cond.val_case())
-		{
-			case Node::ValCase::kSymb:
-				symb_filter(paths, cond.symb());
-				break;
-			case Node::ValCase::kCst:
-				leaf_filter(paths, cond.cst());
-				break;
-			case Node::ValCase::kLeaf:
-				leaf_filter(paths, cond.leaf());
-				break;
-			case Node::ValCase::kOp:
-				func_filter(paths, cond.op());
-				break;
-			default:
-				global::fatal("cannot look for unknown node");
-		}
-	}
 };
 
 }
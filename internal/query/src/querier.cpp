@@ -1,4 +1,7 @@
 
+#include <map>
+#include <sstream>
+
 #include "internal/query/querier.hpp"
 
 #ifdef QUERY_QUERIER_HPP
@@ -11,9 +14,7 @@ inline bool doub_eq (const double& a, const double& b)
 	return std::fabs(a - b) < std::numeric_limits<float>::epsilon();
 }
 
-bool equals (
-	QResultsT& candidates, const marsh::iObject* attr,
-	const Attribute& pba, const Query& matcher)
+static bool value_equals (const marsh::iObject* attr, const Attribute& pba)
 {
 	bool match = false;
 	switch (pba.attr_case())
@@ -70,6 +71,19 @@ bool equals (
 				match = pba.str() == attr->to_string();
 			}
 			break;
+		default:
+			match = true; // return true if attribute is unknown
+	}
+	return match;
+}
+
+bool equals (
+	QResultsT& candidates, const marsh::iObject* attr,
+	const Attribute& pba, const Query& matcher)
+{
+	bool match = false;
+	switch (pba.attr_case())
+	{
 		case Attribute::kNode:
 			if (auto tens = dynamic_cast<const teq::TensorObj*>(attr))
 			{
@@ -101,11 +115,524 @@ bool equals (
 			}
 			break;
 		default:
-			match = true; // return true if attribute is unknown
+			match = value_equals(attr, pba);
 	}
 	return match;
 }
 
+struct GoalHasher
+{
+	size_t operator ()(const std::pair<size_t,teq::iTensor*>& goal) const
+	{
+		size_t seed = 0;
+		boost::hash_combine(seed, goal.first);
+		boost::hash_combine(seed, goal.second);
+		return seed;
+	}
+};
+
+struct Matcher::State final
+{
+	State (size_t nslots) : binds_(nslots, nullptr) {}
+
+	/// Tensors bound to each slot of the pattern being matched
+	std::vector<teq::iTensor*> binds_;
+
+	/// Outcomes of ground subpatterns by compiled node and tensor
+	std::unordered_map<std::pair<size_t,teq::iTensor*>,bool,GoalHasher> ground_;
+
+	size_t pattern_;
+
+	teq::iTensor* root_;
+
+	QResultsT* results_;
+
+	QReSetT existing_;
+};
+
+/// Goal node marking the end of ground subpattern searches
+static const size_t found_node = Matcher::no_slot;
+
+size_t Matcher::add (const Node& pattern)
+{
+	patterns_.push_back(std::make_unique<Node>(pattern));
+	roots_.push_back(compile(*patterns_.back()));
+
+	// slots are shared by name across patterns, so collect the pattern's own
+	std::vector<size_t> slots;
+	std::vector<size_t> tovisit = {roots_.back()};
+	std::unordered_set<size_t> visited;
+	while (false == tovisit.empty())
+	{
+		size_t idx = tovisit.back();
+		tovisit.pop_back();
+		const CompiledNode& node = nodes_[idx];
+		if (node.ground_ || false == visited.emplace(idx).second)
+		{
+			continue;
+		}
+		if (no_slot != node.slot_ &&
+			std::find(slots.begin(), slots.end(), node.slot_) == slots.end())
+		{
+			slots.push_back(node.slot_);
+		}
+		tovisit.insert(tovisit.end(), node.args_.begin(), node.args_.end());
+		for (auto& tattr : node.tens_attrs_)
+		{
+			if (no_slot != tattr.second)
+			{
+				tovisit.push_back(tattr.second);
+			}
+		}
+	}
+	pattern_slots_.push_back(slots);
+	return roots_.size() - 1;
+}
+
+size_t Matcher::intern (const std::string& symbol)
+{
+	auto it = slots_.find(symbol);
+	if (slots_.end() != it)
+	{
+		return it->second;
+	}
+	size_t slot = slot_names_.size();
+	slot_names_.push_back(symbol);
+	slots_.emplace(symbol, slot);
+	return slot;
+}
+
+size_t Matcher::compile (const Node& node)
+{
+	CompiledNode out;
+	out.type_ = node.val_case();
+	out.slot_ = no_slot;
+	std::stringstream key;
+	key << (int) out.type_ << ":";
+	switch (out.type_)
+	{
+		case Node::ValCase::kSymb:
+			out.slot_ = intern(node.symb());
+			out.ground_ = false;
+			key << out.slot_;
+			break;
+		case Node::ValCase::kCst:
+			out.cst_ = node.cst();
+			key << fmts::to_string(out.cst_);
+			break;
+		case Node::ValCase::kLeaf:
+			out.leaf_ = &node.leaf();
+			key << out.leaf_->SerializeAsString();
+			break;
+		case Node::ValCase::kOp:
+		{
+			const Operator& op = node.op();
+			out.opname_ = op.opname();
+			out.commutative_ = egen::is_commutative(out.opname_);
+			key << out.opname_;
+			// order attributes by key so equivalent patterns share nodes
+			std::map<std::string,const Attribute*> attrs;
+			for (const auto& attr : op.attrs())
+			{
+				attrs.emplace(attr.first, &attr.second);
+			}
+			for (const auto& attr : attrs)
+			{
+				const Attribute& pba = *attr.second;
+				key << "|" << attr.first << "=";
+				if (Attribute::kNode == pba.attr_case())
+				{
+					size_t idx = compile(pba.node());
+					out.ground_ = out.ground_ && nodes_[idx].ground_;
+					out.tens_attrs_.push_back({attr.first, idx});
+					out.layers_.push_back(nullptr);
+					key << "#" << idx;
+				}
+				else if (Attribute::kLayer == pba.attr_case())
+				{
+					const Layer& layer = pba.layer();
+					size_t idx = no_slot;
+					if (layer.has_input())
+					{
+						idx = compile(layer.input());
+						out.ground_ = out.ground_ && nodes_[idx].ground_;
+					}
+					out.tens_attrs_.push_back({attr.first, idx});
+					out.layers_.push_back(&layer);
+					key << "@" << (Layer::kName == layer.nullable_name_case() ?
+						layer.name() : "") << "#" << idx;
+				}
+				else
+				{
+					out.val_attrs_.push_back({attr.first, attr.second});
+					key << pba.SerializeAsString();
+				}
+			}
+			key << "|(";
+			for (const Node& arg : op.args())
+			{
+				size_t idx = compile(arg);
+				out.ground_ = out.ground_ && nodes_[idx].ground_;
+				out.args_.push_back(idx);
+				key << idx << ",";
+			}
+			key << ")";
+			if (Operator::kCapture == op.nullable_capture_case())
+			{
+				out.slot_ = intern(op.capture());
+				out.ground_ = false;
+				key << "$" << out.slot_;
+			}
+		}
+			break;
+		default:
+			global::fatal("cannot look for unknown node");
+	}
+	auto it = node_keys_.find(key.str());
+	if (node_keys_.end() != it)
+	{
+		return it->second;
+	}
+	size_t idx = nodes_.size();
+	nodes_.push_back(out);
+	node_keys_.emplace(key.str(), idx);
+	return idx;
+}
+
+QResultsT Matcher::match (const Query& index, size_t pattern) const
+{
+	QResultsT results;
+	State state(slot_names_.size());
+	state.pattern_ = pattern;
+	state.results_ = &results;
+	const CompiledNode& root = nodes_.at(roots_.at(pattern));
+	if (Node::ValCase::kOp == root.type_)
+	{
+		auto it = index.sindex_.find(root.opname_);
+		if (index.sindex_.end() != it)
+		{
+			for (teq::iTensor* tens : it->second)
+			{
+				match_root(state, pattern, tens);
+			}
+		}
+	}
+	else
+	{
+		for (teq::iTensor* tens : index.visited_)
+		{
+			match_root(state, pattern, tens);
+		}
+	}
+	return results;
+}
+
+QResultsT Matcher::match (const Query& index,
+	const teq::TensSetT& candidates, size_t pattern) const
+{
+	QResultsT results;
+	State state(slot_names_.size());
+	state.pattern_ = pattern;
+	state.results_ = &results;
+	for (teq::iTensor* tens : candidates)
+	{
+		if (estd::has(index.visited_, tens))
+		{
+			match_root(state, pattern, tens);
+		}
+	}
+	return results;
+}
+
+std::vector<QResultsT> Matcher::match_all (const Query& index) const
+{
+	size_t npatterns = roots_.size();
+	std::vector<QResultsT> results(npatterns);
+	types::StrUMapT<std::vector<size_t>> op_patterns;
+	std::vector<size_t> any_patterns;
+	for (size_t i = 0; i < npatterns; ++i)
+	{
+		const CompiledNode& root = nodes_[roots_[i]];
+		if (Node::ValCase::kOp == root.type_)
+		{
+			op_patterns[root.opname_].push_back(i);
+		}
+		else
+		{
+			any_patterns.push_back(i);
+		}
+	}
+	// ground outcomes are kept across patterns and roots
+	State state(slot_names_.size());
+	auto match_group = [&](teq::iTensor* tens, const std::vector<size_t>& group)
+	{
+		for (size_t i : group)
+		{
+			state.pattern_ = i;
+			state.results_ = &results[i];
+			match_root(state, i, tens);
+		}
+	};
+	for (auto& oppair : op_patterns)
+	{
+		auto it = index.sindex_.find(oppair.first);
+		if (index.sindex_.end() != it)
+		{
+			for (teq::iTensor* tens : it->second)
+			{
+				match_group(tens, oppair.second);
+			}
+		}
+	}
+	if (false == any_patterns.empty())
+	{
+		for (teq::iTensor* tens : index.visited_)
+		{
+			match_group(tens, any_patterns);
+		}
+	}
+	return results;
+}
+
+void Matcher::match_root (State& state,
+	size_t pattern, teq::iTensor* root) const
+{
+	state.root_ = root;
+	state.existing_.clear();
+	Goal goal{roots_[pattern], root, nullptr};
+	solve(state, &goal);
+}
+
+bool Matcher::solve (State& state, const Goal* goal) const
+{
+	if (nullptr == goal)
+	{
+		QueryResult result{state.root_, SymbMapT()};
+		for (size_t slot : pattern_slots_[state.pattern_])
+		{
+			if (nullptr != state.binds_[slot])
+			{
+				result.symbs_.emplace(slot_names_[slot], state.binds_[slot]);
+			}
+		}
+		if (state.existing_.emplace(result).second)
+		{
+			state.results_->push_back(result);
+		}
+		return false;
+	}
+	if (found_node == goal->node_)
+	{
+		return true;
+	}
+	const CompiledNode& node = nodes_[goal->node_];
+	if (node.ground_ && Node::ValCase::kOp == node.type_)
+	{
+		auto key = std::make_pair(goal->node_, goal->tens_);
+		auto it = state.ground_.find(key);
+		bool found;
+		if (state.ground_.end() != it)
+		{
+			found = it->second;
+		}
+		else
+		{
+			Goal end{found_node, nullptr, nullptr};
+			found = solve_node(state, Goal{goal->node_, goal->tens_, &end});
+			state.ground_.emplace(key, found);
+		}
+		return found && solve(state, goal->next_);
+	}
+	return solve_node(state, *goal);
+}
+
+bool Matcher::solve_node (State& state, const Goal& goal) const
+{
+	const CompiledNode& node = nodes_[goal.node_];
+	if (Node::ValCase::kSymb == node.type_)
+	{
+		return bind(state, node.slot_, goal.tens_, goal.next_);
+	}
+	if (Node::ValCase::kOp != node.type_)
+	{
+		return surface_matches(node, goal.tens_) && solve(state, goal.next_);
+	}
+	auto func = dynamic_cast<teq::iFunctor*>(goal.tens_);
+	if (nullptr == func)
+	{
+		return false;
+	}
+	auto args = func->get_args();
+	if (false == op_matches(node, *func, args.size()))
+	{
+		return false;
+	}
+	if (no_slot != node.slot_)
+	{
+		// capture is bound before arguments so they can reference it
+		teq::iTensor*& bound = state.binds_[node.slot_];
+		if (nullptr == bound)
+		{
+			bound = goal.tens_;
+			bool stop = chain_attrs(state, node, *func, args, 0, goal.next_);
+			bound = nullptr;
+			return stop;
+		}
+		if (bound != goal.tens_)
+		{
+			return false;
+		}
+	}
+	return chain_attrs(state, node, *func, args, 0, goal.next_);
+}
+
+bool Matcher::bind (State& state, size_t slot,
+	teq::iTensor* tens, const Goal* next) const
+{
+	teq::iTensor*& bound = state.binds_[slot];
+	if (nullptr == bound)
+	{
+		bound = tens;
+		bool stop = solve(state, next);
+		bound = nullptr;
+		return stop;
+	}
+	return bound == tens && solve(state, next);
+}
+
+bool Matcher::chain_attrs (State& state, const CompiledNode& node,
+	teq::iFunctor& func, const teq::TensptrsT& args,
+	size_t i, const Goal* next) const
+{
+	if (i >= node.tens_attrs_.size())
+	{
+		if (node.commutative_)
+		{
+			std::vector<bool> used(args.size(), false);
+			return assign_args(state, node, args, used, 0, next);
+		}
+		return chain_args(state, node, args, node.args_.size(), next);
+	}
+	auto& tattr = node.tens_attrs_[i];
+	const marsh::iObject* attr = func.get_attr(tattr.first);
+	teq::iTensor* tens = nullptr;
+	if (const Layer* layer = node.layers_[i])
+	{
+		auto lay = dynamic_cast<const teq::LayerObj*>(attr);
+		if (nullptr == lay || (Layer::kName == layer->nullable_name_case() &&
+			layer->name() != lay->get_opname()))
+		{
+			return false;
+		}
+		if (no_slot == tattr.second)
+		{
+			return chain_attrs(state, node, func, args, i + 1, next);
+		}
+		tens = lay->get_tensor().get();
+	}
+	else if (auto tobj = dynamic_cast<const teq::TensorObj*>(attr))
+	{
+		tens = tobj->get_tensor().get();
+	}
+	else
+	{
+		return false;
+	}
+	Goal goal{tattr.second, tens, next};
+	return chain_attrs(state, node, func, args, i + 1, &goal);
+}
+
+bool Matcher::chain_args (State& state, const CompiledNode& node,
+	const teq::TensptrsT& args, size_t i, const Goal* next) const
+{
+	// goals are linked from the last argument to the first
+	if (0 == i)
+	{
+		return solve(state, next);
+	}
+	Goal goal{node.args_[i - 1], args[i - 1].get(), next};
+	return chain_args(state, node, args, i - 1, &goal);
+}
+
+bool Matcher::assign_args (State& state, const CompiledNode& node,
+	const teq::TensptrsT& args, std::vector<bool>& used,
+	size_t i, const Goal* next) const
+{
+	if (i >= node.args_.size())
+	{
+		return solve(state, next);
+	}
+	size_t cond = node.args_[i];
+	for (size_t j = 0, n = args.size(); j < n; ++j)
+	{
+		teq::iTensor* arg = args[j].get();
+		if (used[j] || false == surface_matches(nodes_[cond], arg))
+		{
+			continue;
+		}
+		// identical unused arguments lead to identical matches
+		bool repeated = false;
+		for (size_t k = 0; k < j && false == repeated; ++k)
+		{
+			repeated = false == used[k] && args[k].get() == arg;
+		}
+		if (repeated)
+		{
+			continue;
+		}
+		Goal goal{cond, arg, next};
+		used[j] = true;
+		bool stop = assign_args(state, node, args, used, i + 1, &goal);
+		used[j] = false;
+		if (stop)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+bool Matcher::surface_matches (
+	const CompiledNode& node, teq::iTensor* tens) const
+{
+	switch (node.type_)
+	{
+		case Node::ValCase::kSymb:
+			return true;
+		case Node::ValCase::kCst:
+			return equals(dynamic_cast<const teq::iLeaf*>(tens), node.cst_);
+		case Node::ValCase::kLeaf:
+			return equals(dynamic_cast<const teq::iLeaf*>(tens), *node.leaf_);
+		case Node::ValCase::kOp:
+		{
+			auto func = dynamic_cast<const teq::iFunctor*>(tens);
+			return nullptr != func &&
+				op_matches(node, *func, func->get_args().size());
+		}
+		default:
+			break;
+	}
+	return false;
+}
+
+bool Matcher::op_matches (const CompiledNode& node,
+	const teq::iFunctor& func, size_t nargs) const
+{
+	if (func.get_opcode().name_ != node.opname_)
+	{
+		return false;
+	}
+	if (node.args_.size() > nargs)
+	{
+		return false;
+	}
+	return std::all_of(node.val_attrs_.begin(), node.val_attrs_.end(),
+		[&func](const std::pair<std::string,const Attribute*>& vattr)
+		{
+			return value_equals(func.get_attr(vattr.first), *vattr.second);
+		});
+}
+
 }
 
 #endif
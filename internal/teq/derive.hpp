@@ -64,6 +64,20 @@ void partial_derive (GradMapT& grads,
 	const TensSetT& targets,
 	const iDerivativeFuncs& funcs);
 
+/// Return functors of roots' graphs whose heights are multiples of
+/// roughly the square root of the tallest root's height,
+/// such that recomputing between them costs about sqrt(height) steps
+TensSetT sqrt_checkpoints (const TensptrsT& roots);
+
+/// Rewrite backward graphs of grads to reference functors of roots'
+/// forward graphs only if they are checkpoints, otherwise reference
+/// copies recomputed from the closest checkpoints and leaves.
+/// Each forward functor is recomputed at most once, so extra compute is
+/// bounded by one forward pass while forward activations that are not
+/// checkpoints no longer live until the backward pass consumes them
+void rematerialize (TensptrsT& grads,
+	const TensptrsT& roots, const TensSetT& checkpoints);
+
 }
 
 #endif // TEQ_DERIVE_HPP
@@ -1,4 +1,5 @@
 #include <cassert>
+#include <cmath>
 #include <list>
 
 #include "internal/teq/derive.hpp"
@@ -160,6 +161,155 @@ void partial_derive (TensMapT<TensptrsT>& grads,
 	}
 }
 
+TensSetT sqrt_checkpoints (const TensptrsT& roots)
+{
+	GraphStat stat;
+	multi_visit(stat, roots);
+	size_t height = 0;
+	for (auto& root : roots)
+	{
+		if (nullptr != root)
+		{
+			height = std::max(height, stat.at(root.get()).upper_);
+		}
+	}
+	size_t interval = std::max<size_t>(1,
+		(size_t) std::round(std::sqrt(height)));
+	TensSetT checkpoints;
+	for (auto& gpair : stat.graphsize_)
+	{
+		size_t fheight = gpair.second.upper_;
+		if (fheight > 0 && 0 == fheight % interval)
+		{
+			checkpoints.emplace(gpair.first);
+		}
+	}
+	return checkpoints;
+}
+
+struct Rematerializer final
+{
+	Rematerializer (const TensptrsT& roots, const TensSetT& checkpoints) :
+		checkpoints_(checkpoints)
+	{
+		OwnMapT owners = track_ownptrs(roots);
+		for (auto& owner : owners)
+		{
+			forwards_.emplace(owner.first);
+		}
+	}
+
+	/// Return tens if it needs no recomputation
+	/// otherwise return its recomputed copy
+	TensptrT recompute (const TensptrT& tens)
+	{
+		auto f = dynamic_cast<iFunctor*>(tens.get());
+		if (nullptr == f || false == estd::has(forwards_, f) ||
+			estd::has(checkpoints_, f))
+		{
+			return tens;
+		}
+		TensptrT out;
+		if (estd::get(out, recomputed_, f))
+		{
+			return out;
+		}
+		FuncptrT cpy(f->clone());
+		auto args = f->get_args();
+		for (size_t i = 0, n = args.size(); i < n; ++i)
+		{
+			auto arg = recompute(args[i]);
+			if (arg != args[i])
+			{
+				cpy->update_child(arg, i);
+			}
+		}
+		replace_refs(*cpy);
+		recomputed_.emplace(f, cpy);
+		copies_.emplace(cpy.get());
+		return cpy;
+	}
+
+	/// Replace tensor reference attributes of func with their recomputations
+	void replace_refs (iFunctor& func)
+	{
+		auto attrs = func.ls_attrs();
+		for (auto attr : attrs)
+		{
+			if (auto refattr = dynamic_cast<
+				const TensorRef*>(func.get_attr(attr)))
+			{
+				auto reftens = refattr->get_tensor();
+				auto newref = recompute(reftens);
+				if (newref != reftens)
+				{
+					auto alt = refattr->copynreplace(newref);
+					func.rm_attr(attr);
+					func.add_attr(attr, marsh::ObjptrT(alt));
+				}
+			}
+		}
+	}
+
+	TensSetT forwards_;
+
+	TensSetT checkpoints_;
+
+	/// Map forward functors to their recomputed copies
+	OwnMapT recomputed_;
+
+	TensSetT copies_;
+};
+
+void rematerialize (TensptrsT& grads,
+	const TensptrsT& roots, const TensSetT& checkpoints)
+{
+	Rematerializer remat(roots, checkpoints);
+	std::list<iFunctor*> tovisits;
+	for (auto& grad : grads)
+	{
+		grad = remat.recompute(grad);
+		auto f = dynamic_cast<iFunctor*>(grad.get());
+		if (nullptr != f && false == estd::has(remat.forwards_, f))
+		{
+			tovisits.push_back(f);
+		}
+	}
+	// backward functors are visited once, and only forward
+	// functors they reference directly are swapped for recomputations
+	FuncSetT visited;
+	while (false == tovisits.empty())
+	{
+		iFunctor* bwd = tovisits.front();
+		tovisits.pop_front();
+		if (false == visited.emplace(bwd).second)
+		{
+			continue;
+		}
+		auto args = bwd->get_args();
+		for (size_t i = 0, n = args.size(); i < n; ++i)
+		{
+			auto arg = args[i];
+			if (estd::has(remat.forwards_, arg.get()))
+			{
+				auto rep = remat.recompute(arg);
+				if (rep != arg)
+				{
+					bwd->update_child(rep, i);
+				}
+			}
+			else if (auto f = dynamic_cast<iFunctor*>(arg.get()))
+			{
+				if (false == estd::has(remat.copies_, f))
+				{
+					tovisits.push_back(f);
+				}
+			}
+		}
+		remat.replace_refs(*bwd);
+	}
+}
+
 }
 
 #endif
@@ -258,8 +258,11 @@ estd::NumRange<T> generate_range (teq::iFunctor& func, const NumRangesT<T>& rang
 		case egen::RAND_UNIF:
 		case egen::SLICE:
 		case egen::STRIDE:
+		case egen::GATHER:
 		case egen::REDUCE_MIN:
 		case egen::REDUCE_MAX:
+		case egen::MAX_POOL:
+		case egen::AVG_POOL:
 			outrange = ranges[0];
 			break;
 		case egen::PAD:
@@ -271,6 +274,44 @@ estd::NumRange<T> generate_range (teq::iFunctor& func, const NumRangesT<T>& rang
 				*std::max_element(bounds.begin(), bounds.end()));
 		}
 			break;
+		case egen::SCATTER_ADD:
+		{
+			// each output element accumulates at most every update
+			T nindices = func.get_args()[1]->shape().n_elems();
+			std::vector<T> bounds = {
+				ranges[0].lower_ * nindices, ranges[0].upper_ * nindices, 0};
+			outrange = estd::NumRange<T>(
+				*std::min_element(bounds.begin(), bounds.end()),
+				*std::max_element(bounds.begin(), bounds.end()));
+		}
+			break;
+		case egen::MAX_POOL_GRAD:
+		case egen::AVG_POOL_GRAD:
+		{
+			teq::ShapeT windows, strides;
+			unpack_pool(windows, strides, func);
+
+			// each input element accumulates gradients of at most
+			// noverlaps windows that cover it
+			T noverlaps = 1;
+			T nwindow = 1;
+			for (size_t i = 0; i < teq::rank_cap; ++i)
+			{
+				noverlaps *= (windows[i] + strides[i] - 1) / strides[i];
+				nwindow *= windows[i];
+			}
+			if (egen::AVG_POOL_GRAD == opcode.code_)
+			{
+				noverlaps /= nwindow;
+			}
+			const estd::NumRange<T>& grads = ranges.back();
+			std::vector<T> bounds = {
+				grads.lower_ * noverlaps, grads.upper_ * noverlaps, 0};
+			outrange = estd::NumRange<T>(
+				*std::min_element(bounds.begin(), bounds.end()),
+				*std::max_element(bounds.begin(), bounds.end()));
+		}
+			break;
 		case egen::ARGMAX:
 		{
 			teq::RankT return_dim;
@@ -464,6 +505,41 @@ estd::NumRange<T> generate_range (teq::iFunctor& func, const NumRangesT<T>& rang
 				ranges[0].upper_ * nreds);
 		}
 			break;
+		case egen::SOFTMAX:
+			outrange = estd::NumRange<T>(0, 1);
+			break;
+		case egen::LOG_SOFTMAX:
+		case egen::SOFTMAX_CROSS_ENTROPY:
+		{
+			std::set<teq::RankT> ranks;
+			Packer<std::set<teq::RankT>>().unpack(ranks, func);
+
+			teq::TensptrT arg = func.get_args().back();
+			teq::Shape shape = arg->shape();
+			teq::NElemT nreds = 1;
+			for (teq::RankT rank : ranks)
+			{
+				nreds *= shape.at(rank);
+			}
+			const estd::NumRange<T>& logits = ranges.back();
+			// log_softmax is bounded by the logit spread and normalization
+			T lower = logits.lower_ - logits.upper_ - std::log((double) nreds);
+			if (egen::LOG_SOFTMAX == opcode.code_)
+			{
+				outrange = estd::NumRange<T>(lower, 0);
+				break;
+			}
+			// cross entropy sums -labels * log_softmax over reduced elements
+			std::vector<T> bounds = {
+				-ranges[0].lower_ * lower,
+				-ranges[0].upper_ * lower,
+				0,
+			};
+			outrange = estd::NumRange<T>(
+				*std::min_element(bounds.begin(), bounds.end()) * nreds,
+				*std::max_element(bounds.begin(), bounds.end()) * nreds);
+		}
+			break;
 		case egen::REDUCE_PROD:
 		{
 			std::set<teq::RankT> ranks;
@@ -539,6 +615,75 @@ estd::NumRange<T> generate_range (teq::iFunctor& func, const NumRangesT<T>& rang
 				*std::max_element(bounds.begin(), bounds.end()) * nkern);
 		}
 			break;
+		case egen::CONV2D:
+		case egen::CONV2D_IMAGE_GRAD:
+		case egen::CONV2D_KERNEL_GRAD:
+		{
+			// each output sums products of its arguments over
+			// kernel patch (conv2d), output channels and kernel
+			// window (image grad), or image patches (kernel grad)
+			auto args = func.get_args();
+			teq::NElemT nterms;
+			switch (opcode.code_)
+			{
+				case egen::CONV2D:
+					nterms = args[1]->shape().n_elems() / args[1]->shape().at(0);
+					break;
+				case egen::CONV2D_IMAGE_GRAD:
+					nterms = args[0]->shape().n_elems() / args[0]->shape().at(1);
+					break;
+				default: // CONV2D_KERNEL_GRAD
+					nterms = args[1]->shape().n_elems() / args[1]->shape().at(0);
+			}
+			T llower = ranges[0].lower_;
+			T lupper = ranges[0].upper_;
+			T rlower = ranges[1].lower_;
+			T rupper = ranges[1].upper_;
+			std::vector<T> bounds = {
+				llower * rlower,
+				llower * rupper,
+				lupper * rlower,
+				lupper * rupper,
+				0, // zero paddings contribute nothing
+			};
+			outrange = estd::NumRange<T>(
+				*std::min_element(bounds.begin(), bounds.end()) * nterms,
+				*std::max_element(bounds.begin(), bounds.end()) * nterms);
+		}
+			break;
+		case egen::LSTM_CELL:
+			// next state = candidate * input + state * forget where
+			// candidate is in [-1, 1] and gates are in [0, 1],
+			// next hidden = next state * output is within the same range
+			outrange = estd::NumRange<T>(
+				std::min(ranges[2].lower_, (T) 0) - 1,
+				std::max(ranges[2].upper_, (T) 0) + 1);
+			break;
+		case egen::GRU_CELL:
+			// next state interpolates between state and candidate in [-1, 1]
+			outrange = estd::NumRange<T>(
+				std::min(ranges[1].lower_, (T) -1),
+				std::max(ranges[1].upper_, (T) 1));
+			break;
+		case egen::LSTM_CELL_GRAD:
+		case egen::GRU_CELL_GRAD:
+			// weight and bias gradients accumulate across the batch
+			// without a useful closed-form bound
+			outrange = estd::NumRange<T>(
+				std::numeric_limits<T>::lowest(),
+				std::numeric_limits<T>::max());
+			break;
+		case egen::QUANTIZE:
+			outrange = estd::NumRange<T>(
+				(T) -eigen::quant_limit, (T) eigen::quant_limit);
+			break;
+		case egen::QUANT_MATMUL:
+		case egen::QUANT_CONV2D:
+			// outputs are rescaled by multipliers of the quantized arguments
+			outrange = estd::NumRange<T>(
+				std::numeric_limits<T>::lowest(),
+				std::numeric_limits<T>::max());
+			break;
 		default:
 			global::fatalf("Unknown op %s", opcode.name_.c_str());
 	}
@@ -283,6 +283,82 @@ BENCHMARK_TEMPLATE(BM_Batch_Matmul, int32_t)
 	->Complexity(benchmark::oN);
 
 
+// compare conv2d against its equivalent generic convolution graph
+template <typename T>
+static void BM_Conv(benchmark::State& state)
+{
+	teq::DimT imgdim = state.range(0);
+	teq::Shape imgshape({16, imgdim, imgdim, 4});
+	teq::Shape kernshape({32, 16, 3, 3});
+	eteq::EVariable<T> image = eteq::make_variable_scalar<T>(0, imgshape, "image");
+	eteq::EVariable<T> kernel = eteq::make_variable_scalar<T>(0, kernshape, "kernel");
+	teq::DimT img_pad = kernshape.at(0) - 1;
+	eteq::ETensor out = tenncor().permute(tenncor().convolution(
+		tenncor().pad(image, eteq::DimPairsT{img_pad, img_pad}, 4),
+		tenncor().reverse(kernel, {0}), {4, 0, 1, 2}), {4, 1, 2, 3});
+	auto ctx = out.get_context();
+	auto tens = out.get();
+	eigen::Device device(std::numeric_limits<size_t>::max());
+	for (auto _ : state)
+	{
+		state.PauseTiming();
+		std::vector<double> data = random_data(imgshape.n_elems(), -35, 35);
+		std::vector<double> data2 = random_data(kernshape.n_elems(), -35, 35);
+		std::vector<T> convdata(data.begin(), data.end());
+		std::vector<T> convdata2(data2.begin(), data2.end());
+		image->assign(convdata.data(), imgshape);
+		kernel->assign(convdata2.data(), kernshape);
+		state.ResumeTiming();
+		teq::get_eval(ctx).evaluate(device, {tens});
+	}
+	state.SetComplexityN(state.range(0));
+}
+
+BENCHMARK_TEMPLATE(BM_Conv, double)
+	->Range(8, 64)
+	->Complexity(benchmark::oNSquared);
+
+BENCHMARK_TEMPLATE(BM_Conv, float)
+	->Range(8, 64)
+	->Complexity(benchmark::oNSquared);
+
+
+template <typename T>
+static void BM_Conv2d(benchmark::State& state)
+{
+	teq::DimT imgdim = state.range(0);
+	teq::Shape imgshape({16, imgdim, imgdim, 4});
+	teq::Shape kernshape({32, 16, 3, 3});
+	eteq::EVariable<T> image = eteq::make_variable_scalar<T>(0, imgshape, "image");
+	eteq::EVariable<T> kernel = eteq::make_variable_scalar<T>(0, kernshape, "kernel");
+	eteq::ETensor out = tenncor().nn.conv2d(image, kernel);
+	auto ctx = out.get_context();
+	auto tens = out.get();
+	eigen::Device device(std::numeric_limits<size_t>::max());
+	for (auto _ : state)
+	{
+		state.PauseTiming();
+		std::vector<double> data = random_data(imgshape.n_elems(), -35, 35);
+		std::vector<double> data2 = random_data(kernshape.n_elems(), -35, 35);
+		std::vector<T> convdata(data.begin(), data.end());
+		std::vector<T> convdata2(data2.begin(), data2.end());
+		image->assign(convdata.data(), imgshape);
+		kernel->assign(convdata2.data(), kernshape);
+		state.ResumeTiming();
+		teq::get_eval(ctx).evaluate(device, {tens});
+	}
+	state.SetComplexityN(state.range(0));
+}
+
+BENCHMARK_TEMPLATE(BM_Conv2d, double)
+	->Range(8, 64)
+	->Complexity(benchmark::oNSquared);
+
+BENCHMARK_TEMPLATE(BM_Conv2d, float)
+	->Range(8, 64)
+	->Complexity(benchmark::oNSquared);
+
+
 static void BM_MatmulComplex(benchmark::State& state)
 {
 	teq::DimsT alist = {3, 2};
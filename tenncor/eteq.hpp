@@ -19,7 +19,19 @@ eteq::ETensorsT derive_with_manager (
 	eteq::ETensor root, const eteq::ETensorsT& targets);
 
 /// Derive root with respect to target and optimized
-eteq::ETensorsT derive (eteq::ETensor root, const eteq::ETensorsT& targets);
+/// If simplify is true, skip multiplications by one, additions of zero,
+/// and other trivial gradients while building the backward graph
+/// (distributed derivation ignores simplify)
+eteq::ETensorsT derive (eteq::ETensor root,
+	const eteq::ETensorsT& targets, bool simplify = false);
+
+/// Derive root with respect to target where the backward graph recomputes
+/// forward activations from checkpoints instead of keeping them alive
+/// If checkpoints is empty, select about sqrt(height) levels of root's graph
+/// Non-idempotent functors (e.g.: random) are always kept as checkpoints
+eteq::ETensorsT derive_checkpointed (eteq::ETensor root,
+	const eteq::ETensorsT& targets,
+	const eteq::ETensorsT& checkpoints = {});
 
 }
 
@@ -54,9 +54,30 @@ static inline teq::RanksT reorder_permute (
 	return reorder;
 }
 
+/// Return true and set value if tens is a constant (or extended constant)
+/// whose elements all equal value, otherwise return false
+static inline bool scalar_value (double& value, teq::TensptrT tens)
+{
+	auto func = dynamic_cast<teq::iFunctor*>(tens.get());
+	while (nullptr != func && egen::EXTEND == func->get_opcode().code_)
+	{
+		tens = func->get_args().front();
+		func = dynamic_cast<teq::iFunctor*>(tens.get());
+	}
+	auto cst = dynamic_cast<const iConstant*>(tens.get());
+	return nullptr != cst && cst->scalar_value(value);
+}
+
 /// ETEQ implementation of TEQ's Backward Propagation Builder
+/// When simplify is set, gradients are simplified as they are built:
+/// multiplying by one, adding zero, and double negation are skipped,
+/// constant gradients propagate as constants instead of functors,
+/// and constants are a single extended scalar shared by every
+/// gradient of the same value, type, and shape
 struct DerivativeFuncs final : public teq::iDerivativeFuncs
 {
+	DerivativeFuncs (bool simplify = false) : simplify_(simplify) {}
+
 	/// Implementation of iDerivativeFuncs
 	teq::TensptrT lderive (teq::FuncptrT op,
 		teq::TensptrT supgrad, size_t arg_idx) const override
@@ -73,7 +94,7 @@ struct DerivativeFuncs final : public teq::iDerivativeFuncs
 				out = supgrad;
 				break;
 			case egen::NEG:
-				out = make_functor(egen::NEG, {supgrad});
+				out = neg(supgrad);
 				break;
 			case egen::TAN:
 				out =  make_functor(egen::DIV, {
@@ -177,24 +198,18 @@ struct DerivativeFuncs final : public teq::iDerivativeFuncs
 						local_der = make_functor(egen::EQ, {op, args.at(arg_idx)});
 						break;
 				}
-				out = make_functor(egen::MUL, {local_der, supgrad});
+				out = mul(local_der, supgrad);
 			}
 				break;
 			case egen::SUB:
-				out = arg_idx == 0 ? supgrad : make_functor(egen::NEG, {supgrad});
+				out = arg_idx == 0 ? supgrad : neg(supgrad);
 				break;
 			case egen::DIV:
-				out = arg_idx == 0 ? make_functor(egen::DIV, {supgrad, args[1]}) :
-					make_functor(egen::DIV, {
-						make_functor(egen::DIV, {
-							make_functor(egen::MUL, {
-								make_functor(egen::NEG, {supgrad}), args[0]}),
-							args[1]
-						}), args[1]
-					});
+				out = arg_idx == 0 ? div(supgrad, args[1]) :
+					div(div(mul(neg(supgrad), args[0]), args[1]), args[1]);
 				break;
 			case egen::REDUCE_SUM:
-				out = reduce_grad(args.front()->shape(), supgrad, op);
+				out = extend_grad(args.front()->shape(), supgrad, op);
 				break;
 			case egen::REDUCE_PROD:
 				out = make_functor(egen::MUL, {
@@ -215,12 +230,61 @@ struct DerivativeFuncs final : public teq::iDerivativeFuncs
 					})
 				});
 				break;
+			case egen::SOFTMAX:
+			{
+				std::set<teq::RankT> ranks;
+				eigen::Packer<std::set<teq::RankT>>().unpack(ranks, *op);
+
+				// softmax grad = op * (supgrad - sum(supgrad * op))
+				out = make_functor(egen::MUL, {op,
+					make_functor(egen::SUB, {supgrad,
+						reduce_grad(args.front()->shape(),
+							make_functor(egen::REDUCE_SUM, {
+								make_functor(egen::MUL, {supgrad, op})
+							}, ranks), op)
+					})
+				});
+			}
+				break;
+			case egen::LOG_SOFTMAX:
+			{
+				std::set<teq::RankT> ranks;
+				eigen::Packer<std::set<teq::RankT>>().unpack(ranks, *op);
+
+				// log_softmax grad = supgrad - exp(op) * sum(supgrad)
+				out = make_functor(egen::SUB, {supgrad,
+					make_functor(egen::MUL, {
+						make_functor(egen::EXP, {op}),
+						reduce_grad(args.front()->shape(),
+							make_functor(egen::REDUCE_SUM, {supgrad}, ranks), op)
+					})
+				});
+			}
+				break;
+			case egen::SOFTMAX_CROSS_ENTROPY:
+			{
+				std::set<teq::RankT> ranks;
+				eigen::Packer<std::set<teq::RankT>>().unpack(ranks, *op);
+
+				// assuming labels sum to 1 across ranks
+				// logits grad = (softmax(logits) - labels) * supgrad
+				// labels grad = -log_softmax(logits) * supgrad
+				teq::TensptrT local_der = arg_idx == 0 ?
+					make_functor(egen::NEG, {
+						make_functor(egen::LOG_SOFTMAX, {args[1]}, ranks)}) :
+					make_functor(egen::SUB, {
+						make_functor(egen::SOFTMAX, {args[1]}, ranks), args[0]});
+				out = make_functor(egen::MUL, {local_der,
+					reduce_grad(args[1]->shape(), supgrad, op)});
+			}
+				break;
 			case egen::EXTEND:
 			{
 				teq::DimsT bcast = *eigen::unpack_extend(
 					args.front()->shape(), *op);
 
 				std::set<teq::RankT> dims;
+				double nreduced = 1;
 				// technically, reduce_sum is not grad of broadcast,
 				// (since broadcast works on dimension > 1) (todo: account for this)
 				// but assuming broadcast is applied on dimensions of 1, reduce_sum is sufficient
@@ -231,8 +295,16 @@ struct DerivativeFuncs final : public teq::iDerivativeFuncs
 					if (d > 1)
 					{
 						dims.emplace(i);
+						nreduced *= d;
 					}
 				}
+				double value;
+				if (simplify_ && scalar_value(value, supgrad))
+				{
+					out = scalar_like(value * nreduced,
+						args.front()->shape(), supgrad);
+					break;
+				}
 				out = make_functor(egen::REDUCE_SUM, {supgrad}, dims);
 			}
 				break;
@@ -241,17 +313,36 @@ struct DerivativeFuncs final : public teq::iDerivativeFuncs
 				teq::RanksT order;
 				eigen::Packer<teq::RanksT>().unpack(order, *op);
 
+				double value;
+				if (simplify_ && scalar_value(value, supgrad))
+				{
+					out = scalar_like(value, args.front()->shape(), supgrad);
+					break;
+				}
 				out = make_functor(egen::PERMUTE, {supgrad}, reorder_permute(order));
 			}
 				break;
 			case egen::RESHAPE:
 			{
+				double value;
+				if (simplify_ && scalar_value(value, supgrad))
+				{
+					out = scalar_like(value, args.front()->shape(), supgrad);
+					break;
+				}
 				out = make_functor(egen::RESHAPE, {supgrad}, args.front()->shape());
 			}
 				break;
 			case egen::MATMUL:
 				if (arg_idx == 0)
 				{
+					if (nullptr != dynamic_cast<eigen::iSparseLeaf*>(args[1].get()))
+					{
+						// sup @ arg1^T without permuting sparse arg1
+						out = make_functor(egen::CONTRACT, {supgrad, args[1]},
+							eigen::PairVecT<teq::RankT>{{0, 0}});
+						break;
+					}
 					out = make_functor(egen::MATMUL, {
 						supgrad, 
 						make_functor(egen::PERMUTE, {args[1]}, teq::RanksT{1, 0})
@@ -259,6 +350,13 @@ struct DerivativeFuncs final : public teq::iDerivativeFuncs
 				}
 				else
 				{
+					if (nullptr != dynamic_cast<eigen::iSparseLeaf*>(args[0].get()))
+					{
+						// arg0^T @ sup without permuting sparse arg0
+						out = make_functor(egen::CONTRACT, {args[0], supgrad},
+							eigen::PairVecT<teq::RankT>{{1, 1}});
+						break;
+					}
 					// (sup^T @ arg0)^T = arg0^T @ sup
 					out = make_functor(egen::MATMUL, {
 						make_functor(egen::PERMUTE, {args[0]}, teq::RanksT{1, 0}),
@@ -399,6 +497,55 @@ struct DerivativeFuncs final : public teq::iDerivativeFuncs
 				}
 			}
 				break;
+			case egen::CONV2D:
+			case egen::CONV2D_IMAGE_GRAD:
+			case egen::CONV2D_KERNEL_GRAD:
+			{
+				eigen::Conv2dAttrs cattrs = eigen::unpack_conv2d(*op);
+				teq::DimsT strides = {cattrs.strides_.first, cattrs.strides_.second};
+				eigen::PairVecT<teq::DimT> paddings = {cattrs.xpad_, cattrs.ypad_};
+
+				// for conv2d(X, K) = C, image and kernel grads are adjoints of conv2d:
+				// <image_grad(K, dC), dX> = <dC, conv2d(dX, K)>
+				// <kernel_grad(X, dC), dK> = <dC, conv2d(X, dK)>
+				teq::TensptrT arg = args[arg_idx];
+				switch (opcode.code_)
+				{
+					case egen::CONV2D:
+						out = arg_idx == 0 ?
+							make_functor(egen::CONV2D_IMAGE_GRAD, {args[1], supgrad},
+								arg->shape(), strides, paddings) :
+							make_functor(egen::CONV2D_KERNEL_GRAD, {args[0], supgrad},
+								arg->shape(), strides, paddings);
+						break;
+					case egen::CONV2D_IMAGE_GRAD:
+						out = arg_idx == 0 ?
+							make_functor(egen::CONV2D_KERNEL_GRAD, {supgrad, args[1]},
+								arg->shape(), strides, paddings) :
+							make_functor(egen::CONV2D, {supgrad, args[0]},
+								strides, paddings);
+						break;
+					default: // CONV2D_KERNEL_GRAD
+						out = arg_idx == 0 ?
+							make_functor(egen::CONV2D_IMAGE_GRAD, {supgrad, args[1]},
+								arg->shape(), strides, paddings) :
+							make_functor(egen::CONV2D, {args[0], supgrad},
+								strides, paddings);
+				}
+			}
+				break;
+			case egen::LSTM_CELL:
+			case egen::GRU_CELL:
+			{
+				// fused cells recompute their gates in the backward pass
+				// rather than keeping every activation alive
+				auto gradcode = opcode.code_ == egen::LSTM_CELL ?
+					egen::LSTM_CELL_GRAD : egen::GRU_CELL_GRAD;
+				teq::TensptrsT gargs = args;
+				gargs.push_back(supgrad);
+				out = make_functor(gradcode, gargs, (teq::RankT) arg_idx);
+			}
+				break;
 			case egen::SLICE:
 			{
 				eigen::PairVecT<teq::DimT> extents;
@@ -490,6 +637,60 @@ struct DerivativeFuncs final : public teq::iDerivativeFuncs
 				out = make_functor(egen::STRIDE, {supgrad}, strides);
 			}
 				break;
+			case egen::GATHER:
+			{
+				if (arg_idx > 0)
+				{
+					// indices
+					out = constant_like(0.f, args[arg_idx]);
+					break;
+				}
+				teq::RankT dim;
+				eigen::Packer<teq::RankT>().unpack(dim, *op);
+				out = make_functor(egen::SCATTER_ADD, {supgrad, args[1]},
+					dim, args[0]->shape());
+			}
+				break;
+			case egen::SCATTER_ADD:
+			{
+				if (arg_idx > 0)
+				{
+					// indices
+					out = constant_like(0.f, args[arg_idx]);
+					break;
+				}
+				teq::RankT dim;
+				eigen::Packer<teq::RankT>().unpack(dim, *op);
+				out = make_functor(egen::GATHER, {supgrad, args[1]}, dim);
+			}
+				break;
+			case egen::MAX_POOL:
+			{
+				eigen::PairVecT<teq::DimT> windows;
+				eigen::Packer<eigen::PairVecT<teq::DimT>>().unpack(windows, *op);
+
+				out = make_functor(egen::MAX_POOL_GRAD,
+					{args.front(), op, supgrad}, windows);
+			}
+				break;
+			case egen::AVG_POOL:
+			{
+				eigen::PairVecT<teq::DimT> windows;
+				eigen::Packer<eigen::PairVecT<teq::DimT>>().unpack(windows, *op);
+
+				teq::Shape origshape = args.front()->shape();
+				out = make_functor(egen::AVG_POOL_GRAD, {supgrad}, origshape, windows);
+			}
+				break;
+			case egen::AVG_POOL_GRAD:
+			{
+				eigen::PairVecT<teq::DimT> windows;
+				eigen::Packer<eigen::PairVecT<teq::DimT>>().unpack(windows, *op);
+
+				// avg_pool_grad is the adjoint of avg_pool
+				out = make_functor(egen::AVG_POOL, {supgrad}, windows);
+			}
+				break;
 			case egen::REVERSE:
 			{
 				std::set<teq::RankT> dims;
@@ -532,7 +733,19 @@ struct DerivativeFuncs final : public teq::iDerivativeFuncs
 			case egen::ASSIGN_SUB:
 			case egen::ASSIGN_MUL:
 			case egen::ASSIGN_DIV:
+			case egen::SPARSE_ASSIGN_SUB:
+			case egen::SCATTER_ASSIGN_SUB:
+			case egen::APPLY_SGD:
+			case egen::APPLY_ADAGRAD:
+			case egen::APPLY_RMSPROP:
+			case egen::APPLY_ADAM:
 			case egen::ARGMAX:
+			case egen::MAX_POOL_GRAD:
+			case egen::LSTM_CELL_GRAD:
+			case egen::GRU_CELL_GRAD:
+			case egen::QUANTIZE:
+			case egen::QUANT_MATMUL:
+			case egen::QUANT_CONV2D:
 				global::fatalf("cannot derive %s", opcode.name_.c_str());
 				break;
 			default:
@@ -546,6 +759,10 @@ struct DerivativeFuncs final : public teq::iDerivativeFuncs
 	{
 		auto reftype = (egen::_GENERATED_DTYPE) reference.get_meta().type_code();
 		auto shape = reference.shape();
+		if (simplify_)
+		{
+			return scalar_const(1., shape, reftype);
+		}
 		std::vector<float> data(shape.n_elems(), 1.f);
 		return make_constant_tensor(data.data(), shape, reftype);
 	}
@@ -555,6 +772,10 @@ struct DerivativeFuncs final : public teq::iDerivativeFuncs
 	{
 		auto reftype = (egen::_GENERATED_DTYPE) reference.get_meta().type_code();
 		auto shape = reference.shape();
+		if (simplify_)
+		{
+			return scalar_const(0., shape, reftype);
+		}
 		std::vector<float> data(shape.n_elems(), 0.f);
 		return make_constant_tensor(data.data(), shape, reftype);
 	}
@@ -563,16 +784,152 @@ struct DerivativeFuncs final : public teq::iDerivativeFuncs
 	teq::TensptrT add (teq::TensptrsT elems) const override
 	{
 		assert(elems.size() > 0);
-		return make_functor(egen::ADD, elems);
+		if (false == simplify_)
+		{
+			return make_functor(egen::ADD, elems);
+		}
+		teq::TensptrsT nonzeros;
+		nonzeros.reserve(elems.size());
+		double value;
+		for (auto& elem : elems)
+		{
+			if (false == (scalar_value(value, elem) && 0 == value &&
+				same_type(*elem, *elems.front())))
+			{
+				nonzeros.push_back(elem);
+			}
+		}
+		if (nonzeros.empty())
+		{
+			return elems.front();
+		}
+		if (nonzeros.size() == 1)
+		{
+			return nonzeros.front();
+		}
+		return make_functor(egen::ADD, nonzeros);
 	}
 
 private:
+	using ScalarKeyT = std::tuple<double,egen::_GENERATED_DTYPE,std::string>;
+
+	static bool same_type (const teq::iTensor& a, const teq::iTensor& b)
+	{
+		return a.get_meta().type_code() == b.get_meta().type_code();
+	}
+
 	teq::TensptrT constant_like (float scalar, teq::TensptrT like) const
 	{
 		auto like_type = (egen::_GENERATED_DTYPE) like->get_meta().type_code();
+		if (simplify_)
+		{
+			return scalar_const(scalar, like->shape(), like_type);
+		}
 		teq::TensptrT cst = make_constant_tensor(&scalar, teq::Shape(), like_type);
 		return make_functor(::egen::EXTEND, teq::TensptrsT{cst}, (teq::TensptrT) like);
 	}
+
+	teq::TensptrT scalar_like (double scalar,
+		teq::Shape shape, teq::TensptrT like) const
+	{
+		return scalar_const(scalar, shape,
+			(egen::_GENERATED_DTYPE) like->get_meta().type_code());
+	}
+
+	/// Return scalar extended to shape, reusing a previously built
+	/// extension of the same scalar, type, and shape
+	teq::TensptrT scalar_const (double scalar,
+		teq::Shape shape, egen::_GENERATED_DTYPE dtype) const
+	{
+		ScalarKeyT key{scalar, dtype, shape.to_string()};
+		if (estd::has(scalars_, key))
+		{
+			return scalars_.at(key);
+		}
+		teq::TensptrT cst = make_constant_tensor(&scalar, teq::Shape(), dtype);
+		teq::TensptrT out = make_functor(egen::EXTEND, {cst},
+			teq::DimsT(shape.begin(), shape.end()));
+		scalars_.emplace(key, out);
+		return out;
+	}
+
+	teq::TensptrT mul (teq::TensptrT a, teq::TensptrT b) const
+	{
+		double value;
+		if (simplify_ && same_type(*a, *b))
+		{
+			if (scalar_value(value, a))
+			{
+				if (0 == value)
+				{
+					return a;
+				}
+				if (1 == value)
+				{
+					return b;
+				}
+			}
+			if (scalar_value(value, b))
+			{
+				if (0 == value)
+				{
+					return b;
+				}
+				if (1 == value)
+				{
+					return a;
+				}
+			}
+		}
+		return make_functor(egen::MUL, {a, b});
+	}
+
+	teq::TensptrT div (teq::TensptrT a, teq::TensptrT b) const
+	{
+		double value;
+		if (simplify_ && same_type(*a, *b) && (
+			(scalar_value(value, a) && 0 == value) ||
+			(scalar_value(value, b) && 1 == value)))
+		{
+			return a;
+		}
+		return make_functor(egen::DIV, {a, b});
+	}
+
+	teq::TensptrT neg (teq::TensptrT a) const
+	{
+		if (simplify_)
+		{
+			double value;
+			if (scalar_value(value, a))
+			{
+				return scalar_like(-value, a->shape(), a);
+			}
+			auto func = dynamic_cast<teq::iFunctor*>(a.get());
+			if (nullptr != func && egen::NEG == func->get_opcode().code_)
+			{
+				return func->get_args().front();
+			}
+		}
+		return make_functor(egen::NEG, {a});
+	}
+
+	/// Return reduce_grad of bwd, or constant of shape if bwd is constant
+	teq::TensptrT extend_grad (teq::Shape shape,
+		teq::TensptrT bwd, teq::FuncptrT fwd) const
+	{
+		double value;
+		if (simplify_ && scalar_value(value, bwd))
+		{
+			return scalar_like(value, shape, bwd);
+		}
+		return reduce_grad(shape, bwd, fwd);
+	}
+
+	bool simplify_;
+
+	/// Extended scalars built when simplifying
+	mutable std::map<ScalarKeyT,teq::TensptrT> scalars_;
 };
 
 }
@@ -7,28 +7,31 @@
 namespace eteq
 {
 
+/// Return child cast to type T if it is not already of type T
+template <typename T>
+teq::TensptrT cast_child (teq::TensptrT child)
+{
+	auto type = egen::get_type<T>();
+	if (child->get_meta().type_code() != type)
+	{
+		marsh::Maps attrs;
+		eigen::pack_attr(attrs, type);
+		return teq::TensptrT(Functor<T>::get(
+			egen::CAST, {child}, std::move(attrs)));
+	}
+	return child;
+}
+
 template <egen::_GENERATED_OPCODE OPCODE>
 struct TypeCaster final
 {
 	template <typename T>
 	teq::TensptrsT operator() (const teq::TensptrsT& children) const
 	{
-		auto type = egen::get_type<T>();
 		teq::TensptrsT outs;
 		outs.reserve(children.size());
 		std::transform(children.begin(), children.end(),
-		std::back_inserter(outs),
-		[&](teq::TensptrT child)
-		{
-			if (child->get_meta().type_code() != type)
-			{
-				marsh::Maps attrs;
-				eigen::pack_attr(attrs, type);
-				return teq::TensptrT(Functor<T>::get(
-					egen::CAST, {child}, std::move(attrs)));
-			}
-			return child;
-		});
+			std::back_inserter(outs), cast_child<T>);
 		return outs;
 	}
 };
@@ -43,6 +46,81 @@ struct TypeCaster<egen::CAST> final
 	}
 };
 
+/// Quantized operators convert between quantized and real types themselves
+template <>
+struct TypeCaster<egen::QUANTIZE> final
+{
+	template <typename T>
+	teq::TensptrsT operator() (const teq::TensptrsT& children) const
+	{
+		return children;
+	}
+};
+
+template <>
+struct TypeCaster<egen::QUANT_MATMUL> final
+{
+	template <typename T>
+	teq::TensptrsT operator() (const teq::TensptrsT& children) const
+	{
+		return children;
+	}
+};
+
+template <>
+struct TypeCaster<egen::QUANT_CONV2D> final
+{
+	template <typename T>
+	teq::TensptrsT operator() (const teq::TensptrsT& children) const
+	{
+		return children;
+	}
+};
+
+/// Return children cast to type T except for indices (second child)
+/// which indexing operators read in their own type
+template <typename T>
+teq::TensptrsT cast_unindexed (const teq::TensptrsT& children)
+{
+	teq::TensptrsT outs;
+	outs.reserve(children.size());
+	for (size_t i = 0, n = children.size(); i < n; ++i)
+	{
+		outs.push_back(1 == i ? children[i] : cast_child<T>(children[i]));
+	}
+	return outs;
+}
+
+template <>
+struct TypeCaster<egen::GATHER> final
+{
+	template <typename T>
+	teq::TensptrsT operator() (const teq::TensptrsT& children) const
+	{
+		return cast_unindexed<T>(children);
+	}
+};
+
+template <>
+struct TypeCaster<egen::SCATTER_ADD> final
+{
+	template <typename T>
+	teq::TensptrsT operator() (const teq::TensptrsT& children) const
+	{
+		return cast_unindexed<T>(children);
+	}
+};
+
+template <>
+struct TypeCaster<egen::SCATTER_ASSIGN_SUB> final
+{
+	template <typename T>
+	teq::TensptrsT operator() (const teq::TensptrsT& children) const
+	{
+		return cast_unindexed<T>(children);
+	}
+};
+
 }
 
 #endif // ETEQ_CASTER_HPP
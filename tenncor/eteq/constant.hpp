@@ -9,14 +9,45 @@
 #ifndef ETEQ_CONSTANT_HPP
 #define ETEQ_CONSTANT_HPP
 
+#include <optional>
+#include <string_view>
+
+#include <boost/functional/hash.hpp>
+
 #include "tenncor/eteq/etens.hpp"
 
 namespace eteq
 {
 
+/// Return hash of tensor shape, data type, and raw data
+inline size_t hash_data (const teq::iTensor& tens)
+{
+	teq::Shape shape = tens.shape();
+	const teq::iMetadata& meta = tens.get_meta();
+	size_t seed = boost::hash_range(shape.begin(), shape.end());
+	boost::hash_combine(seed, meta.type_code());
+	auto data = (const char*) tens.device().data();
+	boost::hash_combine(seed, std::hash<std::string_view>()(
+		std::string_view(data, shape.n_elems() * meta.type_size())));
+	return seed;
+}
+
+/// Leaf whose data never changes, so its content is hashed at most once
+struct iConstant : public teq::iLeaf
+{
+	virtual ~iConstant (void) = default;
+
+	/// Return hash_data of this leaf, computing it on first call
+	virtual size_t content_hash (void) const = 0;
+
+	/// Return true and set value if every element of this leaf
+	/// equals value, otherwise return false
+	virtual bool scalar_value (double& value) const = 0;
+};
+
 /// Constant implementation of Eigen leaf tensor
 template <typename T>
-struct Constant final : public teq::iLeaf
+struct Constant final : public iConstant
 {
 	/// Return Constant tensor containing first
 	/// shape.n_elems() values of data pointer
@@ -72,10 +103,31 @@ struct Constant final : public teq::iLeaf
 		return teq::IMMUTABLE;
 	}
 
+	/// Implementation of iConstant
+	size_t content_hash (void) const override
+	{
+		if (false == hash_.has_value())
+		{
+			hash_ = hash_data(*this);
+		}
+		return *hash_;
+	}
+
+	/// Implementation of iConstant
+	bool scalar_value (double& value) const override
+	{
+		if (false == is_scalar())
+		{
+			return false;
+		}
+		value = *(const T*) ref_.data();
+		return true;
+	}
+
 	/// Return true if constant data values are all the same, otherwise false
 	bool is_scalar (void) const
 	{
-		const T* data = this->data_.data();
+		const T* data = (const T*) ref_.data();
 		size_t nelems = this->shape_.n_elems();
 		return std::all_of(data + 1, data + nelems,
 			[&](const T& e) { return e == data[0]; });
@@ -100,6 +152,9 @@ private:
 
 	/// Variable metadata
 	eigen::EMetadata<T> meta_ = eigen::EMetadata<T>(1);
+
+	/// Cached content hash
+	mutable std::optional<size_t> hash_;
 };
 
 }
@@ -17,6 +17,21 @@ namespace eteq
 #define _CHOOSE_PARSER(OPCODE)\
 outshape = egen::ShapeParser<OPCODE>()(attrs, shapes);
 
+/// Return true if indexing operator reads the child at index in its own type
+inline bool is_index_child (egen::_GENERATED_OPCODE opcode, size_t index)
+{
+	switch (opcode)
+	{
+		case egen::GATHER:
+		case egen::SCATTER_ADD:
+		case egen::SCATTER_ASSIGN_SUB:
+			return 1 == index;
+		default:
+			break;
+	}
+	return false;
+}
+
 /// Functor implementation of operable functor of Eigen operators
 template <typename T>
 struct Functor final : public eigen::Observable
@@ -39,11 +54,10 @@ struct Functor final : public eigen::Observable
 			[](teq::TensptrT tens) { return tens->shape(); });
 
 		auto ctype = children.front()->get_meta().type_code();
-		for (auto it = children.begin(), et = children.end();
-			it != et; ++it)
+		for (size_t i = 0, n = children.size(); i < n; ++i)
 		{
-			auto child = *it;
-			if (ctype != child->get_meta().type_code())
+			if (ctype != children[i]->get_meta().type_code() &&
+				false == is_index_child(opcode, i))
 			{
 				global::fatal("children types are not all the same");
 			}
@@ -0,0 +1,62 @@
+///
+/// intern.hpp
+/// eteq
+///
+/// Purpose:
+/// Define opt-in table of live functors to reuse structurally
+/// identical functors as they are constructed
+///
+
+#ifndef ETEQ_INTERN_HPP
+#define ETEQ_INTERN_HPP
+
+#include "internal/eigen/eigen.hpp"
+
+namespace eteq
+{
+
+/// Table of functors keyed by opcode, output type, arguments, and attributes
+/// Functors are weakly referenced, so interned functors are still
+/// freed once the graph no longer uses them
+struct FuncInterner final
+{
+	/// Return live functor with the same opcode, output type,
+	/// argument pointers, and equal attributes, otherwise nullptr
+	teq::TensptrT find (egen::_GENERATED_OPCODE opcode, size_t dtype,
+		const teq::TensptrsT& children, const marsh::Maps& attrs);
+
+	/// Record functor to be found by later constructions
+	void add (teq::FuncptrT func);
+
+	/// Return number of referenced functors including expired ones
+	size_t size (void) const
+	{
+		return nrefs_;
+	}
+
+	/// Remove references of freed functors
+	void sweep (void);
+
+private:
+	std::unordered_map<size_t,std::vector<teq::TensrefT>> funcs_;
+
+	size_t nrefs_ = 0;
+
+	/// Number of references at which next sweep occurs
+	size_t sweep_limit_ = 1024;
+};
+
+/// Return true if opcode can be interned, false if functors of opcode
+/// must stay distinct, such as random or assignment operators
+bool can_intern (egen::_GENERATED_OPCODE opcode);
+
+/// Set interner of context, passing nullptr disables interning
+void set_interner (FuncInterner* interner,
+	global::CfgMapptrT ctx = global::context());
+
+/// Return interner of context or nullptr if interning is disabled
+FuncInterner* get_interner (const global::CfgMapptrT& ctx = global::context());
+
+}
+
+#endif // ETEQ_INTERN_HPP
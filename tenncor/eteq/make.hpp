@@ -5,7 +5,9 @@
 #include "tenncor/eteq/constant.hpp"
 #include "tenncor/eteq/functor.hpp"
 #include "tenncor/eteq/evars.hpp"
+#include "tenncor/eteq/sparse.hpp"
 #include "tenncor/eteq/caster.hpp"
+#include "tenncor/eteq/intern.hpp"
 
 namespace eteq
 {
@@ -33,7 +35,7 @@ EVariable<T> make_variable (teq::Shape shape,
 	std::string label = "",
 	const global::CfgMapptrT& ctx = global::context())
 {
-	return make_variable_scalar<T>(0, shape, label, ctx);
+	return make_variable_scalar<T>((T) 0, shape, label, ctx);
 }
 
 /// Return variable node filled with scalar matching link shape
@@ -56,7 +58,8 @@ EVariable<T> make_variable (T* data, teq::Shape shape,
 }
 
 teq::TensptrT make_funcattr (egen::_GENERATED_OPCODE opcode,
-	teq::TensptrsT children, marsh::Maps& attrs);
+	teq::TensptrsT children, marsh::Maps& attrs,
+	const global::CfgMapptrT& ctx = global::context());
 
 #define _CHOOSE_FUNCOPT(OPCODE)\
 redundant = egen::FuncOpt<OPCODE>().operator()<T>(attrs, children);
@@ -64,9 +67,12 @@ redundant = egen::FuncOpt<OPCODE>().operator()<T>(attrs, children);
 #define _CHOOSE_TYPECAST(OPCODE)\
 children = TypeCaster<OPCODE>().operator()<T>(children);
 
+/// Return functor of type T, reusing an identical live functor
+/// if context has an interner
 template <typename T>
 teq::TensptrT make_tfuncattr (egen::_GENERATED_OPCODE opcode,
-	teq::TensptrsT children, marsh::Maps& attrs)
+	teq::TensptrsT children, marsh::Maps& attrs,
+	const global::CfgMapptrT& ctx = global::context())
 {
 	if (children.empty())
 	{
@@ -81,7 +87,19 @@ teq::TensptrT make_tfuncattr (egen::_GENERATED_OPCODE opcode,
 		return children.front();
 	}
 	OPCODE_LOOKUP(_CHOOSE_TYPECAST, opcode)
-	return teq::TensptrT(Functor<T>::get(opcode, children, std::move(attrs)));
+	FuncInterner* interner = get_interner(ctx);
+	if (nullptr == interner || false == can_intern(opcode))
+	{
+		return teq::TensptrT(Functor<T>::get(opcode, children, std::move(attrs)));
+	}
+	size_t dtype = egen::get_type<T>();
+	if (auto found = interner->find(opcode, dtype, children, attrs))
+	{
+		return found;
+	}
+	teq::FuncptrT out(Functor<T>::get(opcode, children, std::move(attrs)));
+	interner->add(out);
+	return out;
 }
 
 #undef _CHOOSE_FUNCOPT
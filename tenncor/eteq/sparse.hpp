@@ -0,0 +1,179 @@
+///
+/// sparse.hpp
+/// eteq
+///
+/// Purpose:
+/// Define mutable sparse matrix leaves
+///
+
+#ifndef ETEQ_SPARSE_HPP
+#define ETEQ_SPARSE_HPP
+
+#include "tenncor/eteq/evars.hpp"
+
+namespace eteq
+{
+
+/// Leaf node implementation containing mutable CSR matrix data
+/// of teq shape [ncols,nrows]
+template <typename T>
+struct SparseVariable final : public eigen::iSparseMatrix<T>
+{
+	/// Return SparseVariable of sparse matrix
+	static SparseVariable<T>* get (eigen::SparseMatT<T> sparse,
+		std::string label = "", teq::Usage usage = teq::VARUSAGE)
+	{
+		return new SparseVariable<T>(std::move(sparse), label, usage);
+	}
+
+	/// Return deep copy of this SparseVariable
+	SparseVariable<T>* clone (void) const
+	{
+		return static_cast<SparseVariable<T>*>(clone_impl());
+	}
+
+	SparseVariable<T>& operator = (const SparseVariable<T>& other) = delete;
+
+	SparseVariable<T>& operator = (SparseVariable<T>&& other) = delete;
+
+	void assign (eigen::SparseMatT<T> sparse,
+		const global::CfgMapptrT& ctx = global::context())
+	{
+		if (sparse.rows() != this->shape_.at(1) ||
+			sparse.cols() != this->shape_.at(0))
+		{
+			global::fatalf("assigning %d by %d sparse matrix to tensor %s",
+				sparse.rows(), sparse.cols(), this->shape_.to_string().c_str());
+		}
+		size_t last_version = get_lastvers(ctx);
+		upversion(last_version + 1);
+		this->ref_.assign(std::move(sparse));
+	}
+
+	/// Implementation of iSparseMatrix<T>
+	const eigen::SparseMatT<T>& sparse (void) const override
+	{
+		return ref_.sparse();
+	}
+
+	/// Implementation of iTensor
+	teq::Shape shape (void) const override
+	{
+		return shape_;
+	}
+
+	/// Implementation of iTensor
+	teq::iDeviceRef& device (void) override
+	{
+		return ref_;
+	}
+
+	/// Implementation of iTensor
+	const teq::iDeviceRef& device (void) const override
+	{
+		return ref_;
+	}
+
+	/// Implementation of iTensor
+	const teq::iMetadata& get_meta (void) const override
+	{
+		return meta_;
+	}
+
+	/// Implementation of iTensor
+	std::string to_string (void) const override
+	{
+		return label_;
+	}
+
+	/// Implementation of iLeaf
+	teq::Usage get_usage (void) const override
+	{
+		return usage_;
+	}
+
+	/// Implementation of iMutableLeaf
+	void upversion (size_t version) override
+	{
+		meta_.version_ = std::max(meta_.version_, version);
+	}
+
+private:
+	SparseVariable (eigen::SparseMatT<T> sparse,
+		std::string label, teq::Usage usage) :
+		shape_(teq::DimsT{(teq::DimT) sparse.cols(), (teq::DimT) sparse.rows()}),
+		ref_(std::move(sparse)), label_(label), usage_(usage) {}
+
+	SparseVariable (const SparseVariable<T>& other) = default;
+
+	teq::iTensor* clone_impl (void) const override
+	{
+		return new SparseVariable<T>(*this);
+	}
+
+	/// Shape of the dense equivalent
+	teq::Shape shape_;
+
+	/// Data Source
+	eigen::SparseRef<T> ref_;
+
+	/// Variable metadata
+	eigen::EMetadata<T> meta_ = eigen::EMetadata<T>(1);
+
+	/// Label for distinguishing variable nodes
+	std::string label_;
+
+	teq::Usage usage_;
+};
+
+/// Smart pointer of sparse variable nodes to preserve assign functions
+template <typename T>
+using SparseVarptrT = std::shared_ptr<SparseVariable<T>>;
+
+template <typename T>
+struct ESparseVariable final : public ETensor
+{
+	ESparseVariable (void) = default;
+
+	ESparseVariable (SparseVarptrT<T> vars,
+		const global::CfgMapptrT& ctx = global::context()) :
+		ETensor(vars, ctx) {}
+
+	operator SparseVarptrT<T>() const
+	{
+		return std::static_pointer_cast<SparseVariable<T>>(teq::TensptrT(*this));
+	}
+
+	SparseVariable<T>* operator-> () const
+	{
+		return static_cast<SparseVariable<T>*>(this->get());
+	}
+};
+
+/// Return sparse variable node of teq shape [ncols,nrows] given
+/// compressed sparse row values (see eigen::csr_matrix)
+template <typename T>
+ESparseVariable<T> make_csr_variable (teq::Shape shape,
+	const std::vector<size_t>& rowptrs, const std::vector<size_t>& colidx,
+	const std::vector<T>& values, std::string label = "",
+	const global::CfgMapptrT& ctx = global::context())
+{
+	return ESparseVariable<T>(SparseVarptrT<T>(SparseVariable<T>::get(
+		eigen::csr_matrix<T>(shape, rowptrs, colidx, values), label)), ctx);
+}
+
+/// Return sparse variable node of teq shape [ncols,nrows] given
+/// coordinate values (see eigen::coo_matrix)
+template <typename T>
+ESparseVariable<T> make_coo_variable (teq::Shape shape,
+	const std::vector<size_t>& rows, const std::vector<size_t>& cols,
+	const std::vector<T>& values, std::string label = "",
+	const global::CfgMapptrT& ctx = global::context())
+{
+	return ESparseVariable<T>(SparseVarptrT<T>(SparseVariable<T>::get(
+		eigen::coo_matrix<T>(shape, rows, cols, values), label)), ctx);
+}
+
+}
+
+#endif // ETEQ_SPARSE_HPP
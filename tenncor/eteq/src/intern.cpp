@@ -0,0 +1,133 @@
+#include <boost/functional/hash.hpp>
+
+#include "tenncor/eteq/intern.hpp"
+
+#ifdef ETEQ_INTERN_HPP
+
+namespace eteq
+{
+
+const std::string intern_key = "functor_interner";
+
+static size_t hash_func (size_t opcode, size_t dtype,
+	const teq::TensptrsT& children, const types::StringsT& attr_keys)
+{
+	size_t seed = 0;
+	boost::hash_combine(seed, opcode);
+	boost::hash_combine(seed, dtype);
+	for (const teq::TensptrT& child : children)
+	{
+		boost::hash_combine(seed, child.get());
+	}
+	for (const std::string& key : attr_keys)
+	{
+		boost::hash_combine(seed, key);
+	}
+	return seed;
+}
+
+static bool func_equals (const teq::iFunctor& func,
+	egen::_GENERATED_OPCODE opcode, size_t dtype,
+	const teq::TensptrsT& children, const marsh::Maps& attrs)
+{
+	if ((size_t) opcode != func.get_opcode().code_ ||
+		dtype != func.get_meta().type_code() ||
+		attrs.size() != func.size())
+	{
+		return false;
+	}
+	auto args = func.get_args();
+	if (args != children)
+	{
+		return false;
+	}
+	auto keys = attrs.ls_attrs();
+	return std::all_of(keys.begin(), keys.end(),
+		[&](const std::string& key)
+		{
+			auto attr = func.get_attr(key);
+			return nullptr != attr && attr->equals(*attrs.get_attr(key));
+		});
+}
+
+teq::TensptrT FuncInterner::find (egen::_GENERATED_OPCODE opcode,
+	size_t dtype, const teq::TensptrsT& children, const marsh::Maps& attrs)
+{
+	auto it = funcs_.find(hash_func(opcode, dtype, children, attrs.ls_attrs()));
+	if (funcs_.end() == it)
+	{
+		return nullptr;
+	}
+	for (teq::TensrefT& ref : it->second)
+	{
+		if (auto tens = ref.lock())
+		{
+			// functors can be updated after construction, so compare contents
+			auto func = static_cast<teq::iFunctor*>(tens.get());
+			if (func_equals(*func, opcode, dtype, children, attrs))
+			{
+				return tens;
+			}
+		}
+	}
+	return nullptr;
+}
+
+void FuncInterner::add (teq::FuncptrT func)
+{
+	size_t key = hash_func(func->get_opcode().code_,
+		func->get_meta().type_code(), func->get_args(), func->ls_attrs());
+	funcs_[key].push_back(func);
+	if (++nrefs_ >= sweep_limit_)
+	{
+		sweep();
+		// amortize sweeps over at least as many insertions as live functors
+		sweep_limit_ = std::max<size_t>(1024, 2 * nrefs_);
+	}
+}
+
+void FuncInterner::sweep (void)
+{
+	nrefs_ = 0;
+	for (auto it = funcs_.begin(); it != funcs_.end();)
+	{
+		estd::remove_if(it->second,
+			[](const teq::TensrefT& ref)
+			{
+				return ref.expired();
+			});
+		if (it->second.empty())
+		{
+			it = funcs_.erase(it);
+		}
+		else
+		{
+			nrefs_ += it->second.size();
+			++it;
+		}
+	}
+}
+
+bool can_intern (egen::_GENERATED_OPCODE opcode)
+{
+	return egen::is_idempotent(opcode) && egen::ASSIGN != opcode;
+}
+
+void set_interner (FuncInterner* interner, global::CfgMapptrT ctx)
+{
+	ctx->rm_entry(intern_key);
+	if (nullptr != interner)
+	{
+		ctx->template add_entry<FuncInterner>(intern_key,
+			[=]{ return interner; });
+	}
+}
+
+FuncInterner* get_interner (const global::CfgMapptrT& ctx)
+{
+	return static_cast<FuncInterner*>(ctx->get_obj(intern_key));
+}
+
+}
+
+#endif
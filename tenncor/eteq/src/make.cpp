@@ -9,10 +9,11 @@ namespace eteq
 typecode = egen::TypeParser<OPCODE>()(attrs, dtypes);
 
 #define _CHOOSE_FUNCTYPE(REALTYPE)\
-out = make_tfuncattr<REALTYPE>(opcode, children, attrs);
+out = make_tfuncattr<REALTYPE>(opcode, children, attrs, ctx);
 
 teq::TensptrT make_funcattr (egen::_GENERATED_OPCODE opcode,
-	teq::TensptrsT children, marsh::Maps& attrs)
+	teq::TensptrsT children, marsh::Maps& attrs,
+	const global::CfgMapptrT& ctx)
 {
 	teq::TensptrT out;
 	egen::_GENERATED_DTYPE typecode = egen::BAD_TYPE;
@@ -2,6 +2,8 @@
 #ifndef DISABLE_ETEQ_BACKPROP_TEST
 
 
+#include <chrono>
+
 #include "gtest/gtest.h"
 
 #include "testutil/tutil.hpp"
@@ -364,6 +366,67 @@ TEST(BACKPROP, ReduceMinMax)
 }
 
 
+TEST(BACKPROP, Softmax)
+{
+	eteq::DerivativeFuncs der;
+
+	std::vector<double> data{1, 2, 3, 4, 5, 6};
+	MockDeviceRef devref;
+	MockMeta mockmeta;
+	auto super = make_var(data.data(), devref, teq::Shape({3,2}), "super");
+	auto arg = make_var(data.data(), devref, teq::Shape({3,2}), "arg1");
+	EXPECT_CALL(*super, get_meta()).WillRepeatedly(ReturnRef(mockmeta));
+	EXPECT_CALL(*arg, get_meta()).WillRepeatedly(ReturnRef(mockmeta));
+	EXPECT_CALL(mockmeta, type_code()).WillRepeatedly(Return(egen::DOUBLE));
+	EXPECT_CALL(mockmeta, type_label()).WillRepeatedly(Return("DOUBLE"));
+	auto op = eteq::make_functor(egen::SOFTMAX,teq::TensptrsT{arg},std::set<teq::RankT>{0});
+
+	auto result = der.lderive(std::dynamic_pointer_cast<teq::iFunctor>(op), super, 0);
+	EXPECT_GRAPHEQ(
+		"(MUL<DOUBLE>[3\\2\\1\\1\\1\\1\\1\\1])\n"
+		"_`--(SOFTMAX<DOUBLE>[3\\2\\1\\1\\1\\1\\1\\1])\n"
+		"_|___`--(constant:arg1<DOUBLE>[3\\2\\1\\1\\1\\1\\1\\1])\n"
+		"_`--(SUB<DOUBLE>[3\\2\\1\\1\\1\\1\\1\\1])\n"
+		"_____`--(constant:super<DOUBLE>[3\\2\\1\\1\\1\\1\\1\\1])\n"
+		"_____`--(EXTEND<DOUBLE>[3\\2\\1\\1\\1\\1\\1\\1])\n"
+		"_________`--(REDUCE_SUM<DOUBLE>[1\\2\\1\\1\\1\\1\\1\\1])\n"
+		"_____________`--(MUL<DOUBLE>[3\\2\\1\\1\\1\\1\\1\\1])\n"
+		"_________________`--(constant:super<DOUBLE>[3\\2\\1\\1\\1\\1\\1\\1])\n"
+		"_________________`--(SOFTMAX<DOUBLE>[3\\2\\1\\1\\1\\1\\1\\1])\n"
+		"_____________________`--(constant:arg1<DOUBLE>[3\\2\\1\\1\\1\\1\\1\\1])\n", result);
+}
+
+
+TEST(BACKPROP, SoftmaxCrossEntropy)
+{
+	eteq::DerivativeFuncs der;
+
+	std::vector<double> data{1, 2, 3, 4, 5, 6};
+	MockDeviceRef devref;
+	MockMeta mockmeta;
+	auto super = make_var(data.data(), devref, teq::Shape({1,2}), "super");
+	auto arg = make_var(data.data(), devref, teq::Shape({3,2}), "arg1");
+	auto arg2 = make_var(data.data(), devref, teq::Shape({3,2}), "arg2");
+	EXPECT_CALL(*super, get_meta()).WillRepeatedly(ReturnRef(mockmeta));
+	EXPECT_CALL(*arg, get_meta()).WillRepeatedly(ReturnRef(mockmeta));
+	EXPECT_CALL(*arg2, get_meta()).WillRepeatedly(ReturnRef(mockmeta));
+	EXPECT_CALL(mockmeta, type_code()).WillRepeatedly(Return(egen::DOUBLE));
+	EXPECT_CALL(mockmeta, type_label()).WillRepeatedly(Return("DOUBLE"));
+	auto op = eteq::make_functor(egen::SOFTMAX_CROSS_ENTROPY,
+		teq::TensptrsT{arg,arg2},std::set<teq::RankT>{0});
+
+	auto result = der.lderive(std::dynamic_pointer_cast<teq::iFunctor>(op), super, 1);
+	EXPECT_GRAPHEQ(
+		"(MUL<DOUBLE>[3\\2\\1\\1\\1\\1\\1\\1])\n"
+		"_`--(SUB<DOUBLE>[3\\2\\1\\1\\1\\1\\1\\1])\n"
+		"_|___`--(SOFTMAX<DOUBLE>[3\\2\\1\\1\\1\\1\\1\\1])\n"
+		"_|___|___`--(constant:arg2<DOUBLE>[3\\2\\1\\1\\1\\1\\1\\1])\n"
+		"_|___`--(constant:arg1<DOUBLE>[3\\2\\1\\1\\1\\1\\1\\1])\n"
+		"_`--(EXTEND<DOUBLE>[3\\2\\1\\1\\1\\1\\1\\1])\n"
+		"_____`--(constant:super<DOUBLE>[1\\2\\1\\1\\1\\1\\1\\1])\n", result);
+}
+
+
 TEST(BACKPROP, Extend)
 {
 	eteq::DerivativeFuncs der;
@@ -485,6 +548,37 @@ TEST(BACKPROP, Conv)
 }
 
 
+TEST(BACKPROP, Conv2d)
+{
+	eteq::DerivativeFuncs der;
+
+	std::vector<double> data(24, 1);
+	MockDeviceRef devref;
+	MockMeta mockmeta;
+	auto super = make_var(data.data(), devref, teq::Shape({2,2,1,1}), "super");
+	auto arg = make_var(data.data(), devref, teq::Shape({3,3,2,1}), "arg1");
+	auto arg2 = make_var(data.data(), devref, teq::Shape({2,3,2,2}), "arg2");
+	EXPECT_CALL(*super, get_meta()).WillRepeatedly(ReturnRef(mockmeta));
+	EXPECT_CALL(*arg, get_meta()).WillRepeatedly(ReturnRef(mockmeta));
+	EXPECT_CALL(*arg2, get_meta()).WillRepeatedly(ReturnRef(mockmeta));
+	EXPECT_CALL(mockmeta, type_code()).WillRepeatedly(Return(egen::DOUBLE));
+	EXPECT_CALL(mockmeta, type_label()).WillRepeatedly(Return("DOUBLE"));
+	auto op = eteq::make_functor(egen::CONV2D, teq::TensptrsT{arg, arg2});
+	auto f = std::dynamic_pointer_cast<teq::iFunctor>(op);
+
+	auto result = der.lderive(f, super, 0);
+	EXPECT_GRAPHEQ(
+		"(CONV2D_IMAGE_GRAD<DOUBLE>[3\\3\\2\\1\\1\\1\\1\\1])\n"
+		"_`--(constant:arg2<DOUBLE>[2\\3\\2\\2\\1\\1\\1\\1])\n"
+		"_`--(constant:super<DOUBLE>[2\\2\\1\\1\\1\\1\\1\\1])\n", result);
+
+	auto result2 = der.lderive(f, super, 1);
+	EXPECT_GRAPHEQ(
+		"(CONV2D_KERNEL_GRAD<DOUBLE>[2\\3\\2\\2\\1\\1\\1\\1])\n"
+		"_`--(constant:arg1<DOUBLE>[3\\3\\2\\1\\1\\1\\1\\1])\n"
+		"_`--(constant:super<DOUBLE>[2\\2\\1\\1\\1\\1\\1\\1])\n", result2);
+}
+
 TEST(BACKPROP, Slice)
 {
 	eteq::DerivativeFuncs der;
@@ -600,6 +694,55 @@ TEST(BACKPROP, Scatter)
 }
 
 
+TEST(BACKPROP, MaxPool)
+{
+	eteq::DerivativeFuncs der;
+
+	std::vector<double> data{1, 2, 3, 4, 5, 6, 1, 2, 3, 4, 5, 6};
+	MockDeviceRef devref;
+	MockMeta mockmeta;
+	auto super = make_var(data.data(), devref, teq::Shape({2,1}), "super");
+	auto arg = make_var(data.data(), devref, teq::Shape({4,3}), "arg1");
+	EXPECT_CALL(*super, get_meta()).WillRepeatedly(ReturnRef(mockmeta));
+	EXPECT_CALL(*arg, get_meta()).WillRepeatedly(ReturnRef(mockmeta));
+	EXPECT_CALL(mockmeta, type_code()).WillRepeatedly(Return(egen::DOUBLE));
+	EXPECT_CALL(mockmeta, type_label()).WillRepeatedly(Return("DOUBLE"));
+	auto op = eteq::make_functor(egen::MAX_POOL, teq::TensptrsT{arg},
+		eigen::PairVecT<teq::DimT>{{2, 2}, {2, 2}});
+
+	auto result = der.lderive(std::dynamic_pointer_cast<teq::iFunctor>(op), super, 0);
+	EXPECT_GRAPHEQ(
+		"(MAX_POOL_GRAD<DOUBLE>[4\\3\\1\\1\\1\\1\\1\\1])\n"
+		"_`--(constant:arg1<DOUBLE>[4\\3\\1\\1\\1\\1\\1\\1])\n"
+		"_`--(MAX_POOL<DOUBLE>[2\\1\\1\\1\\1\\1\\1\\1])\n"
+		"_|___`--(constant:arg1<DOUBLE>[4\\3\\1\\1\\1\\1\\1\\1])\n"
+		"_`--(constant:super<DOUBLE>[2\\1\\1\\1\\1\\1\\1\\1])\n", result);
+}
+
+
+TEST(BACKPROP, AvgPool)
+{
+	eteq::DerivativeFuncs der;
+
+	std::vector<double> data{1, 2, 3, 4, 5, 6, 1, 2, 3, 4, 5, 6};
+	MockDeviceRef devref;
+	MockMeta mockmeta;
+	auto super = make_var(data.data(), devref, teq::Shape({2,1}), "super");
+	auto arg = make_var(data.data(), devref, teq::Shape({4,3}), "arg1");
+	EXPECT_CALL(*super, get_meta()).WillRepeatedly(ReturnRef(mockmeta));
+	EXPECT_CALL(*arg, get_meta()).WillRepeatedly(ReturnRef(mockmeta));
+	EXPECT_CALL(mockmeta, type_code()).WillRepeatedly(Return(egen::DOUBLE));
+	EXPECT_CALL(mockmeta, type_label()).WillRepeatedly(Return("DOUBLE"));
+	auto op = eteq::make_functor(egen::AVG_POOL, teq::TensptrsT{arg},
+		eigen::PairVecT<teq::DimT>{{2, 2}, {2, 2}});
+
+	auto result = der.lderive(std::dynamic_pointer_cast<teq::iFunctor>(op), super, 0);
+	EXPECT_GRAPHEQ(
+		"(AVG_POOL_GRAD<DOUBLE>[4\\3\\1\\1\\1\\1\\1\\1])\n"
+		"_`--(constant:super<DOUBLE>[2\\1\\1\\1\\1\\1\\1\\1])\n", result);
+}
+
+
 TEST(BACKPROP, Reverse)
 {
 	eteq::DerivativeFuncs der;
@@ -770,4 +913,148 @@ TEST(BACKPROP, AddHelper)
 }
 
 
+
+static size_t count_nodes (const teq::TensptrsT& roots)
+{
+	teq::GraphStat stat;
+	teq::multi_visit(stat, roots);
+	return stat.graphsize_.size();
+}
+
+
+static std::vector<double> calc_data (const teq::TensptrT& tens)
+{
+	double* ptr = eteq::ETensor(tens).calc<double>();
+	return std::vector<double>(ptr, ptr + tens->shape().n_elems());
+}
+
+
+TEST(BACKPROP, Simplify)
+{
+	eteq::DerivativeFuncs der(true);
+
+	teq::Shape shape({3, 2});
+	std::vector<double> data{1, 2, 3, 4, 5, 6};
+	teq::TensptrT x = eteq::make_variable<double>(data.data(), shape, "x");
+
+	// one propagates through reductions and negations as a constant
+	teq::TensptrT root(eteq::make_functor(egen::REDUCE_SUM, {
+		eteq::make_functor(egen::NEG, {
+			eteq::make_functor(egen::NEG, {x})})},
+		std::set<teq::RankT>{0, 1}));
+	auto grads = teq::derive(root, {x}, der);
+	ASSERT_EQ(1, grads.size());
+	EXPECT_GRAPHEQ(
+		"(EXTEND<DOUBLE>[3\\2\\1\\1\\1\\1\\1\\1])\n"
+		"_`--(constant:1<DOUBLE>[1\\1\\1\\1\\1\\1\\1\\1])\n", grads.front());
+
+	// multiplying by one is skipped
+	teq::TensptrT sig(eteq::make_functor(egen::SIGMOID, {x}));
+	grads = teq::derive(sig, {x}, der);
+	ASSERT_EQ(1, grads.size());
+	EXPECT_GRAPHEQ(
+		"(MUL<DOUBLE>[3\\2\\1\\1\\1\\1\\1\\1])\n"
+		"_`--(SIGMOID<DOUBLE>[3\\2\\1\\1\\1\\1\\1\\1])\n"
+		"_|___`--(variable:x<DOUBLE>[3\\2\\1\\1\\1\\1\\1\\1])\n"
+		"_`--(SUB<DOUBLE>[3\\2\\1\\1\\1\\1\\1\\1])\n"
+		"_____`--(EXTEND<DOUBLE>[3\\2\\1\\1\\1\\1\\1\\1])\n"
+		"_____|___`--(constant:1<DOUBLE>[1\\1\\1\\1\\1\\1\\1\\1])\n"
+		"_____`--(SIGMOID<DOUBLE>[3\\2\\1\\1\\1\\1\\1\\1])\n"
+		"_________`--(variable:x<DOUBLE>[3\\2\\1\\1\\1\\1\\1\\1])\n", grads.front());
+
+	// constants of the same value, type, and shape are shared
+	EXPECT_EQ(der.get_const_one(*x), der.get_const_one(*sig));
+	EXPECT_NE(der.get_const_one(*x), der.get_const_zero(*x));
+}
+
+
+TEST(BACKPROP, SimplifyBenchmark)
+{
+	teq::Shape xshape({4, 3});
+	teq::Shape w0shape({6, 4});
+	teq::Shape b0shape({6});
+	teq::Shape w1shape({2, 6});
+	teq::Shape yshape({2, 3});
+	std::vector<double> xdata(xshape.n_elems());
+	std::vector<double> w0data(w0shape.n_elems());
+	std::vector<double> b0data(b0shape.n_elems());
+	std::vector<double> w1data(w1shape.n_elems());
+	std::vector<double> ydata(yshape.n_elems());
+	for (auto vec : {&xdata, &w0data, &b0data, &w1data, &ydata})
+	{
+		for (size_t i = 0, n = vec->size(); i < n; ++i)
+		{
+			(*vec)[i] = ((i * 7 + vec->size()) % 11) / 11. - 0.5;
+		}
+	}
+	teq::TensptrT x = eteq::make_variable<double>(xdata.data(), xshape, "x");
+	teq::TensptrT w0 = eteq::make_variable<double>(w0data.data(), w0shape, "w0");
+	teq::TensptrT b0 = eteq::make_variable<double>(b0data.data(), b0shape, "b0");
+	teq::TensptrT w1 = eteq::make_variable<double>(w1data.data(), w1shape, "w1");
+	teq::TensptrT y = eteq::make_constant<double>(ydata.data(), yshape);
+
+	teq::TensptrT hidden(eteq::make_functor(egen::SIGMOID, {
+		eteq::make_functor(egen::ADD, {
+			eteq::make_functor(egen::MATMUL, {x, w0}),
+			eteq::make_functor(egen::EXTEND, {b0}, teq::DimsT{1, 3}),
+		})
+	}));
+	teq::TensptrT out(eteq::make_functor(egen::TANH, {
+		eteq::make_functor(egen::MATMUL, {hidden, w1})}));
+	teq::TensptrT err(eteq::make_functor(egen::REDUCE_SUM, {
+		eteq::make_functor(egen::SQUARE, {
+			eteq::make_functor(egen::SUB, {out, y})})},
+		std::set<teq::RankT>{0, 1}));
+	teq::TensptrsT targets = {w0, b0, w1};
+
+	auto plain = teq::derive(err, targets, eteq::DerivativeFuncs());
+	auto simple = teq::derive(err, targets, eteq::DerivativeFuncs(true));
+	ASSERT_EQ(targets.size(), plain.size());
+	ASSERT_EQ(targets.size(), simple.size());
+
+	size_t nplain = count_nodes(plain);
+	size_t nsimple = count_nodes(simple);
+	EXPECT_LT(nsimple, nplain);
+	for (size_t i = 0, n = targets.size(); i < n; ++i)
+	{
+		EXPECT_TRUE(plain[i]->shape().compatible_after(simple[i]->shape(), 0));
+		auto expect = calc_data(plain[i]);
+		auto got = calc_data(simple[i]);
+		ASSERT_EQ(expect.size(), got.size());
+		for (size_t j = 0, m = expect.size(); j < m; ++j)
+		{
+			EXPECT_DOUBLE_EQ(expect[j], got[j]);
+		}
+	}
+
+	const size_t nreps = 200;
+	auto start = std::chrono::steady_clock::now();
+	for (size_t rep = 0; rep < nreps; ++rep)
+	{
+		for (auto& grad : plain)
+		{
+			eteq::ETensor(grad).calc<double>();
+		}
+	}
+	auto plain_time = std::chrono::steady_clock::now() - start;
+
+	start = std::chrono::steady_clock::now();
+	for (size_t rep = 0; rep < nreps; ++rep)
+	{
+		for (auto& grad : simple)
+		{
+			eteq::ETensor(grad).calc<double>();
+		}
+	}
+	auto simple_time = std::chrono::steady_clock::now() - start;
+
+	using Micros = std::chrono::microseconds;
+	std::cout << "[ BENCHMARK] mlp gradients x " << nreps << " reps: plain "
+		<< nplain << " nodes in "
+		<< std::chrono::duration_cast<Micros>(plain_time).count()
+		<< "us, simplified " << nsimple << " nodes in "
+		<< std::chrono::duration_cast<Micros>(simple_time).count() << "us\n";
+}
+
+
 #endif // DISABLE_ETEQ_BACKPROP_TEST
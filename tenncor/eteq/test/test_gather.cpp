@@ -0,0 +1,160 @@
+
+#ifndef DISABLE_ETEQ_GATHER_TEST
+
+
+#include "gtest/gtest.h"
+
+#include "testutil/tutil.hpp"
+
+#include "tenncor/eteq/eteq.hpp"
+#include "tenncor/eteq/make.hpp"
+
+
+static std::vector<float> calc_data (eteq::ETensor tens)
+{
+	float* ptr = tens.calc<float>();
+	return std::vector<float>(ptr, ptr + tens->shape().n_elems());
+}
+
+
+static const std::vector<float> table = {
+	1, 2, 3,
+	4, 5, 6,
+	7, 8, 9,
+	10, 11, 12,
+	13, 14, 15,
+};
+
+
+TEST(GATHER, Rows)
+{
+	teq::Shape tshape({3, 5});
+	std::vector<int32_t> idata = {4, 1, 1, 0};
+	auto params = eteq::make_constant<float>((float*) table.data(), tshape);
+	auto indices = eteq::make_constant<int32_t>(idata.data(), teq::Shape({4}));
+
+	eteq::ETensor out(eteq::make_functor(egen::GATHER,
+		{params, indices}, (teq::RankT) 1));
+	EXPECT_ARREQ(teq::Shape({3, 4}), out->shape());
+	EXPECT_EQ(egen::FLOAT, out->get_meta().type_code());
+	// indices are read in their own type
+	auto func = dynamic_cast<teq::iFunctor*>(out.get());
+	ASSERT_NE(nullptr, func);
+	EXPECT_EQ(indices.get(), func->get_args()[1].get());
+
+	std::vector<float> expect = {
+		13, 14, 15,
+		4, 5, 6,
+		4, 5, 6,
+		1, 2, 3,
+	};
+	EXPECT_VECEQ(expect, calc_data(out));
+}
+
+
+TEST(GATHER, Columns)
+{
+	teq::Shape tshape({3, 5});
+	std::vector<float> idata = {2, 0};
+	auto params = eteq::make_constant<float>((float*) table.data(), tshape);
+	auto indices = eteq::make_constant<float>(idata.data(), teq::Shape({2}));
+
+	eteq::ETensor out(eteq::make_functor(egen::GATHER,
+		{params, indices}, (teq::RankT) 0));
+	EXPECT_ARREQ(teq::Shape({2, 5}), out->shape());
+	std::vector<float> expect = {
+		3, 1,
+		6, 4,
+		9, 7,
+		12, 10,
+		15, 13,
+	};
+	EXPECT_VECEQ(expect, calc_data(out));
+}
+
+
+TEST(GATHER, ScatterAdd)
+{
+	teq::Shape ushape({2, 3});
+	std::vector<float> udata = {
+		1, 2,
+		3, 4,
+		5, 6,
+	};
+	std::vector<int32_t> idata = {2, 0, 2};
+	auto updates = eteq::make_constant<float>(udata.data(), ushape);
+	auto indices = eteq::make_constant<int32_t>(idata.data(), teq::Shape({3}));
+
+	eteq::ETensor out(eteq::make_functor(egen::SCATTER_ADD,
+		{updates, indices}, (teq::RankT) 1, teq::Shape({2, 4})));
+	EXPECT_ARREQ(teq::Shape({2, 4}), out->shape());
+	std::vector<float> expect = {
+		3, 4,
+		0, 0,
+		6, 8,
+		0, 0,
+	};
+	EXPECT_VECEQ(expect, calc_data(out));
+}
+
+
+TEST(GATHER, Gradient)
+{
+	teq::Shape tshape({3, 5});
+	std::vector<int32_t> idata = {4, 1, 1};
+	auto params = eteq::make_variable<float>((float*) table.data(), tshape, "params");
+	auto indices = eteq::make_constant<int32_t>(idata.data(), teq::Shape({3}));
+
+	teq::TensptrT root = eteq::make_functor(egen::GATHER,
+		{params, indices}, (teq::RankT) 1);
+	eteq::DerivativeFuncs builder;
+	auto ders = teq::derive(root, {params}, builder);
+	ASSERT_EQ(1, ders.size());
+
+	// gradient only accumulates into gathered rows
+	auto func = dynamic_cast<teq::iFunctor*>(ders.front().get());
+	ASSERT_NE(nullptr, func);
+	EXPECT_EQ(egen::SCATTER_ADD, func->get_opcode().code_);
+	eteq::ETensor der(ders.front());
+	EXPECT_ARREQ(tshape, der->shape());
+	std::vector<float> expect = {
+		0, 0, 0,
+		2, 2, 2,
+		0, 0, 0,
+		0, 0, 0,
+		1, 1, 1,
+	};
+	EXPECT_VECEQ(expect, calc_data(der));
+}
+
+
+TEST(GATHER, ScatterAssignSub)
+{
+	teq::Shape tshape({3, 5});
+	std::vector<float> sdata = {
+		1, 1, 1,
+		2, 0, 2,
+		1, 2, 3,
+	};
+	std::vector<int32_t> idata = {4, 1, 4};
+	auto target = eteq::make_variable<float>((float*) table.data(), tshape, "target");
+	auto indices = eteq::make_constant<int32_t>(idata.data(), teq::Shape({3}));
+	auto source = eteq::make_constant<float>(sdata.data(), teq::Shape({3, 3}));
+
+	eteq::ETensor update(eteq::make_functor(egen::SCATTER_ASSIGN_SUB,
+		{target, indices, source}, (teq::RankT) 1));
+	EXPECT_ARREQ(tshape, update->shape());
+	std::vector<float> expect = {
+		1, 2, 3,
+		2, 5, 4,
+		7, 8, 9,
+		10, 11, 12,
+		11, 11, 11,
+	};
+	EXPECT_VECEQ(expect, calc_data(update));
+	float* tptr = (float*) target->device().data();
+	EXPECT_VECEQ(expect, std::vector<float>(tptr, tptr + tshape.n_elems()));
+}
+
+
+#endif // DISABLE_ETEQ_GATHER_TEST
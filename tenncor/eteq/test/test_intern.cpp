@@ -0,0 +1,78 @@
+
+#ifndef DISABLE_ETEQ_INTERN_TEST
+
+
+#include "gtest/gtest.h"
+
+#include "testutil/tutil.hpp"
+
+#include "tenncor/eteq/eteq.hpp"
+
+
+TEST(INTERN, Disabled)
+{
+	auto ctx = std::make_shared<estd::ConfigMap<>>();
+	EXPECT_EQ(nullptr, eteq::get_interner(ctx));
+
+	teq::Shape shape({3, 2});
+	teq::TensptrT a = eteq::make_variable<double>(shape, "a", ctx);
+	marsh::Maps attrs;
+	marsh::Maps attrs2;
+	auto f = eteq::make_funcattr(egen::NEG, {a}, attrs, ctx);
+	auto g = eteq::make_funcattr(egen::NEG, {a}, attrs2, ctx);
+	EXPECT_NE(f, g);
+}
+
+
+TEST(INTERN, Reuse)
+{
+	auto ctx = std::make_shared<estd::ConfigMap<>>();
+	eteq::set_interner(new eteq::FuncInterner(), ctx);
+	auto interner = eteq::get_interner(ctx);
+	ASSERT_NE(nullptr, interner);
+
+	teq::Shape shape({3, 2});
+	teq::TensptrT a = eteq::make_variable<double>(shape, "a", ctx);
+	teq::TensptrT b = eteq::make_variable<double>(shape, "b", ctx);
+
+	auto make = [&](egen::_GENERATED_OPCODE opcode,
+		const teq::TensptrsT& args, teq::RanksT ranks)
+	{
+		marsh::Maps attrs;
+		if (ranks.size() > 0)
+		{
+			eigen::pack_attr(attrs, ranks);
+		}
+		return eteq::make_funcattr(opcode, args, attrs, ctx);
+	};
+
+	auto sum = make(egen::ADD, {a, b}, {});
+	EXPECT_EQ(sum, make(egen::ADD, {a, b}, {}));
+	// arguments are matched in order
+	EXPECT_NE(sum, make(egen::ADD, {b, a}, {}));
+
+	// attributes must be equal
+	auto perm = make(egen::PERMUTE, {sum}, {1, 0});
+	EXPECT_EQ(perm, make(egen::PERMUTE, {sum}, {1, 0}));
+	EXPECT_NE(perm, make(egen::PERMUTE, {sum}, {0, 1}));
+	EXPECT_NE(perm, make(egen::NEG, {sum}, {}));
+
+	// non-idempotent operators stay distinct
+	auto rand = make(egen::RAND_UNIF, {a, b}, {});
+	EXPECT_NE(rand, make(egen::RAND_UNIF, {a, b}, {}));
+
+	// interned functors are weakly referenced
+	make(egen::NEG, {b}, {});
+	EXPECT_EQ(nullptr, interner->find(egen::NEG,
+		egen::get_type<double>(), {b}, marsh::Maps()));
+	size_t nrefs = interner->size();
+	interner->sweep();
+	EXPECT_GT(nrefs, interner->size());
+
+	eteq::set_interner(nullptr, ctx);
+	EXPECT_EQ(nullptr, eteq::get_interner(ctx));
+	EXPECT_NE(sum, make(egen::ADD, {a, b}, {}));
+}
+
+
+#endif // DISABLE_ETEQ_INTERN_TEST
@@ -0,0 +1,194 @@
+
+#ifndef DISABLE_ETEQ_SPARSE_TEST
+
+
+#include "gtest/gtest.h"
+
+#include "testutil/tutil.hpp"
+
+#include "tenncor/eteq/eteq.hpp"
+#include "tenncor/eteq/make.hpp"
+
+
+static std::vector<float> calc_data (eteq::ETensor tens)
+{
+	float* ptr = tens.calc<float>();
+	return std::vector<float>(ptr, ptr + tens->shape().n_elems());
+}
+
+
+// dense of [[0,2,0,0,0],[0,0,0,0,0],[0,0,0,0,-1],[0,3,0,0,0]]
+static const std::vector<size_t> rowptrs = {0, 1, 1, 2, 3};
+static const std::vector<size_t> colidx = {1, 4, 1};
+static const std::vector<float> values = {2, -1, 3};
+static const std::vector<float> densed = {
+	0, 2, 0, 0, 0,
+	0, 0, 0, 0, 0,
+	0, 0, 0, 0, -1,
+	0, 3, 0, 0, 0,
+};
+
+
+TEST(SPARSE, Construction)
+{
+	teq::Shape shape({5, 4});
+	auto csr = eteq::make_csr_variable<float>(shape, rowptrs, colidx, values, "csr");
+	auto coo = eteq::make_coo_variable<float>(shape,
+		{3, 0, 2, 3}, {1, 1, 4, 1}, {1, 2, -1, 2}, "coo");
+
+	EXPECT_STREQ("csr", csr->to_string().c_str());
+	EXPECT_ARREQ(shape, csr->shape());
+	EXPECT_ARREQ(shape, coo->shape());
+	EXPECT_EQ(3, csr->nnz());
+	// duplicate coordinates are summed
+	EXPECT_EQ(3, coo->nnz());
+
+	float* cdata = (float*) csr->device().data();
+	float* odata = (float*) coo->device().data();
+	EXPECT_VECEQ(densed, std::vector<float>(cdata, cdata + densed.size()));
+	EXPECT_VECEQ(densed, std::vector<float>(odata, odata + densed.size()));
+
+	teq::TensptrT cpy(csr->clone());
+	auto sparse = eigen::as_sparse<float>(*cpy);
+	ASSERT_NE(nullptr, sparse);
+	EXPECT_EQ(3, sparse->nnz());
+	EXPECT_EQ(nullptr, eigen::as_sparse<double>(*cpy));
+
+	size_t version = csr->get_meta().state_version();
+	csr->assign(eigen::coo_matrix<float>(shape, {1}, {2}, {5}));
+	EXPECT_LT(version, csr->get_meta().state_version());
+	EXPECT_EQ(1, csr->nnz());
+	cdata = (float*) csr->device().data();
+	EXPECT_EQ(5, cdata[7]);
+}
+
+
+TEST(SPARSE, SparseDenseMatmul)
+{
+	teq::Shape sshape({5, 4});
+	teq::Shape wshape({3, 5});
+	std::vector<float> wdata = {
+		1, 2, 3,
+		4, 5, 6,
+		7, 8, 9,
+		10, 11, 12,
+		13, 14, 15,
+	};
+	auto x = eteq::make_csr_variable<float>(sshape, rowptrs, colidx, values);
+	auto xd = eteq::make_constant<float>((float*) densed.data(), sshape);
+	auto w = eteq::make_constant<float>(wdata.data(), wshape);
+
+	eteq::ETensor sparse_out(eteq::make_functor(egen::MATMUL, {x, w}));
+	eteq::ETensor dense_out(eteq::make_functor(egen::MATMUL, {xd, w}));
+	EXPECT_ARREQ(dense_out->shape(), sparse_out->shape());
+	EXPECT_VECEQ(calc_data(dense_out), calc_data(sparse_out));
+
+	// contract rows of sparse with rows of dense
+	teq::Shape gshape({3, 4});
+	std::vector<float> gdata = {
+		1, 0, 2,
+		3, 1, 0,
+		0, 5, 1,
+		2, 2, 2,
+	};
+	auto g = eteq::make_constant<float>(gdata.data(), gshape);
+	eteq::ETensor sparse_contract(eteq::make_functor(egen::CONTRACT, {x, g},
+		eigen::PairVecT<teq::RankT>{{1, 1}}));
+	eteq::ETensor dense_contract(eteq::make_functor(egen::CONTRACT, {xd, g},
+		eigen::PairVecT<teq::RankT>{{1, 1}}));
+	EXPECT_ARREQ(dense_contract->shape(), sparse_contract->shape());
+	EXPECT_VECEQ(calc_data(dense_contract), calc_data(sparse_contract));
+}
+
+
+TEST(SPARSE, DenseSparseMatmul)
+{
+	teq::Shape ashape({4, 2});
+	teq::Shape sshape({5, 4});
+	std::vector<float> adata = {
+		1, 2, 3, 4,
+		5, 6, 7, 8,
+	};
+	auto a = eteq::make_constant<float>(adata.data(), ashape);
+	auto s = eteq::make_csr_variable<float>(sshape, rowptrs, colidx, values);
+	auto sd = eteq::make_constant<float>((float*) densed.data(), sshape);
+
+	eteq::ETensor sparse_out(eteq::make_functor(egen::MATMUL, {a, s}));
+	eteq::ETensor dense_out(eteq::make_functor(egen::MATMUL, {a, sd}));
+	EXPECT_ARREQ(dense_out->shape(), sparse_out->shape());
+	EXPECT_VECEQ(calc_data(dense_out), calc_data(sparse_out));
+}
+
+
+TEST(SPARSE, Gradient)
+{
+	teq::Shape xshape({5, 4});
+	teq::Shape wshape({3, 5});
+	std::vector<float> wdata(wshape.n_elems(), 1);
+	auto x = eteq::make_csr_variable<float>(xshape, rowptrs, colidx, values);
+	auto xd = eteq::make_constant<float>((float*) densed.data(), xshape);
+	auto w = eteq::make_variable<float>(wdata.data(), wshape, "w");
+
+	eteq::DerivativeFuncs builder;
+	teq::TensptrT sparse_root = eteq::make_functor(egen::MATMUL, {x, w});
+	teq::TensptrT dense_root = eteq::make_functor(egen::MATMUL, {xd, w});
+	auto sparse_ders = teq::derive(sparse_root, {w}, builder);
+	auto dense_ders = teq::derive(dense_root, {w}, builder);
+	ASSERT_EQ(1, sparse_ders.size());
+	ASSERT_EQ(1, dense_ders.size());
+
+	// gradient contracts sparse input without permuting it
+	auto func = dynamic_cast<teq::iFunctor*>(sparse_ders.front().get());
+	ASSERT_NE(nullptr, func);
+	EXPECT_EQ(egen::CONTRACT, func->get_opcode().code_);
+	EXPECT_EQ(x.get(), func->get_args().front().get());
+
+	eteq::ETensor sparse_der(sparse_ders.front());
+	eteq::ETensor dense_der(dense_ders.front());
+	EXPECT_ARREQ(wshape, sparse_der->shape());
+	EXPECT_VECEQ(calc_data(dense_der), calc_data(sparse_der));
+}
+
+
+TEST(SPARSE, AssignSub)
+{
+	teq::Shape wshape({3, 5});
+	teq::Shape xshape({5, 4});
+	teq::Shape gshape({3, 4});
+	std::vector<float> wdata = {
+		1, 2, 3,
+		4, 5, 6,
+		7, 8, 9,
+		10, 11, 12,
+		13, 14, 15,
+	};
+	std::vector<float> gdata = {
+		1, 0, 2,
+		3, 1, 0,
+		0, 5, 1,
+		2, 2, 2,
+	};
+	auto w = eteq::make_variable<float>(wdata.data(), wshape, "w");
+	auto x = eteq::make_csr_variable<float>(xshape, rowptrs, colidx, values);
+	auto g = eteq::make_constant<float>(gdata.data(), gshape);
+
+	eteq::ETensor update(eteq::make_functor(
+		egen::SPARSE_ASSIGN_SUB, {w, x, g}));
+	EXPECT_ARREQ(wshape, update->shape());
+	auto got = calc_data(update);
+
+	// row 1 -= 2 * g[0] + 3 * g[3], row 4 -= -1 * g[2], other rows untouched
+	std::vector<float> expect = {
+		1, 2, 3,
+		-4, -1, -4,
+		7, 8, 9,
+		10, 11, 12,
+		13, 19, 16,
+	};
+	EXPECT_VECEQ(expect, got);
+	float* wptr = (float*) w->device().data();
+	EXPECT_VECEQ(expect, std::vector<float>(wptr, wptr + wshape.n_elems()));
+}
+
+
+#endif // DISABLE_ETEQ_SPARSE_TEST
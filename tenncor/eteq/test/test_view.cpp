@@ -0,0 +1,132 @@
+
+#ifndef DISABLE_ETEQ_VIEW_TEST
+
+
+#include "gtest/gtest.h"
+
+#include "testutil/tutil.hpp"
+
+#include "tenncor/eteq/eteq.hpp"
+#include "tenncor/eteq/make.hpp"
+
+
+static std::vector<float> calc_data (eteq::ETensor tens)
+{
+	float* ptr = tens.calc<float>();
+	return std::vector<float>(ptr, ptr + tens->shape().n_elems());
+}
+
+
+static const std::vector<float> table = {
+	1, 2, 3,
+	4, 5, 6,
+	7, 8, 9,
+	10, 11, 12,
+};
+
+
+#ifndef PERM_OP
+
+
+TEST(VIEW, SliceInPlace)
+{
+	teq::Shape shape({3, 4});
+	auto x = eteq::make_variable<float>((float*) table.data(), shape, "x");
+
+	// every timestep of a sequence is read from the original data
+	for (teq::DimT t = 0; t < 4; ++t)
+	{
+		eteq::ETensor step(eteq::make_functor(egen::SLICE, {x},
+			eigen::PairVecT<teq::DimT>{{0, 3}, {t, 1}}));
+		EXPECT_ARREQ(teq::Shape({3}), step->shape());
+		float* ptr = step.calc<float>();
+		EXPECT_EQ((float*) x->device().data() + 3 * t, ptr);
+		std::vector<float> expect(table.begin() + 3 * t, table.begin() + 3 * (t + 1));
+		EXPECT_VECEQ(expect, std::vector<float>(ptr, ptr + 3));
+	}
+}
+
+
+#endif // PERM_OP
+
+
+TEST(VIEW, Composition)
+{
+	teq::Shape shape({3, 4});
+	auto x = eteq::make_variable<float>((float*) table.data(), shape, "x");
+
+	teq::TensptrT trans = eteq::make_functor(egen::PERMUTE, {x},
+		teq::RanksT{1, 0});
+	teq::TensptrT rows = eteq::make_functor(egen::SLICE, {trans},
+		eigen::PairVecT<teq::DimT>{{1, 2}, {0, 3}});
+	teq::TensptrT strided = eteq::make_functor(egen::STRIDE, {rows},
+		teq::DimsT{1, 2});
+	eteq::ETensor out(eteq::make_functor(egen::REVERSE, {strided},
+		std::set<teq::RankT>{0}));
+	EXPECT_ARREQ(teq::Shape({2, 2}), out->shape());
+
+	std::vector<float> expect = {
+		7, 4,
+		9, 6,
+	};
+	EXPECT_VECEQ(expect, calc_data(out));
+
+	// update through view after source changes
+	std::vector<float> doubled(table.size());
+	std::transform(table.begin(), table.end(), doubled.begin(),
+		[](float e) { return 2 * e; });
+	x->assign(doubled.data(), shape);
+	std::vector<float> expect2 = {
+		14, 8,
+		18, 12,
+	};
+	EXPECT_VECEQ(expect2, calc_data(out));
+}
+
+
+TEST(VIEW, TransposedMatmul)
+{
+	teq::Shape ashape({3, 4});
+	teq::Shape bshape({2, 3});
+	std::vector<float> bdata = {
+		1, 0,
+		2, 1,
+		0, 3,
+	};
+	std::vector<float> atdata = {
+		1, 4, 7, 10,
+		2, 5, 8, 11,
+		3, 6, 9, 12,
+	};
+	auto a = eteq::make_variable<float>((float*) table.data(), ashape, "a");
+	auto at = eteq::make_constant<float>(atdata.data(), teq::Shape({4, 3}));
+	auto b = eteq::make_constant<float>(bdata.data(), bshape);
+
+	// matmul(transpose(transpose(a)), b) = matmul(a, b)
+	teq::TensptrT trans = eteq::make_functor(egen::PERMUTE, {at},
+		teq::RanksT{1, 0});
+	eteq::ETensor view_out(eteq::make_functor(egen::MATMUL, {trans, b}));
+	eteq::ETensor dense_out(eteq::make_functor(egen::MATMUL, {a, b}));
+	EXPECT_ARREQ(dense_out->shape(), view_out->shape());
+	EXPECT_VECEQ(calc_data(dense_out), calc_data(view_out));
+
+	// contract sliced rows with transposed view
+	teq::TensptrT rows = eteq::make_functor(egen::SLICE, {trans},
+		eigen::PairVecT<teq::DimT>{{1, 2}, {0, 4}});
+	eteq::ETensor slice_out(eteq::make_functor(egen::CONTRACT, {rows, trans},
+		eigen::PairVecT<teq::RankT>{{1, 1}}));
+	EXPECT_ARREQ(teq::Shape({3, 2}), slice_out->shape());
+	// rows^T * a where rows = a[:, 1:3]
+	std::vector<float> expect = {
+		2 * 1 + 5 * 4 + 8 * 7 + 11 * 10,
+		2 * 2 + 5 * 5 + 8 * 8 + 11 * 11,
+		2 * 3 + 5 * 6 + 8 * 9 + 11 * 12,
+		3 * 1 + 6 * 4 + 9 * 7 + 12 * 10,
+		3 * 2 + 6 * 5 + 9 * 8 + 12 * 11,
+		3 * 3 + 6 * 6 + 9 * 9 + 12 * 12,
+	};
+	EXPECT_VECEQ(expect, calc_data(slice_out));
+}
+
+
+#endif // DISABLE_ETEQ_VIEW_TEST
@@ -5,6 +5,7 @@
 #include "tenncor/distr.hpp"
 #include "tenncor/hone/hone.hpp"
 #include "tenncor/hone/hosvc/hosvc.hpp"
+#include "tenncor/serial/serial.hpp"
 
 namespace tcr
 {
@@ -12,6 +13,25 @@ namespace tcr
 void optimize (std::string filename,
     const global::CfgMapptrT& ctx = global::context());
 
+/// Return fingerprint of graph structure, shapes, constant contents and rules
+/// Mutable leaves are fingerprinted by label, shape, type, usage, and
+/// position, so sort roots into a canonical order and identify mutable leaves
+/// by their position in that order
+size_t fingerprint (teq::TensptrsT& roots,
+    onnx::TensIdT& leaves, const std::string& rules);
+
+/// Return roots optimized by rules after loading the optimized graph
+/// from cache_dir if the same graph was previously optimized by
+/// the same rules, otherwise optimize and store the result in cache_dir
+teq::TensptrsT cached_optimize (const teq::TensptrsT& roots,
+    std::istream& rulestr, const std::string& cache_dir,
+    const global::CfgMapptrT& ctx = global::context());
+
+/// Apply optimization to graph roots in context registry
+/// reusing optimized graphs stored in cache_dir
+void optimize (std::string filename, const std::string& cache_dir,
+    const global::CfgMapptrT& ctx = global::context());
+
 }
 
 #endif // TENNCOR_HONE_HPP
@@ -0,0 +1,39 @@
+// Reorder chains of matrix products by estimated cost
+
+// 1. flatten every maximal chain of matrix products (MATMUL, or CONTRACT
+//    equivalent to MATMUL) whose inner products have no other consumers,
+//    optionally pushing a transpose of a product down to its operands
+
+// 2. plan the cheapest parenthesization of each chain using the classic
+//    O(n^3) matrix-chain dynamic program where each product is weighted
+//    by the opcode's relative runtime
+
+// 3. rebuild chains whose planned cost is lower than their current cost
+
+#ifndef HONE_CHAIN_HPP
+#define HONE_CHAIN_HPP
+
+#include "internal/opt/opt.hpp"
+
+#include "tenncor/eteq/eteq.hpp"
+
+namespace hone
+{
+
+/// Relative runtime of each opcode keyed by opcode name
+/// (e.g.: weights produced by ccur's rtscale), where absent opcodes weigh 1
+using OpWeightsT = types::StrUMapT<double>;
+
+/// Return true if tens is a MATMUL or a CONTRACT of matrices along
+/// ranks {0, 1}, which is equivalent to a MATMUL
+bool is_matmul (const teq::iTensor& tens);
+
+/// Rebuild every matrix product chain in graph with at least 3 operands
+/// if its cheapest order under weights costs less than its current order
+/// Return number of chains rebuilt
+size_t reorder_matmuls (opt::GraphInfo& graph,
+	const OpWeightsT& weights = OpWeightsT());
+
+}
+
+#endif // HONE_CHAIN_HPP
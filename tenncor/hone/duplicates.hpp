@@ -6,49 +6,66 @@
 
 #include "internal/eigen/eigen.hpp"
 
+#include "tenncor/eteq/constant.hpp"
+
 namespace hone
 {
 
 using EqualF = std::function<bool(teq::TensptrT,teq::TensptrT)>;
 
+using LeafHashF = std::function<size_t(teq::iLeaf&)>;
+
+/// Bottom-up structural hasher where equivalent subgraphs hash to the same
+/// 64-bit value, immutable leaves hash by content, and other leaves by identity
+/// unless hash_leaf is specified
+/// Different subgraphs can collide, so use equal hashes only to find candidates
 struct Hasher final : public teq::iOnceTraveler
 {
-	const std::string& at (teq::iTensor* tens) const
+	Hasher (LeafHashF hash_leaf = LeafHashF()) : hash_leaf_(hash_leaf) {}
+
+	size_t at (teq::iTensor* tens) const
 	{
 		return estd::must_getf(hashes_, tens,
 			"failed to find hash for %s",
 			tens->to_string().c_str());
 	}
 
-	teq::TensMapT<std::string> hashes_;
+	teq::TensMapT<size_t> hashes_;
 
 private:
 	/// Implementation of iOnceTraveler
 	void visit_leaf (teq::iLeaf& leaf) override
 	{
+		size_t seed;
 		if (teq::IMMUTABLE == leaf.get_usage())
 		{
-			std::string label = leaf.shape().to_string() + "|";
-			auto& meta = leaf.get_meta();
-			auto data = (const char*) leaf.device().data();
-			label += meta.type_label() + std::string(
-				data, data + leaf.shape().n_elems() *
-				egen::type_size(egen::_GENERATED_DTYPE(meta.type_code())));
-			encode_label(&leaf, label);
+			if (auto cst = dynamic_cast<const eteq::iConstant*>(&leaf))
+			{
+				seed = cst->content_hash();
+			}
+			else
+			{
+				seed = eteq::hash_data(leaf);
+			}
+		}
+		else if (hash_leaf_)
+		{
+			seed = hash_leaf_(leaf);
 		}
 		else
 		{
-			hashes_.emplace(&leaf, global::get_generator()->get_str());
+			seed = boost::hash_value(&leaf);
 		}
+		hashes_.emplace(&leaf, seed);
 	}
 
 	/// Implementation of iOnceTraveler
 	void visit_func (teq::iFunctor& func) override
 	{
 		auto deps = func.get_args();
-		types::StringsT hshs;
-		hshs.reserve(deps.size());
 		teq::multi_visit(*this, deps);
+		std::vector<size_t> hshs;
+		hshs.reserve(deps.size());
 		for (teq::TensptrT dep : deps)
 		{
 			hshs.push_back(at(dep.get()));
@@ -58,47 +75,58 @@ private:
 		{
 			std::sort(hshs.begin(), hshs.end());
 		}
-		types::StrUMapT<std::string> attrs;
-		auto keys = func.ls_attrs();
-		for (auto key : keys)
+		teq::Shape shape = func.shape();
+		size_t seed = boost::hash_range(shape.begin(), shape.end());
+		boost::hash_combine(seed, func.get_opcode().code_);
+		boost::hash_combine(seed, func.get_meta().type_code());
+		boost::hash_range(seed, hshs.begin(), hshs.end());
+		// attribute keys are listed in sorted order
+		for (const std::string& key : func.ls_attrs())
 		{
 			if (auto value = func.get_attr(key))
 			{
-				if (auto tref = dynamic_cast<const teq::TensorRef*>(value))
-				{
-					auto ref = tref->get_tensor();
-					ref->accept(*this);
-					attrs.emplace(key, at(ref.get()));
-				}
-				else
-				{
-					attrs.emplace(key, value->to_string());
-				}
+				boost::hash_combine(seed, key);
+				hash_attr(seed, *value);
 			}
 		}
-		encode_label(&func, func.shape().to_string() + "|" +
-			func.to_string() + "\\" +
-			fmts::to_string(attrs.begin(), attrs.end()) + "\\" +
-			fmts::to_string(hshs.begin(), hshs.end()));
+		hashes_.emplace(&func, seed);
 	}
 
-	void encode_label (teq::iTensor* tens, const std::string& label)
+	void hash_attr (size_t& seed, const marsh::iObject& value)
 	{
-		std::string uuid;
-		if (false == estd::get(uuid, uuids_, label))
+		if (auto tref = dynamic_cast<const teq::TensorRef*>(&value))
+		{
+			auto ref = tref->get_tensor();
+			ref->accept(*this);
+			boost::hash_combine(seed, at(ref.get()));
+		}
+		else if (auto num = dynamic_cast<const marsh::iNumber*>(&value))
+		{
+			boost::hash_combine(seed, num->to_float64());
+		}
+		else if (auto arr = dynamic_cast<const marsh::iArray*>(&value))
+		{
+			boost::hash_combine(seed, arr->size());
+			arr->foreach(
+			[&](size_t, const marsh::iObject* obj)
+			{
+				hash_attr(seed, *obj);
+			});
+		}
+		else
 		{
-			uuid = global::get_generator()->get_str();
-			uuids_.emplace(label, uuid);
+			boost::hash_combine(seed, value.to_string());
 		}
-		hashes_.emplace(tens, uuid);
 	}
 
-	types::StrUMapT<std::string> uuids_;
+	LeafHashF hash_leaf_;
 };
 
 /// Delete and update equivalent functor and leaves
 void merge_dups (opt::GraphInfo& graph, EqualF equals);
 
+/// Hash-cons graph bottom-up, merging immutable leaves and functors whose
+/// Hasher values match and whose contents and canonical arguments are equal
 void merge_dups (opt::GraphInfo& graph);
 
 }
@@ -1,2 +1,4 @@
-
+#include "tenncor/hone/chain.hpp"
 #include "tenncor/hone/optimize.hpp"
+#include "tenncor/hone/permute.hpp"
+#include "tenncor/hone/quantize.hpp"
@@ -17,20 +17,21 @@
 namespace hone
 {
 
-using GenCstF = std::function<void(opt::OptRulesT&,const opt::GraphInfo&)>;
+/// Fold constant-only subgraphs and return number of subgraphs folded
+using FoldCstF = std::function<size_t(opt::GraphInfo&)>;
 
 teq::TensptrsT optimize (teq::TensptrsT roots,
-	const opt::Optimization& pb_opt, GenCstF gen_cst =
-	[](opt::OptRulesT& rules, const opt::GraphInfo& ginfo)
+	const opt::Optimization& pb_opt, FoldCstF fold_cst =
+	[](opt::GraphInfo& ginfo)
 	{
-		generate_cstrules(rules, ginfo);
+		return fold_constants(ginfo);
 	});
 
 teq::TensptrsT optimize (teq::TensptrsT roots,
-	std::istream& rulestr, GenCstF gen_cst =
-	[](opt::OptRulesT& rules, const opt::GraphInfo& ginfo)
+	std::istream& rulestr, FoldCstF fold_cst =
+	[](opt::GraphInfo& ginfo)
 	{
-		generate_cstrules(rules, ginfo);
+		return fold_constants(ginfo);
 	});
 
 /// Apply optimization to graph roots in context registry
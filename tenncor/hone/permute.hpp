@@ -0,0 +1,34 @@
+// Eliminate tensor copies made by PERMUTE
+
+// 1. merge adjacent permutes and drop permutes that resolve to identity
+//    or only move dimensions of size 1 (replacing the latter with RESHAPE)
+
+// 2. fold permuted operands of CONTRACT (and MATMUL of matrices) into its
+//    contraction dimensions, and permuted outputs into its operand order
+
+// 3. fold permuted operands of reductions into the reduced dimensions
+
+// 4. push permutes through elementwise operators when every argument is
+//    permuted or an immutable leaf, so permutes cancel below or
+//    land on constants where constant folding applies them once
+
+#ifndef HONE_PERMUTE_HPP
+#define HONE_PERMUTE_HPP
+
+#include "internal/opt/opt.hpp"
+
+#include "tenncor/eteq/eteq.hpp"
+
+namespace hone
+{
+
+/// Return order completed to rank_cap ranks the way PERMUTE does
+teq::RanksT complete_order (const teq::RanksT& order);
+
+/// Repeatedly rewrite graph to remove or fold PERMUTE functors
+/// Return number of functors rewritten
+size_t eliminate_permutes (opt::GraphInfo& graph);
+
+}
+
+#endif // HONE_PERMUTE_HPP
@@ -0,0 +1,47 @@
+// Post-training quantization of inference graphs
+
+// 1. calibrate records the range of real activations over calibration runs
+
+// 2. quantize rewrites MATMUL, CONV2D and CONTRACT equivalent to MATMUL of
+//    matrices whose weight (second argument) is a real constant into
+//    QUANT_MATMUL and QUANT_CONV2D over the quantized weight constant and
+//    a QUANTIZE of the activation, where per channel weight scales and
+//    the activation scale fold into the multipliers applied to the
+//    int32 accumulators
+
+// activations without a calibrated range fall back to their stabilizer
+// range if bounded (e.g.: outputs of SIGMOID or TANH), and are otherwise
+// left unquantized
+
+#ifndef HONE_QUANTIZE_HPP
+#define HONE_QUANTIZE_HPP
+
+#include "internal/opt/opt.hpp"
+#include "internal/utils/stabilizer/stabilizer.hpp"
+
+#include "tenncor/eteq/eteq.hpp"
+
+namespace hone
+{
+
+/// Range of values observed in each tensor
+using QuantRangesT = teq::TensMapT<estd::NumRange<double>>;
+
+/// Return activations of functors quantize can rewrite
+teq::TensptrsT calibration_targets (const opt::GraphInfo& graph);
+
+/// Evaluate targets and widen their ranges to cover the evaluated data
+/// Call once per calibration run after assigning placeholders
+void calibrate (QuantRangesT& ranges, const teq::TensptrsT& targets,
+	const global::CfgMapptrT& ctx = global::context());
+
+/// Rewrite functors with real constant weights into quantized functors
+/// given calibrated activation ranges, quantizing weights with one scale
+/// per output channel if per_channel is true otherwise one scale per weight
+/// Return number of functors rewritten
+size_t quantize (opt::GraphInfo& graph,
+	const QuantRangesT& ranges, bool per_channel = true);
+
+}
+
+#endif // HONE_QUANTIZE_HPP
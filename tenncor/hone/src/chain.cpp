@@ -0,0 +1,381 @@
+#include "tenncor/hone/chain.hpp"
+
+#ifdef HONE_CHAIN_HPP
+
+namespace hone
+{
+
+using SplitsT = std::vector<std::vector<size_t>>;
+
+/// Matrix operand of a product chain
+struct ChainOperand final
+{
+	teq::TensptrT tens_;
+
+	/// True if tens_ is transposed before multiplying
+	bool transpose_;
+
+	/// Number of rows of operand after transpose
+	double nrows_;
+
+	/// Number of columns of operand after transpose
+	double ncols_;
+};
+
+/// Product chain flattened in multiplication order
+struct MatChain final
+{
+	teq::TensptrT root_;
+
+	std::vector<ChainOperand> operands_;
+
+	/// Tensors replaced when chain is rebuilt (including root)
+	teq::TensSetT inner_;
+
+	/// Number of matrices multiplied by each product (product of ranks above 1)
+	double nbatch_ = 1;
+
+	/// Estimated cost of the tensors in inner_
+	double cost_ = 0;
+};
+
+static double get_weight (const OpWeightsT& weights, egen::_GENERATED_OPCODE opcode)
+{
+	return estd::try_get(weights, egen::name_op(opcode), 1.);
+}
+
+/// Return func if func swaps the first 2 ranks only, otherwise return nullptr
+static teq::iFunctor* as_transpose (teq::iTensor& tens)
+{
+	auto func = dynamic_cast<teq::iFunctor*>(&tens);
+	if (nullptr == func || egen::PERMUTE != func->get_opcode().code_)
+	{
+		return nullptr;
+	}
+	teq::RanksT order;
+	eigen::Packer<teq::RanksT>().unpack(order, *func);
+	if (order.size() < 2 || 1 != order[0] || 0 != order[1])
+	{
+		return nullptr;
+	}
+	for (size_t i = 2, n = order.size(); i < n; ++i)
+	{
+		if (order[i] != i)
+		{
+			return nullptr;
+		}
+	}
+	return func;
+}
+
+bool is_matmul (const teq::iTensor& tens)
+{
+	auto func = dynamic_cast<const teq::iFunctor*>(&tens);
+	if (nullptr == func)
+	{
+		return false;
+	}
+	auto opcode = func->get_opcode().code_;
+	if (egen::MATMUL == opcode)
+	{
+		return true;
+	}
+	if (egen::CONTRACT != opcode)
+	{
+		return false;
+	}
+	eigen::PairVecT<teq::RankT> ranks;
+	eigen::Packer<eigen::PairVecT<teq::RankT>>().unpack(ranks, *func);
+	if (1 != ranks.size() || 0 != ranks[0].first || 1 != ranks[0].second)
+	{
+		return false;
+	}
+	auto args = func->get_args();
+	return std::all_of(args.begin(), args.end(),
+		[](teq::TensptrT arg)
+		{
+			return teq::narrow_shape(arg->shape()).size() <= 2;
+		});
+}
+
+/// Flattens maximal product chains of a graph
+struct ChainFlattener final
+{
+	ChainFlattener (const opt::GraphInfo& graph,
+		const OpWeightsT& weights, bool expand_transpose) :
+		graph_(&graph), weights_(&weights),
+		expand_transpose_(expand_transpose)
+	{
+		for (const teq::TensptrT& root : graph.roots_)
+		{
+			roots_.emplace(root.get());
+		}
+	}
+
+	MatChain flatten (teq::TensptrT root) const
+	{
+		MatChain chain;
+		chain.root_ = root;
+		auto shape = root->shape();
+		chain.nbatch_ = (double) shape.n_elems() / (shape.at(0) * shape.at(1));
+		flatten_product(chain, static_cast<teq::iFunctor&>(*root), false);
+		return chain;
+	}
+
+private:
+	/// Return true if tens is only used once as an argument
+	bool single_use (teq::iTensor* tens) const
+	{
+		if (estd::has(roots_, tens))
+		{
+			return false;
+		}
+		auto it = graph_->parents_.find(tens);
+		if (graph_->parents_.end() == it || 1 != it->second.size())
+		{
+			return false;
+		}
+		auto& dir = it->second.begin()->second;
+		return 1 == dir.args_.size() && dir.attrs_.empty();
+	}
+
+	double permute_cost (const teq::Shape& shape) const
+	{
+		return get_weight(*weights_, egen::PERMUTE) * shape.n_elems();
+	}
+
+	void flatten_product (MatChain& chain,
+		teq::iFunctor& func, bool transpose) const
+	{
+		chain.inner_.emplace(&func);
+		auto args = func.get_args();
+		// matmul(a, b) multiplies matrices a[m, k] and b[k, n]
+		// with shapes [k, m] and [n, k] respectively
+		auto lshape = args[0]->shape();
+		auto rshape = args[1]->shape();
+		chain.cost_ += get_weight(*weights_,
+			(egen::_GENERATED_OPCODE) func.get_opcode().code_) *
+			chain.nbatch_ * lshape.at(1) * lshape.at(0) * rshape.at(0);
+		if (transpose)
+		{
+			// (AB)^T = B^T A^T
+			flatten_operand(chain, args[1], true);
+			flatten_operand(chain, args[0], true);
+		}
+		else
+		{
+			flatten_operand(chain, args[0], false);
+			flatten_operand(chain, args[1], false);
+		}
+	}
+
+	void flatten_operand (MatChain& chain,
+		const teq::TensptrT& arg, bool transpose) const
+	{
+		if (is_matmul(*arg) && single_use(arg.get()))
+		{
+			flatten_product(chain, static_cast<teq::iFunctor&>(*arg), transpose);
+			return;
+		}
+		if (auto perm = as_transpose(*arg))
+		{
+			auto inner = perm->get_args().front();
+			if (expand_transpose_ && single_use(arg.get()) &&
+				is_matmul(*inner) && single_use(inner.get()))
+			{
+				chain.inner_.emplace(arg.get());
+				chain.cost_ += permute_cost(arg->shape());
+				flatten_product(chain,
+					static_cast<teq::iFunctor&>(*inner), !transpose);
+				return;
+			}
+			if (transpose)
+			{
+				// transposes cancel
+				push_operand(chain, inner, false);
+				return;
+			}
+		}
+		push_operand(chain, arg, transpose);
+	}
+
+	void push_operand (MatChain& chain,
+		const teq::TensptrT& tens, bool transpose) const
+	{
+		auto shape = tens->shape();
+		double nrows = shape.at(1);
+		double ncols = shape.at(0);
+		if (transpose)
+		{
+			std::swap(nrows, ncols);
+		}
+		chain.operands_.push_back(ChainOperand{tens, transpose, nrows, ncols});
+	}
+
+	const opt::GraphInfo* graph_;
+
+	const OpWeightsT* weights_;
+
+	bool expand_transpose_;
+
+	teq::TensSetT roots_;
+};
+
+/// Return the cheapest estimated cost of multiplying chain operands
+/// and populate splits[i][j] with the last product of operands i through j
+static double plan_chain (SplitsT& splits,
+	const MatChain& chain, const OpWeightsT& weights)
+{
+	const auto& operands = chain.operands_;
+	size_t n = operands.size();
+	double weight = get_weight(weights, egen::MATMUL) * chain.nbatch_;
+	std::vector<std::vector<double>> costs(n, std::vector<double>(n, 0));
+	splits = SplitsT(n, std::vector<size_t>(n, 0));
+	for (size_t len = 2; len <= n; ++len)
+	{
+		for (size_t i = 0; i + len <= n; ++i)
+		{
+			size_t j = i + len - 1;
+			costs[i][j] = std::numeric_limits<double>::max();
+			for (size_t s = i; s < j; ++s)
+			{
+				double cost = costs[i][s] + costs[s + 1][j] + weight *
+					operands[i].nrows_ * operands[s].ncols_ * operands[j].ncols_;
+				if (cost < costs[i][j])
+				{
+					costs[i][j] = cost;
+					splits[i][j] = s;
+				}
+			}
+		}
+	}
+	double cost = costs[0][n - 1];
+	double permute_weight = get_weight(weights, egen::PERMUTE);
+	for (const ChainOperand& operand : operands)
+	{
+		if (operand.transpose_)
+		{
+			cost += permute_weight * operand.tens_->shape().n_elems();
+		}
+	}
+	return cost;
+}
+
+static teq::TensptrT build_chain (const MatChain& chain,
+	const SplitsT& splits, size_t i, size_t j, const teq::OwnMapT& converts)
+{
+	if (i == j)
+	{
+		const ChainOperand& operand = chain.operands_[i];
+		auto tens = estd::try_get(converts, operand.tens_.get(), operand.tens_);
+		if (operand.transpose_)
+		{
+			tens = eteq::make_functor(egen::PERMUTE,
+				teq::TensptrsT{tens}, teq::RanksT{1, 0});
+		}
+		return tens;
+	}
+	size_t s = splits[i][j];
+	return eteq::make_functor(egen::MATMUL, teq::TensptrsT{
+		build_chain(chain, splits, i, s, converts),
+		build_chain(chain, splits, s + 1, j, converts),
+	});
+}
+
+/// Planned rebuild of a chain
+struct ChainPlan final
+{
+	MatChain chain_;
+
+	SplitsT splits_;
+
+	size_t height_;
+};
+
+size_t reorder_matmuls (opt::GraphInfo& graph, const OpWeightsT& weights)
+{
+	teq::GraphStat stat;
+	teq::multi_visit(stat, graph.roots_);
+
+	teq::TensT products;
+	for (const auto& owner : graph.get_owners())
+	{
+		// skip products only referenced by attributes
+		if (is_matmul(*owner.first) && estd::has(stat.graphsize_, owner.first))
+		{
+			products.push_back(owner.first);
+		}
+	}
+	// plan from the top so every chain is maximal
+	std::sort(products.begin(), products.end(),
+		[&stat](teq::iTensor* a, teq::iTensor* b)
+		{
+			return stat.graphsize_.at(a).upper_ > stat.graphsize_.at(b).upper_;
+		});
+
+	ChainFlattener flattener(graph, weights, false);
+	ChainFlattener expander(graph, weights, true);
+	std::vector<ChainPlan> plans;
+	teq::TensSetT absorbed;
+	for (teq::iTensor* product : products)
+	{
+		if (estd::has(absorbed, product))
+		{
+			continue;
+		}
+		auto root = graph.get_owner(product);
+		MatChain plain = flattener.flatten(root);
+		MatChain expanded = expander.flatten(root);
+
+		const MatChain* best = nullptr;
+		SplitsT best_splits;
+		double best_savings = 0;
+		for (const MatChain* chain : {&plain, &expanded})
+		{
+			if (chain->operands_.size() < 3)
+			{
+				continue;
+			}
+			SplitsT splits;
+			double cost = plan_chain(splits, *chain, weights);
+			double savings = chain->cost_ - cost;
+			// ignore rounding differences between equivalent orders
+			if (savings > chain->cost_ * 1e-9 && savings > best_savings)
+			{
+				best = chain;
+				best_splits = splits;
+				best_savings = savings;
+			}
+		}
+		if (nullptr == best)
+		{
+			absorbed.insert(plain.inner_.begin(), plain.inner_.end());
+			continue;
+		}
+		absorbed.insert(best->inner_.begin(), best->inner_.end());
+		plans.push_back(ChainPlan{*best, best_splits,
+			stat.graphsize_.at(product).upper_});
+	}
+
+	// build from the bottom so chains use the rebuilt operands
+	std::sort(plans.begin(), plans.end(),
+		[](const ChainPlan& a, const ChainPlan& b)
+		{
+			return a.height_ < b.height_;
+		});
+	teq::OwnMapT converts;
+	for (const ChainPlan& plan : plans)
+	{
+		converts.emplace(plan.chain_.root_.get(), build_chain(plan.chain_,
+			plan.splits_, 0, plan.chain_.operands_.size() - 1, converts));
+	}
+	if (converts.size() > 0)
+	{
+		graph.replace(converts);
+	}
+	return plans.size();
+}
+
+}
+
+#endif
@@ -5,38 +5,112 @@
 namespace hone
 {
 
-void generate_cstrules (opt::OptRulesT& rules,
-	const opt::GraphInfo& graph, global::CfgMapptrT context)
+/// Traveler marking tensors whose values never change
+struct ConstantFinder final : public teq::iOnceTraveler
 {
-	types::StrUMapT<std::unordered_set<size_t>> branches;
-	for (const auto& owner : graph.get_owners())
+	teq::TensSetT constants_;
+
+private:
+	/// Implementation of iOnceTraveler
+	void visit_leaf (teq::iLeaf& leaf) override
 	{
-		if (auto f = dynamic_cast<const teq::iFunctor*>(owner.first))
+		if (teq::IMMUTABLE == leaf.get_usage())
 		{
-			branches[f->to_string()].emplace(f->get_args().size());
+			constants_.emplace(&leaf);
 		}
 	}
-	if (branches.empty())
+
+	/// Implementation of iOnceTraveler
+	void visit_func (teq::iFunctor& func) override
 	{
-		// for some reason...
-		return;
+		auto deps = func.get_args();
+		marsh::Maps attrs;
+		marsh::get_attrs(attrs, func);
+		teq::FindTensAttr finder;
+		attrs.accept(finder);
+		deps.insert(deps.end(), finder.tens_.begin(), finder.tens_.end());
+		teq::multi_visit(*this, deps);
+
+		auto opcode = (egen::_GENERATED_OPCODE) func.get_opcode().code_;
+		// todo: move identity exception to generated output
+		if (egen::IDENTITY != opcode && egen::is_idempotent(opcode) &&
+			std::all_of(deps.begin(), deps.end(),
+			[this](teq::TensptrT dep)
+			{
+				return estd::has(constants_, dep.get());
+			}))
+		{
+			constants_.emplace(&func);
+		}
 	}
-	google::protobuf::RepeatedPtrField<query::Node> srcs;
-	for (auto& branch : branches)
+};
+
+teq::TensT find_constant_roots (const opt::GraphInfo& graph)
+{
+	ConstantFinder finder;
+	teq::multi_visit(finder, graph.roots_);
+
+	teq::TensSetT roots;
+	for (const teq::TensptrT& root : graph.roots_)
+	{
+		roots.emplace(root.get());
+	}
+	teq::TensT out;
+	for (teq::iTensor* cst : finder.constants_)
 	{
-		for (size_t bfactor : branch.second)
+		if (nullptr == dynamic_cast<teq::iFunctor*>(cst))
+		{
+			continue;
+		}
+		if (estd::has(roots, cst))
 		{
-			if (branch.first != egen::name_op(egen::IDENTITY)) // todo: move to generated output
+			out.push_back(cst);
+			continue;
+		}
+		auto it = graph.parents_.find(cst);
+		if (graph.parents_.end() != it && std::any_of(
+			it->second.begin(), it->second.end(),
+			[&finder](const auto& ppair)
 			{
-				query::Node* src = srcs.Add();
-				get_cstsource(*src, branch.first, bfactor);
-			}
+				return false == estd::has(finder.constants_, ppair.first);
+			}))
+		{
+			out.push_back(cst);
 		}
 	}
-	rules.push_back(opt::OptRule{srcs,
-		std::make_shared<ConstantTarget>(graph, context)});
+	return out;
+}
+
+#define _CHOOSE_CST_TARGETTYPE(REALTYPE)\
+out = eteq::make_constant<REALTYPE>((REALTYPE*)data, root->shape());
+
+size_t fold_constants (opt::GraphInfo& graph, global::CfgMapptrT ctx)
+{
+	teq::TensT roots = find_constant_roots(graph);
+	if (roots.empty())
+	{
+		return 0;
+	}
+	eigen::Device device;
+	teq::get_eval(ctx).evaluate(device,
+		teq::TensSetT(roots.begin(), roots.end()));
+
+	teq::OwnMapT converts;
+	for (teq::iTensor* root : roots)
+	{
+		void* data = root->device().data();
+		auto outtype = (egen::_GENERATED_DTYPE) root->get_meta().type_code();
+		teq::TensptrT out;
+		TYPE_LOOKUP(_CHOOSE_CST_TARGETTYPE, outtype);
+		converts.emplace(root, out);
+	}
+	global::debugf("folding %d constant subgraphs", roots.size());
+	graph.replace(converts);
+	return roots.size();
 }
 
+#undef _CHOOSE_CST_TARGETTYPE
+
 }
 
 #endif
@@ -92,18 +92,152 @@ void merge_dups (opt::GraphInfo& graph, EqualF equals)
 	graph.replace(converts);
 }
 
+/// Return true if immutable leaves have the same shape, type, and data
+static bool leaf_equals (const teq::iLeaf& a, const teq::iLeaf& b)
+{
+	teq::Shape shape = a.shape();
+	const teq::iMetadata& meta = a.get_meta();
+	if (false == shape.compatible_after(b.shape(), 0) ||
+		meta.type_code() != b.get_meta().type_code())
+	{
+		return false;
+	}
+	auto adata = (const char*) a.device().data();
+	auto bdata = (const char*) b.device().data();
+	return std::equal(adata,
+		adata + shape.n_elems() * meta.type_size(), bdata);
+}
+
+/// Return true if functors have the same operation, shape, type, attributes
+/// and arguments once arguments are replaced by their canonical tensor
+static bool func_equals (const teq::iFunctor& a, const teq::iFunctor& b,
+	const teq::OwnMapT& converts)
+{
+	auto canonical = [&converts](const teq::TensptrT& tens)
+	{
+		auto it = converts.find(tens.get());
+		return converts.end() == it ? tens.get() : it->second.get();
+	};
+	size_t opcode = a.get_opcode().code_;
+	if (opcode != b.get_opcode().code_ ||
+		false == a.shape().compatible_after(b.shape(), 0) ||
+		a.get_meta().type_code() != b.get_meta().type_code())
+	{
+		return false;
+	}
+	auto aargs = a.get_args();
+	auto bargs = b.get_args();
+	size_t nargs = aargs.size();
+	if (nargs != bargs.size())
+	{
+		return false;
+	}
+	std::vector<teq::iTensor*> acanon;
+	std::vector<teq::iTensor*> bcanon;
+	acanon.reserve(nargs);
+	bcanon.reserve(nargs);
+	std::transform(aargs.begin(), aargs.end(),
+		std::back_inserter(acanon), canonical);
+	std::transform(bargs.begin(), bargs.end(),
+		std::back_inserter(bcanon), canonical);
+	if (egen::is_commutative((egen::_GENERATED_OPCODE) opcode))
+	{
+		std::sort(acanon.begin(), acanon.end());
+		std::sort(bcanon.begin(), bcanon.end());
+	}
+	if (acanon != bcanon)
+	{
+		return false;
+	}
+	auto akeys = a.ls_attrs();
+	if (akeys != b.ls_attrs())
+	{
+		return false;
+	}
+	return std::all_of(akeys.begin(), akeys.end(),
+		[&](const std::string& key)
+		{
+			const marsh::iObject* aval = a.get_attr(key);
+			const marsh::iObject* bval = b.get_attr(key);
+			if (nullptr == aval || nullptr == bval)
+			{
+				return aval == bval;
+			}
+			auto aref = dynamic_cast<const teq::TensorRef*>(aval);
+			auto bref = dynamic_cast<const teq::TensorRef*>(bval);
+			if (nullptr != aref || nullptr != bref)
+			{
+				return nullptr != aref && nullptr != bref &&
+					aref->class_code() == bref->class_code() &&
+					aref->to_string() == bref->to_string() &&
+					canonical(aref->get_tensor()) ==
+					canonical(bref->get_tensor());
+			}
+			return aval->equals(*bval);
+		});
+}
+
 void merge_dups (opt::GraphInfo& graph)
 {
 	Hasher hasher;
+	teq::GraphStat stat;
 	for (auto& root : graph.roots_)
 	{
 		root->accept(hasher);
+		root->accept(stat);
 	}
-	merge_dups(graph,
-		[&](teq::TensptrT a, teq::TensptrT b)
+
+	// bucket by height so arguments are merged before their parents
+	std::vector<teq::TensT> levels;
+	for (auto& gpair : stat.graphsize_)
+	{
+		size_t height = gpair.second.upper_;
+		if (height >= levels.size())
 		{
-			return hasher.at(a.get()) == hasher.at(b.get());
-		});
+			levels.resize(height + 1);
+		}
+		levels[height].push_back(gpair.first);
+	}
+
+	global::debug("removing duplicates");
+	teq::OwnMapT converts;
+	std::unordered_map<size_t,teq::TensptrsT> buckets;
+	buckets.reserve(stat.graphsize_.size());
+	for (size_t height = 0, n = levels.size(); height < n; ++height)
+	{
+		for (teq::iTensor* tens : levels[height])
+		{
+			auto leaf = dynamic_cast<teq::iLeaf*>(tens);
+			if (nullptr != leaf && teq::IMMUTABLE != leaf->get_usage())
+			{
+				continue;
+			}
+			auto& bucket = buckets[hasher.at(tens)];
+			auto it = std::find_if(bucket.begin(), bucket.end(),
+				[&](const teq::TensptrT& rep)
+				{
+					if (nullptr != leaf)
+					{
+						auto repleaf = dynamic_cast<teq::iLeaf*>(rep.get());
+						return nullptr != repleaf &&
+							leaf_equals(*repleaf, *leaf);
+					}
+					auto repfunc = dynamic_cast<teq::iFunctor*>(rep.get());
+					return nullptr != repfunc && func_equals(*repfunc,
+						static_cast<teq::iFunctor&>(*tens), converts);
+				});
+			if (bucket.end() != it)
+			{
+				// mark equivalent node
+				converts.emplace(tens, *it);
+			}
+			else
+			{
+				bucket.push_back(graph.get_owner(tens));
+			}
+		}
+	}
+	graph.replace(converts);
 }
 
 }
@@ -10,31 +10,46 @@ using ApplyRulesF = std::function<void(opt::OptRulesT&,const TargetFactory&)>;
 static const size_t convert_round_limit = 50;
 
 static teq::TensptrsT general_optimize (
-	teq::TensptrsT roots, GenCstF gen_cst, ApplyRulesF apply_rules)
+	teq::TensptrsT roots, FoldCstF fold_cst, ApplyRulesF apply_rules)
 {
 	opt::OptRulesT rules;
 	opt::GraphInfo graph(roots);
 	merge_dups(graph); // remove duplicates to reduce search space
+	if (fold_cst)
+	{
+		fold_cst(graph);
+	}
 
 	TargetFactory impl_factory(graph);
-	if (gen_cst)
+	apply_rules(rules, impl_factory);
+	opt::RuleStatsT stats;
+	size_t nrounds = 0;
+	size_t nfolded;
+	do
 	{
-		gen_cst(rules, graph); // populate with constant rules
+		nrounds += opt::optimize(graph, rules, stats,
+			convert_round_limit - nrounds);
+		// conversions can leave operators with only constant arguments
+		nfolded = fold_cst ? fold_cst(graph) : 0;
 	}
-	apply_rules(rules, impl_factory);
-	bool converted = true;
-	for (size_t i = 0; converted && i < convert_round_limit; ++i)
+	while (nfolded > 0 && nrounds < convert_round_limit);
+	global::debugf("optimized in %d rounds", nrounds);
+	for (size_t i = 0, n = stats.size(); i < n; ++i)
 	{
-		converted = opt::optimize(graph, rules);
+		if (stats[i].matches_ > 0)
+		{
+			global::debugf("rule %d matched %d times and fired %d times",
+				i, stats[i].matches_, stats[i].fires_);
+		}
 	}
 	// apply new roots
 	return graph.get_roots();
 }
 
 teq::TensptrsT optimize (teq::TensptrsT roots,
-	const opt::Optimization& pb_opt, GenCstF gen_cst)
+	const opt::Optimization& pb_opt, FoldCstF fold_cst)
 {
-	return general_optimize(roots, gen_cst,
+	return general_optimize(roots, fold_cst,
 	[&pb_opt](opt::OptRulesT& rules, const TargetFactory& tfac)
 	{
 		opt::parse_optimization(rules, pb_opt, tfac);
@@ -42,9 +57,9 @@ teq::TensptrsT optimize (teq::TensptrsT roots,
 }
 
 teq::TensptrsT optimize (teq::TensptrsT roots,
-	std::istream& rulestr, GenCstF gen_cst)
+	std::istream& rulestr, FoldCstF fold_cst)
 {
-	return general_optimize(roots, gen_cst,
+	return general_optimize(roots, fold_cst,
 	[&rulestr](opt::OptRulesT& rules, const TargetFactory& tfac)
 	{
 		opt::json_parse(rules, rulestr, tfac);
@@ -63,9 +78,9 @@ void optimize (std::string filename, const global::CfgMapptrT& ctx)
 
 	teq::TensptrsT inroots(roots.begin(), roots.end());
 	auto outroots = optimize(inroots, rulefile,
-	[&ctx](opt::OptRulesT& rules, const opt::GraphInfo& ginfo)
+	[&ctx](opt::GraphInfo& ginfo)
 	{
-		generate_cstrules(rules, ginfo, ctx);
+		return fold_constants(ginfo, ctx);
 	});
 	assert(inroots.size() == outroots.size());
 	auto& graphinfo = eteq::get_graphinfo(ctx);
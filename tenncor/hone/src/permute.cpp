@@ -0,0 +1,486 @@
+#include "tenncor/hone/permute.hpp"
+
+#ifdef HONE_PERMUTE_HPP
+
+namespace hone
+{
+
+static const size_t permute_round_limit = 16;
+
+static const std::unordered_set<size_t> elementwise_ops = {
+	egen::ABS, egen::NEG, egen::SIN, egen::COS, egen::TAN, egen::EXP,
+	egen::LOG, egen::SQRT, egen::ROUND, egen::SIGMOID, egen::TANH,
+	egen::SQUARE, egen::CUBE, egen::POW, egen::ADD, egen::SUB, egen::MUL,
+	egen::DIV, egen::MIN, egen::MAX, egen::EQ, egen::NEQ, egen::LT,
+	egen::GT, egen::SELECT,
+};
+
+static const std::unordered_set<size_t> reduce_ops = {
+	egen::REDUCE_SUM, egen::REDUCE_PROD, egen::REDUCE_MIN, egen::REDUCE_MAX,
+};
+
+using RankFlagsT = std::array<bool,teq::rank_cap>;
+
+teq::RanksT complete_order (const teq::RanksT& order)
+{
+	RankFlagsT visited;
+	std::fill(visited.begin(), visited.end(), false);
+	teq::RanksT out;
+	out.reserve(teq::rank_cap);
+	for (size_t i = 0, n = std::min(order.size(),
+		(size_t) teq::rank_cap); i < n; ++i)
+	{
+		out.push_back(order[i]);
+		visited[order[i]] = true;
+	}
+	for (teq::RankT i = 0; i < teq::rank_cap; ++i)
+	{
+		if (false == visited[i])
+		{
+			out.push_back(i);
+		}
+	}
+	return out;
+}
+
+static teq::iFunctor* as_permute (const teq::TensptrT& tens)
+{
+	auto func = dynamic_cast<teq::iFunctor*>(tens.get());
+	if (nullptr == func || egen::PERMUTE != func->get_opcode().code_)
+	{
+		return nullptr;
+	}
+	return func;
+}
+
+static teq::RanksT get_order (const teq::iFunctor& permute)
+{
+	teq::RanksT order;
+	eigen::Packer<teq::RanksT>().unpack(order, permute);
+	return complete_order(order);
+}
+
+static bool is_identity (const teq::RanksT& order)
+{
+	for (teq::RankT i = 0; i < teq::rank_cap; ++i)
+	{
+		if (order[i] != i)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+/// Return true if permuting shape by order only moves dimensions of size 1,
+/// so the permuted data has the same layout
+static bool is_reshape (const teq::RanksT& order, const teq::Shape& shape)
+{
+	int prev = -1;
+	for (teq::RankT i = 0; i < teq::rank_cap; ++i)
+	{
+		int rank = order[i];
+		if (shape.at(rank) > 1)
+		{
+			if (rank < prev)
+			{
+				return false;
+			}
+			prev = rank;
+		}
+	}
+	return true;
+}
+
+/// Populate pairs with contraction dimensions if func is a CONTRACT
+/// or MATMUL of matrices, otherwise return false
+static bool get_contraction (
+	eigen::PairVecT<teq::RankT>& pairs, const teq::iFunctor& func)
+{
+	auto opcode = func.get_opcode().code_;
+	if (egen::CONTRACT == opcode)
+	{
+		eigen::Packer<eigen::PairVecT<teq::RankT>>().unpack(pairs, func);
+		return true;
+	}
+	if (egen::MATMUL == opcode)
+	{
+		auto args = func.get_args();
+		if (std::all_of(args.begin(), args.end(),
+			[](teq::TensptrT arg)
+			{
+				return teq::narrow_shape(arg->shape()).size() <= 2;
+			}))
+		{
+			pairs = {{0, 1}};
+			return true;
+		}
+	}
+	return false;
+}
+
+/// Return uncontracted ranks of shape in ascending order
+static teq::RanksT free_ranks (const teq::Shape& shape, const RankFlagsT& common)
+{
+	teq::RanksT out;
+	for (teq::RankT i = 0, n = teq::narrow_shape(shape).size(); i < n; ++i)
+	{
+		if (false == common[i])
+		{
+			out.push_back(i);
+		}
+	}
+	return out;
+}
+
+/// Map contracted ranks of permuted operand to ranks of the unpermuted operand
+/// Return false if contracting the unpermuted operand reorders output dimensions
+static bool fold_operand (teq::RanksT& ranks, const teq::RanksT& order,
+	const teq::Shape& permuted, const teq::Shape& unpermuted)
+{
+	size_t npermuted = teq::narrow_shape(permuted).size();
+	size_t nunpermuted = teq::narrow_shape(unpermuted).size();
+	RankFlagsT pcommon;
+	RankFlagsT ucommon;
+	std::fill(pcommon.begin(), pcommon.end(), false);
+	std::fill(ucommon.begin(), ucommon.end(), false);
+	teq::RanksT out;
+	out.reserve(ranks.size());
+	for (teq::RankT rank : ranks)
+	{
+		teq::RankT urank = order[rank];
+		if (rank >= npermuted || urank >= nunpermuted)
+		{
+			return false;
+		}
+		pcommon[rank] = ucommon[urank] = true;
+		out.push_back(urank);
+	}
+	teq::RanksT pfree = free_ranks(permuted, pcommon);
+	for (teq::RankT& rank : pfree)
+	{
+		rank = order[rank];
+	}
+	if (pfree != free_ranks(unpermuted, ucommon))
+	{
+		return false;
+	}
+	ranks = out;
+	return true;
+}
+
+/// Rewrites functors whose arguments are already rewritten into converts
+struct PermuteRewriter final
+{
+	PermuteRewriter (const opt::GraphInfo& graph,
+		const teq::OwnMapT& converts) : graph_(&graph), converts_(&converts)
+	{
+		for (const teq::TensptrT& root : graph.roots_)
+		{
+			roots_.emplace(root.get());
+		}
+	}
+
+	/// Return rewritten func or nullptr if func is unchanged
+	teq::TensptrT rewrite (teq::iFunctor& func) const
+	{
+		auto args = func.get_args();
+		for (auto& arg : args)
+		{
+			arg = converted(arg);
+		}
+		auto opcode = func.get_opcode().code_;
+		teq::TensptrT out;
+		if (egen::PERMUTE == opcode)
+		{
+			out = rewrite_permute(func, args.front());
+		}
+		else if (estd::has(reduce_ops, opcode))
+		{
+			out = rewrite_reduce(func, args.front());
+		}
+		else if (args.size() == 2)
+		{
+			out = rewrite_contract(func, args);
+		}
+		if (nullptr != out && false == out->shape().compatible_after(
+			func.shape(), 0))
+		{
+			global::fatalf("rewriting %s changed shape %s to %s",
+				func.to_string().c_str(),
+				func.shape().to_string().c_str(),
+				out->shape().to_string().c_str());
+		}
+		return out;
+	}
+
+private:
+	teq::TensptrT converted (const teq::TensptrT& tens) const
+	{
+		return estd::try_get(*converts_, tens.get(), tens);
+	}
+
+	/// Return true if tens is only used once as an argument
+	bool single_use (teq::iTensor* tens) const
+	{
+		if (estd::has(roots_, tens))
+		{
+			return false;
+		}
+		auto it = graph_->parents_.find(tens);
+		if (graph_->parents_.end() == it || 1 != it->second.size())
+		{
+			return false;
+		}
+		auto& dir = it->second.begin()->second;
+		return 1 == dir.args_.size() && dir.attrs_.empty();
+	}
+
+	/// Return tens permuted by order merging with permutes of tens
+	teq::TensptrT permute (const teq::TensptrT& tens, teq::RanksT order) const
+	{
+		teq::TensptrT target = tens;
+		if (auto inner = as_permute(target))
+		{
+			teq::RanksT inner_order = get_order(*inner);
+			for (teq::RankT& rank : order)
+			{
+				rank = inner_order[rank];
+			}
+			target = converted(inner->get_args().front());
+		}
+		if (is_identity(order))
+		{
+			return target;
+		}
+		return eteq::make_functor(egen::PERMUTE, {target}, order);
+	}
+
+	teq::TensptrT rewrite_permute (teq::iFunctor& func,
+		const teq::TensptrT& arg) const
+	{
+		teq::RanksT order = get_order(func);
+		if (as_permute(arg) || is_identity(order))
+		{
+			return permute(arg, order);
+		}
+		if (is_reshape(order, arg->shape()))
+		{
+			return eteq::make_functor(egen::RESHAPE, {arg}, func.shape());
+		}
+		auto afunc = dynamic_cast<teq::iFunctor*>(arg.get());
+		if (nullptr == afunc || false == single_use(arg.get()))
+		{
+			return nullptr;
+		}
+		auto opcode = afunc->get_opcode().code_;
+		auto aargs = afunc->get_args();
+		for (auto& aarg : aargs)
+		{
+			aarg = converted(aarg);
+		}
+
+		eigen::PairVecT<teq::RankT> pairs;
+		if (get_contraction(pairs, *afunc))
+		{
+			// contract(a, b) has shape [free(b), free(a)], so
+			// permuting to [free(a), free(b)] is contract(b, a)
+			RankFlagsT lcommon;
+			RankFlagsT rcommon;
+			std::fill(lcommon.begin(), lcommon.end(), false);
+			std::fill(rcommon.begin(), rcommon.end(), false);
+			for (auto& pair : pairs)
+			{
+				lcommon[pair.first] = rcommon[pair.second] = true;
+			}
+			size_t nlfree = free_ranks(aargs[0]->shape(), lcommon).size();
+			size_t nrfree = free_ranks(aargs[1]->shape(), rcommon).size();
+			teq::RanksT swapped;
+			for (size_t i = 0; i < nlfree; ++i)
+			{
+				swapped.push_back(nrfree + i);
+			}
+			for (size_t i = 0; i < nrfree; ++i)
+			{
+				swapped.push_back(i);
+			}
+			if (complete_order(swapped) != order)
+			{
+				return nullptr;
+			}
+			for (auto& pair : pairs)
+			{
+				std::swap(pair.first, pair.second);
+			}
+			return eteq::make_functor(egen::CONTRACT,
+				{aargs[1], aargs[0]}, pairs);
+		}
+
+		// push permute through elementwise operator if that removes permutes
+		if (false == estd::has(elementwise_ops, opcode) ||
+			std::none_of(aargs.begin(), aargs.end(),
+				[](const teq::TensptrT& aarg)
+				{
+					return nullptr != as_permute(aarg);
+				}) ||
+			false == std::all_of(aargs.begin(), aargs.end(),
+				[&arg](const teq::TensptrT& aarg)
+				{
+					auto leaf = dynamic_cast<teq::iLeaf*>(aarg.get());
+					return aarg->shape().compatible_after(arg->shape(), 0) &&
+						(nullptr != as_permute(aarg) || (nullptr != leaf &&
+						teq::IMMUTABLE == leaf->get_usage()));
+				}))
+		{
+			return nullptr;
+		}
+		teq::TensptrsT pargs;
+		pargs.reserve(aargs.size());
+		for (const teq::TensptrT& aarg : aargs)
+		{
+			pargs.push_back(permute(aarg, order));
+		}
+		return eteq::make_functor((egen::_GENERATED_OPCODE) opcode, pargs);
+	}
+
+	teq::TensptrT rewrite_reduce (teq::iFunctor& func,
+		const teq::TensptrT& arg) const
+	{
+		auto perm = as_permute(arg);
+		if (nullptr == perm)
+		{
+			return nullptr;
+		}
+		std::set<teq::RankT> ranks;
+		eigen::Packer<std::set<teq::RankT>>().unpack(ranks, func);
+		teq::RanksT order = get_order(*perm);
+		teq::Shape shape = arg->shape();
+		std::set<teq::RankT> uranks;
+		int prev = -1;
+		for (teq::RankT i = 0; i < teq::rank_cap; ++i)
+		{
+			if (estd::has(ranks, i))
+			{
+				uranks.emplace(order[i]);
+			}
+			else if (shape.at(i) > 1)
+			{
+				// remaining dimensions must keep their order
+				if (order[i] < prev)
+				{
+					return nullptr;
+				}
+				prev = order[i];
+			}
+		}
+		teq::TensptrT reduced = eteq::make_functor(
+			(egen::_GENERATED_OPCODE) func.get_opcode().code_,
+			{converted(perm->get_args().front())}, uranks);
+		if (reduced->shape().compatible_after(func.shape(), 0))
+		{
+			return reduced;
+		}
+		return eteq::make_functor(egen::RESHAPE, {reduced}, func.shape());
+	}
+
+	teq::TensptrT rewrite_contract (teq::iFunctor& func,
+		const teq::TensptrsT& args) const
+	{
+		eigen::PairVecT<teq::RankT> pairs;
+		if (false == get_contraction(pairs, func))
+		{
+			return nullptr;
+		}
+		teq::RanksT lranks;
+		teq::RanksT rranks;
+		for (auto& pair : pairs)
+		{
+			lranks.push_back(pair.first);
+			rranks.push_back(pair.second);
+		}
+		teq::TensptrT lhs = args[0];
+		teq::TensptrT rhs = args[1];
+		bool changed = false;
+		if (auto perm = as_permute(lhs))
+		{
+			auto inner = converted(perm->get_args().front());
+			if (fold_operand(lranks, get_order(*perm),
+				lhs->shape(), inner->shape()))
+			{
+				lhs = inner;
+				changed = true;
+			}
+		}
+		if (auto perm = as_permute(rhs))
+		{
+			auto inner = converted(perm->get_args().front());
+			if (fold_operand(rranks, get_order(*perm),
+				rhs->shape(), inner->shape()))
+			{
+				rhs = inner;
+				changed = true;
+			}
+		}
+		if (false == changed)
+		{
+			return nullptr;
+		}
+		for (size_t i = 0, n = pairs.size(); i < n; ++i)
+		{
+			pairs[i] = {lranks[i], rranks[i]};
+		}
+		return eteq::make_functor(egen::CONTRACT, {lhs, rhs}, pairs);
+	}
+
+	const opt::GraphInfo* graph_;
+
+	const teq::OwnMapT* converts_;
+
+	teq::TensSetT roots_;
+};
+
+size_t eliminate_permutes (opt::GraphInfo& graph)
+{
+	size_t nrewrites = 0;
+	for (size_t i = 0; i < permute_round_limit; ++i)
+	{
+		teq::GraphStat stat;
+		teq::multi_visit(stat, graph.roots_);
+		std::vector<teq::iFunctor*> funcs;
+		for (const auto& owner : graph.get_owners())
+		{
+			auto func = dynamic_cast<teq::iFunctor*>(owner.first);
+			if (nullptr != func && estd::has(stat.graphsize_, func))
+			{
+				funcs.push_back(func);
+			}
+		}
+		// rewrite from the bottom so parents see rewritten arguments
+		std::sort(funcs.begin(), funcs.end(),
+			[&stat](teq::iFunctor* a, teq::iFunctor* b)
+			{
+				return stat.graphsize_.at(a).upper_ < stat.graphsize_.at(b).upper_;
+			});
+
+		teq::OwnMapT converts;
+		PermuteRewriter rewriter(graph, converts);
+		for (teq::iFunctor* func : funcs)
+		{
+			if (auto out = rewriter.rewrite(*func))
+			{
+				converts.emplace(func, out);
+			}
+		}
+		if (converts.empty())
+		{
+			break;
+		}
+		graph.replace(converts);
+		nrewrites += converts.size();
+	}
+	return nrewrites;
+}
+
+}
+
+#endif
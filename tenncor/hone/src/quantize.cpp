@@ -0,0 +1,272 @@
+#include "tenncor/hone/quantize.hpp"
+
+#ifdef HONE_QUANTIZE_HPP
+
+namespace hone
+{
+
+static bool is_real (size_t dtype)
+{
+	switch (dtype)
+	{
+		case egen::DOUBLE:
+		case egen::FLOAT:
+#ifdef EGEN_FULLTYPE
+		case egen::FLOAT16:
+		case egen::BFLOAT16:
+#endif // EGEN_FULLTYPE
+			return true;
+		default:
+			break;
+	}
+	return false;
+}
+
+/// Return true if func is MATMUL, CONV2D or CONTRACT equivalent to MATMUL
+/// of matrices, where the first argument is real and the second
+/// argument is a real constant
+static bool is_quantizable (const teq::iFunctor& func)
+{
+	auto opcode = func.get_opcode().code_;
+	auto args = func.get_args();
+	if (egen::CONTRACT == opcode)
+	{
+		eigen::PairVecT<teq::RankT> pairs;
+		eigen::Packer<eigen::PairVecT<teq::RankT>>().unpack(pairs, func);
+		if (pairs != eigen::PairVecT<teq::RankT>{{0, 1}} ||
+			std::any_of(args.begin(), args.end(),
+			[](teq::TensptrT arg)
+			{
+				return teq::narrow_shape(arg->shape()).size() > 2;
+			}))
+		{
+			return false;
+		}
+	}
+	else if (egen::MATMUL != opcode && egen::CONV2D != opcode)
+	{
+		return false;
+	}
+	if (false == is_real(func.get_meta().type_code()) ||
+		false == is_real(args[0]->get_meta().type_code()) ||
+		false == is_real(args[1]->get_meta().type_code()))
+	{
+		return false;
+	}
+	auto weight = dynamic_cast<teq::iLeaf*>(args[1].get());
+	return nullptr != weight && teq::IMMUTABLE == weight->get_usage();
+}
+
+static std::vector<teq::iFunctor*> quantizable_funcs (const opt::GraphInfo& graph)
+{
+	teq::GraphStat stat;
+	teq::multi_visit(stat, graph.roots_);
+	std::vector<teq::iFunctor*> funcs;
+	for (const auto& owner : graph.get_owners())
+	{
+		auto func = dynamic_cast<teq::iFunctor*>(owner.first);
+		if (nullptr != func && estd::has(stat.graphsize_, func) &&
+			is_quantizable(*func))
+		{
+			funcs.push_back(func);
+		}
+	}
+	// rewrite from the bottom so parents see rewritten arguments
+	std::sort(funcs.begin(), funcs.end(),
+		[&stat](teq::iFunctor* a, teq::iFunctor* b)
+		{
+			return stat.graphsize_.at(a).upper_ < stat.graphsize_.at(b).upper_;
+		});
+	return funcs;
+}
+
+template <typename T>
+static bool stabilized_range (estd::NumRange<double>& out, teq::iTensor& tens)
+{
+	eigen::Stabilizer<T> stab;
+	tens.accept(stab);
+	auto range = stab.ranges_.at(&tens);
+	if (range.lower_ <= std::numeric_limits<T>::lowest() ||
+		range.upper_ >= std::numeric_limits<T>::max())
+	{
+		return false;
+	}
+	out = estd::NumRange<double>(range.lower_, range.upper_);
+	return true;
+}
+
+/// Populate scale of symmetrically quantized activation in range
+/// Return false if activation has no known finite range
+static bool activation_scale (double& scale,
+	teq::iTensor& act, const QuantRangesT& ranges)
+{
+	estd::NumRange<double> range;
+	if (estd::has(ranges, &act))
+	{
+		range = ranges.at(&act);
+	}
+	else
+	{
+		bool bounded = false;
+		switch (act.get_meta().type_code())
+		{
+			case egen::DOUBLE:
+				bounded = stabilized_range<double>(range, act);
+				break;
+			case egen::FLOAT:
+				bounded = stabilized_range<float>(range, act);
+				break;
+			default:
+				break;
+		}
+		if (false == bounded)
+		{
+			return false;
+		}
+	}
+	double absmax = std::max(std::abs(range.lower_), std::abs(range.upper_));
+	scale = absmax > 0 ? absmax / eigen::quant_limit : 1.;
+	return true;
+}
+
+/// Return constant of weight symmetrically quantized with one scale per
+/// channel where channel c holds elements at every flat index i
+/// such that i % nchannels == c, and populate scales
+static teq::TensptrT quantize_weight (eigen::CoefsT& scales,
+	teq::iTensor& weight, size_t nchannels)
+{
+	teq::Shape shape = weight.shape();
+	size_t n = shape.n_elems();
+	std::vector<double> data(n);
+	egen::type_convert(data.data(), weight.device().data(),
+		(egen::_GENERATED_DTYPE) weight.get_meta().type_code(), n);
+
+	scales = eigen::CoefsT(nchannels, 0);
+	for (size_t i = 0; i < n; ++i)
+	{
+		double& absmax = scales[i % nchannels];
+		absmax = std::max(absmax, std::abs(data[i]));
+	}
+	for (double& scale : scales)
+	{
+		scale = scale > 0 ? scale / eigen::quant_limit : 1.;
+	}
+	std::vector<eigen::QuantT> qdata(n);
+	for (size_t i = 0; i < n; ++i)
+	{
+		qdata[i] = (eigen::QuantT) std::round(data[i] / scales[i % nchannels]);
+	}
+	return eteq::make_constant_tensor<eigen::QuantT>(qdata.data(), shape);
+}
+
+teq::TensptrsT calibration_targets (const opt::GraphInfo& graph)
+{
+	teq::TensptrsT targets;
+	teq::TensSetT visited;
+	for (teq::iFunctor* func : quantizable_funcs(graph))
+	{
+		auto act = func->get_args().front();
+		if (false == estd::has(visited, act.get()))
+		{
+			visited.emplace(act.get());
+			targets.push_back(act);
+		}
+	}
+	return targets;
+}
+
+void calibrate (QuantRangesT& ranges, const teq::TensptrsT& targets,
+	const global::CfgMapptrT& ctx)
+{
+	teq::TensSetT evals;
+	for (auto& target : targets)
+	{
+		evals.emplace(target.get());
+	}
+	eigen::Device device(eigen::get_runtime(ctx));
+	teq::get_eval(ctx).evaluate(device, evals);
+	for (auto& target : targets)
+	{
+		size_t n = target->shape().n_elems();
+		std::vector<double> data(n);
+		egen::type_convert(data.data(), target->device().data(),
+			(egen::_GENERATED_DTYPE) target->get_meta().type_code(), n);
+		auto minmax = std::minmax_element(data.begin(), data.end());
+		estd::NumRange<double> observed(*minmax.first, *minmax.second);
+		auto it = ranges.find(target.get());
+		if (ranges.end() == it)
+		{
+			ranges.emplace(target.get(), observed);
+		}
+		else
+		{
+			it->second = estd::NumRange<double>(
+				std::min(it->second.lower_, observed.lower_),
+				std::max(it->second.upper_, observed.upper_));
+		}
+	}
+}
+
+size_t quantize (opt::GraphInfo& graph,
+	const QuantRangesT& ranges, bool per_channel)
+{
+	teq::OwnMapT converts;
+	teq::TensMapT<teq::TensptrT> quantized;
+	for (teq::iFunctor* func : quantizable_funcs(graph))
+	{
+		auto args = func->get_args();
+		teq::TensptrT act = args[0];
+		teq::TensptrT weight = args[1];
+		double act_scale;
+		if (false == activation_scale(act_scale, *act, ranges))
+		{
+			global::warnf("cannot quantize %s without range of activation %s",
+				func->to_string().c_str(), act->to_string().c_str());
+			continue;
+		}
+		// channels of MATMUL and CONV2D outputs are the first dimension
+		// of their weights
+		eigen::CoefsT multipliers;
+		auto qweight = quantize_weight(multipliers, *weight,
+			per_channel ? weight->shape().at(0) : 1);
+		for (double& multiplier : multipliers)
+		{
+			multiplier *= act_scale;
+		}
+
+		if (false == estd::has(quantized, act.get()))
+		{
+			teq::TensptrT input = act;
+			if (estd::has(converts, act.get()))
+			{
+				input = converts.at(act.get());
+			}
+			quantized.emplace(act.get(), eteq::make_functor(
+				egen::QUANTIZE, {input}, eigen::CoefsT{act_scale}));
+		}
+		auto qact = quantized.at(act.get());
+
+		marsh::Maps attrs;
+		egen::_GENERATED_OPCODE opcode = egen::QUANT_MATMUL;
+		if (egen::CONV2D == func->get_opcode().code_)
+		{
+			opcode = egen::QUANT_CONV2D;
+			for (auto& key : func->ls_attrs())
+			{
+				attrs.add_attr(key, marsh::ObjptrT(func->get_attr(key)->clone()));
+			}
+		}
+		eigen::pack_attr(attrs, multipliers,
+			(egen::_GENERATED_DTYPE) func->get_meta().type_code());
+		converts.emplace(func, eteq::make_funcattr(opcode, {qact, qweight}, attrs));
+	}
+	if (converts.size() > 0)
+	{
+		graph.replace(converts);
+	}
+	return converts.size();
+}
+
+}
+
+#endif
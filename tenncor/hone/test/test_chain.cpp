@@ -0,0 +1,120 @@
+#ifndef DISABLE_HONE_CHAIN_TEST
+
+
+#include "gtest/gtest.h"
+
+#include "testutil/tutil.hpp"
+
+#include "tenncor/hone/hone.hpp"
+
+
+static std::vector<double> chain_data (size_t n)
+{
+	std::vector<double> out(n);
+	for (size_t i = 0; i < n; ++i)
+	{
+		out[i] = (i % 7) - 3;
+	}
+	return out;
+}
+
+
+TEST(CHAIN, Reorder)
+{
+	// a[10, 100] * (b[100, 5] * c[5, 50]) costs 75000 multiplications
+	// (a * b) * c costs 7500 multiplications
+	teq::Shape ashape({100, 10});
+	teq::Shape bshape({5, 100});
+	teq::Shape cshape({50, 5});
+	auto adata = chain_data(ashape.n_elems());
+	auto bdata = chain_data(bshape.n_elems());
+	auto cdata = chain_data(cshape.n_elems());
+
+	teq::TensptrT a = eteq::make_variable<double>(adata.data(), ashape, "a");
+	teq::TensptrT b = eteq::make_variable<double>(bdata.data(), bshape, "b");
+	teq::TensptrT c = eteq::make_variable<double>(cdata.data(), cshape, "c");
+
+	teq::TensptrT bc(eteq::make_functor(egen::MATMUL, {b, c}));
+	teq::TensptrT root(eteq::make_functor(egen::MATMUL, {a, bc}));
+
+	opt::GraphInfo graph({root});
+	EXPECT_EQ(1, hone::reorder_matmuls(graph));
+	EXPECT_EQ(0, hone::reorder_matmuls(graph));
+	ASSERT_EQ(1, graph.roots_.size());
+	auto out = graph.roots_.front();
+	EXPECT_GRAPHEQ(
+		"(MATMUL<DOUBLE>[50\\10\\1\\1\\1\\1\\1\\1])\n"
+		"_`--(MATMUL<DOUBLE>[5\\10\\1\\1\\1\\1\\1\\1])\n"
+		"_|___`--(variable:a<DOUBLE>[100\\10\\1\\1\\1\\1\\1\\1])\n"
+		"_|___`--(variable:b<DOUBLE>[5\\100\\1\\1\\1\\1\\1\\1])\n"
+		"_`--(variable:c<DOUBLE>[50\\5\\1\\1\\1\\1\\1\\1])\n", out);
+
+	eteq::ETensor(root).calc<double>();
+	eteq::ETensor(out).calc<double>();
+	EXPECT_TENSDATA(root, out, double);
+}
+
+
+TEST(CHAIN, SharedProduct)
+{
+	teq::Shape ashape({100, 10});
+	teq::Shape bshape({5, 100});
+	teq::Shape cshape({50, 5});
+	auto adata = chain_data(ashape.n_elems());
+	auto bdata = chain_data(bshape.n_elems());
+	auto cdata = chain_data(cshape.n_elems());
+
+	teq::TensptrT a = eteq::make_variable<double>(adata.data(), ashape, "a");
+	teq::TensptrT b = eteq::make_variable<double>(bdata.data(), bshape, "b");
+	teq::TensptrT c = eteq::make_variable<double>(cdata.data(), cshape, "c");
+
+	// reordering would recompute the shared product
+	teq::TensptrT bc(eteq::make_functor(egen::MATMUL, {b, c}));
+	teq::TensptrT root(eteq::make_functor(egen::MATMUL, {a, bc}));
+
+	opt::GraphInfo graph({root, bc});
+	EXPECT_EQ(0, hone::reorder_matmuls(graph));
+	EXPECT_EQ(root, graph.roots_.front());
+}
+
+
+TEST(CHAIN, Transpose)
+{
+	// transpose(b[100, 5] * a[5, 10]) * c[100, 2]
+	// reorders to a^T * (b^T * c) by pushing the transpose to the operands
+	teq::Shape ashape({10, 5});
+	teq::Shape bshape({5, 100});
+	teq::Shape cshape({2, 100});
+	auto adata = chain_data(ashape.n_elems());
+	auto bdata = chain_data(bshape.n_elems());
+	auto cdata = chain_data(cshape.n_elems());
+
+	teq::TensptrT a = eteq::make_variable<double>(adata.data(), ashape, "a");
+	teq::TensptrT b = eteq::make_variable<double>(bdata.data(), bshape, "b");
+	teq::TensptrT c = eteq::make_variable<double>(cdata.data(), cshape, "c");
+
+	teq::TensptrT ba(eteq::make_functor(egen::MATMUL, {b, a}));
+	teq::TensptrT tba(eteq::make_functor(egen::PERMUTE,
+		teq::TensptrsT{ba}, teq::RanksT{1, 0}));
+	teq::TensptrT root(eteq::make_functor(egen::MATMUL, {tba, c}));
+
+	opt::GraphInfo graph({root});
+	EXPECT_EQ(1, hone::reorder_matmuls(graph));
+	ASSERT_EQ(1, graph.roots_.size());
+	auto out = graph.roots_.front();
+	EXPECT_GRAPHEQ(
+		"(MATMUL<DOUBLE>[2\\10\\1\\1\\1\\1\\1\\1])\n"
+		"_`--(PERMUTE<DOUBLE>[5\\10\\1\\1\\1\\1\\1\\1])\n"
+		"_|___`--(variable:a<DOUBLE>[10\\5\\1\\1\\1\\1\\1\\1])\n"
+		"_`--(MATMUL<DOUBLE>[2\\5\\1\\1\\1\\1\\1\\1])\n"
+		"_____`--(PERMUTE<DOUBLE>[100\\5\\1\\1\\1\\1\\1\\1])\n"
+		"_____|___`--(variable:b<DOUBLE>[5\\100\\1\\1\\1\\1\\1\\1])\n"
+		"_____`--(variable:c<DOUBLE>[2\\100\\1\\1\\1\\1\\1\\1])\n", out);
+
+	eteq::ETensor(root).calc<double>();
+	eteq::ETensor(out).calc<double>();
+	EXPECT_TENSDATA(root, out, double);
+}
+
+
+#endif // DISABLE_HONE_CHAIN_TEST
@@ -130,4 +130,42 @@ TEST(CSTRULES, IdentityDependency)
 }
 
 
+TEST(CSTRULES, FoldMaximal)
+{
+	teq::DimsT slist = {2, 3};
+	std::vector<double> data = {1, 2, 3, 4, 5, 6};
+	teq::Shape shape(slist);
+
+	teq::TensptrT a = eteq::make_variable<double>(data.data(), shape, "a");
+	teq::TensptrT b = eteq::make_constant<double>(data.data(), shape);
+	teq::TensptrT c = eteq::make_constant_scalar<double>(2, shape);
+
+	// two disjoint constant subgraphs, each deeper than one operator
+	teq::TensptrT lcst(eteq::make_functor(egen::NEG,
+		{teq::TensptrT(eteq::make_functor(egen::ADD, {b, c}))}));
+	teq::TensptrT rcst(eteq::make_functor(egen::MUL,
+		{teq::TensptrT(eteq::make_functor(egen::SUB, {b, c})), c}));
+	teq::TensptrT lhs(eteq::make_functor(egen::ADD, {a, lcst}));
+	teq::TensptrT root(eteq::make_functor(egen::MUL, {lhs, rcst}));
+
+	opt::GraphInfo graph({root});
+	auto cstroots = hone::find_constant_roots(graph);
+	teq::TensSetT cstset(cstroots.begin(), cstroots.end());
+	ASSERT_EQ(2, cstset.size());
+	EXPECT_HAS(cstset, lcst.get());
+	EXPECT_HAS(cstset, rcst.get());
+
+	EXPECT_EQ(2, hone::fold_constants(graph));
+	EXPECT_EQ(0, hone::fold_constants(graph));
+	ASSERT_EQ(1, graph.roots_.size());
+	EXPECT_GRAPHEQ(
+		"(MUL<DOUBLE>[2\\3\\1\\1\\1\\1\\1\\1])\n"
+		"_`--(ADD<DOUBLE>[2\\3\\1\\1\\1\\1\\1\\1])\n"
+		"_|___`--(variable:a<DOUBLE>[2\\3\\1\\1\\1\\1\\1\\1])\n"
+		"_|___`--(constant:[-3\\-4\\-5\\-6\\-7\\...]<DOUBLE>[2\\3\\1\\1\\1\\1\\1\\1])\n"
+		"_`--(constant:[-2\\0\\2\\4\\6\\...]<DOUBLE>[2\\3\\1\\1\\1\\1\\1\\1])\n",
+		graph.roots_.front());
+}
+
+
 #endif // DISABLE_HONE_CSTRULES_TEST
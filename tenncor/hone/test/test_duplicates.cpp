@@ -0,0 +1,98 @@
+
+#ifndef DISABLE_HONE_DUPLICATES_TEST
+
+
+#include <numeric>
+
+#include "gtest/gtest.h"
+
+#include "testutil/tutil.hpp"
+
+#include "tenncor/hone/hone.hpp"
+
+
+TEST(DUPLICATES, Hasher)
+{
+	teq::Shape shape({3, 4});
+	std::vector<double> data(shape.n_elems());
+	std::iota(data.begin(), data.end(), 0);
+	std::vector<double> data2 = data;
+	data2.back() = -1;
+
+	teq::TensptrT a = eteq::make_constant<double>(data.data(), shape);
+	teq::TensptrT a2 = eteq::make_constant<double>(data.data(), shape);
+	teq::TensptrT b = eteq::make_constant<double>(data2.data(), shape);
+	teq::TensptrT v = eteq::make_variable<double>(data.data(), shape);
+	teq::TensptrT v2 = eteq::make_variable<double>(data.data(), shape);
+
+	teq::TensptrT lhs(eteq::make_functor(egen::ADD, {a, v}));
+	teq::TensptrT rhs(eteq::make_functor(egen::ADD, {v, a2}));
+	teq::TensptrT sub(eteq::make_functor(egen::SUB, {a, v}));
+	teq::TensptrT sub2(eteq::make_functor(egen::SUB, {v, a2}));
+	teq::TensptrT other(eteq::make_functor(egen::ADD, {b, v2}));
+
+	hone::Hasher hasher;
+	teq::multi_visit(hasher, teq::TensptrsT{lhs, rhs, sub, sub2, other});
+
+	// constants hash by content and variables by identity
+	EXPECT_EQ(hasher.at(a.get()), hasher.at(a2.get()));
+	EXPECT_NE(hasher.at(a.get()), hasher.at(b.get()));
+	EXPECT_NE(hasher.at(v.get()), hasher.at(v2.get()));
+
+	// commutative arguments are unordered
+	EXPECT_EQ(hasher.at(lhs.get()), hasher.at(rhs.get()));
+	EXPECT_NE(hasher.at(sub.get()), hasher.at(sub2.get()));
+	EXPECT_NE(hasher.at(lhs.get()), hasher.at(other.get()));
+
+	// content hashes are cached on constants
+	auto cst = dynamic_cast<eteq::iConstant*>(a.get());
+	ASSERT_NE(nullptr, cst);
+	EXPECT_EQ(eteq::hash_data(*a), cst->content_hash());
+}
+
+
+TEST(DUPLICATES, MergeDups)
+{
+	teq::Shape shape({3, 4});
+	std::vector<double> data(shape.n_elems());
+	std::iota(data.begin(), data.end(), 0);
+
+	teq::TensptrT a = eteq::make_constant<double>(data.data(), shape);
+	teq::TensptrT a2 = eteq::make_constant<double>(data.data(), shape);
+	teq::TensptrT v = eteq::make_variable<double>(data.data(), shape);
+	teq::TensptrT v2 = eteq::make_variable<double>(data.data(), shape);
+
+	teq::TensptrT lhs(eteq::make_functor(egen::ADD, {a, v}));
+	teq::TensptrT rhs(eteq::make_functor(egen::ADD, {v, a2}));
+	teq::TensptrT distinct(eteq::make_functor(egen::ADD, {a2, v2}));
+	teq::TensptrT root(eteq::make_functor(egen::MUL, {lhs, rhs}));
+	teq::TensptrT root2(eteq::make_functor(egen::MUL, {root, distinct}));
+
+	opt::GraphInfo graph({root2});
+	hone::merge_dups(graph);
+	ASSERT_EQ(1, graph.roots_.size());
+
+	auto f = std::dynamic_pointer_cast<teq::iFunctor>(graph.roots_.front());
+	ASSERT_NE(nullptr, f);
+	auto args = f->get_args();
+	ASSERT_EQ(2, args.size());
+	auto mul = std::dynamic_pointer_cast<teq::iFunctor>(args[0]);
+	ASSERT_NE(nullptr, mul);
+	auto adds = mul->get_args();
+	ASSERT_EQ(2, adds.size());
+	EXPECT_EQ(adds[0], adds[1]);
+
+	// distinct variable keeps the sum apart, but shares the merged constant
+	auto dadd = std::dynamic_pointer_cast<teq::iFunctor>(args[1]);
+	ASSERT_NE(nullptr, dadd);
+	EXPECT_NE(adds[0], dadd);
+	auto sum = std::static_pointer_cast<teq::iFunctor>(adds[0]);
+	auto sargs = sum->get_args();
+	auto dargs = dadd->get_args();
+	teq::TensSetT csts = {sargs[0].get(), sargs[1].get(),
+		dargs[0].get(), dargs[1].get()};
+	EXPECT_EQ(3, csts.size());
+}
+
+
+#endif // DISABLE_HONE_DUPLICATES_TEST
@@ -0,0 +1,119 @@
+#ifndef DISABLE_HONE_PERMUTE_TEST
+
+
+#include <numeric>
+
+#include "gtest/gtest.h"
+
+#include "testutil/tutil.hpp"
+
+#include "tenncor/hone/hone.hpp"
+
+
+static size_t count_permutes (const teq::TensptrsT& roots)
+{
+	teq::GraphStat stat;
+	teq::multi_visit(stat, roots);
+	return std::count_if(stat.graphsize_.begin(), stat.graphsize_.end(),
+		[](const auto& gpair)
+		{
+			auto func = dynamic_cast<teq::iFunctor*>(gpair.first);
+			return nullptr != func &&
+				egen::PERMUTE == func->get_opcode().code_;
+		});
+}
+
+
+static std::vector<double> calc_data (const teq::TensptrT& tens)
+{
+	double* ptr = eteq::ETensor(tens).calc<double>();
+	return std::vector<double>(ptr, ptr + tens->shape().n_elems());
+}
+
+
+TEST(PERMUTE, Cancel)
+{
+	teq::Shape shape({3, 2});
+	std::vector<double> data(shape.n_elems());
+	std::iota(data.begin(), data.end(), 0);
+
+	teq::TensptrT x = eteq::make_variable<double>(data.data(), shape, "x");
+	teq::TensptrT t(eteq::make_functor(egen::PERMUTE, {x}, teq::RanksT{1, 0}));
+	teq::TensptrT tt(eteq::make_functor(egen::PERMUTE, {t}, teq::RanksT{1, 0}));
+	teq::TensptrT root(eteq::make_functor(egen::NEG, {tt}));
+
+	opt::GraphInfo graph({root});
+	EXPECT_LT(0, hone::eliminate_permutes(graph));
+	ASSERT_EQ(1, graph.roots_.size());
+	EXPECT_GRAPHEQ(
+		"(NEG<DOUBLE>[3\\2\\1\\1\\1\\1\\1\\1])\n"
+		"_`--(variable:x<DOUBLE>[3\\2\\1\\1\\1\\1\\1\\1])\n",
+		graph.roots_.front());
+}
+
+
+TEST(PERMUTE, FoldReduce)
+{
+	teq::Shape shape({2, 3, 4});
+	std::vector<double> data(shape.n_elems());
+	std::iota(data.begin(), data.end(), 0);
+
+	teq::TensptrT x = eteq::make_variable<double>(data.data(), shape, "x");
+	teq::TensptrT p(eteq::make_functor(egen::PERMUTE, {x}, teq::RanksT{2, 0, 1}));
+	teq::TensptrT root(eteq::make_functor(egen::REDUCE_SUM, {p},
+		std::set<teq::RankT>{0}));
+	auto expect = calc_data(root);
+
+	opt::GraphInfo graph({root});
+	EXPECT_EQ(1, hone::eliminate_permutes(graph));
+	ASSERT_EQ(1, graph.roots_.size());
+	auto out = graph.roots_.front();
+	EXPECT_GRAPHEQ(
+		"(RESHAPE<DOUBLE>[1\\2\\3\\1\\1\\1\\1\\1])\n"
+		"_`--(REDUCE_SUM<DOUBLE>[2\\3\\1\\1\\1\\1\\1\\1])\n"
+		"_____`--(variable:x<DOUBLE>[2\\3\\4\\1\\1\\1\\1\\1])\n", out);
+	EXPECT_EQ(expect, calc_data(out));
+}
+
+
+TEST(PERMUTE, DenseBackward)
+{
+	teq::Shape xshape({4, 3});
+	teq::Shape w1shape({5, 4});
+	teq::Shape w2shape({2, 5});
+	std::vector<double> xdata(xshape.n_elems());
+	std::vector<double> w1data(w1shape.n_elems());
+	std::vector<double> w2data(w2shape.n_elems());
+	std::iota(xdata.begin(), xdata.end(), -5);
+	std::iota(w1data.begin(), w1data.end(), -10);
+	std::iota(w2data.begin(), w2data.end(), -3);
+
+	teq::TensptrT x = eteq::make_variable<double>(xdata.data(), xshape, "x");
+	teq::TensptrT w1 = eteq::make_variable<double>(w1data.data(), w1shape, "w1");
+	teq::TensptrT w2 = eteq::make_variable<double>(w2data.data(), w2shape, "w2");
+	teq::TensptrT hidden(eteq::make_functor(egen::MATMUL, {x, w1}));
+	teq::TensptrT out(eteq::make_functor(egen::MATMUL, {hidden, w2}));
+
+	auto grads = teq::derive(out, {x, w1, w2}, eteq::DerivativeFuncs());
+	ASSERT_EQ(3, grads.size());
+	EXPECT_LT(0, count_permutes(grads));
+	std::vector<std::vector<double>> expects;
+	for (auto& grad : grads)
+	{
+		expects.push_back(calc_data(grad));
+	}
+
+	opt::GraphInfo graph(grads);
+	EXPECT_LT(0, hone::eliminate_permutes(graph));
+	auto roots = graph.get_roots();
+	ASSERT_EQ(3, roots.size());
+	EXPECT_EQ(0, count_permutes(roots));
+	for (size_t i = 0; i < 3; ++i)
+	{
+		EXPECT_TRUE(grads[i]->shape().compatible_after(roots[i]->shape(), 0));
+		EXPECT_EQ(expects[i], calc_data(roots[i]));
+	}
+}
+
+
+#endif // DISABLE_HONE_PERMUTE_TEST
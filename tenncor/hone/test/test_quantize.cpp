@@ -0,0 +1,190 @@
+
+#ifndef DISABLE_HONE_QUANTIZE_TEST
+
+
+#include "gtest/gtest.h"
+
+#include "testutil/tutil.hpp"
+
+#include "tenncor/hone/hone.hpp"
+
+
+static size_t count_ops (const teq::TensptrsT& roots, egen::_GENERATED_OPCODE opcode)
+{
+	teq::GraphStat stat;
+	teq::multi_visit(stat, roots);
+	return std::count_if(stat.graphsize_.begin(), stat.graphsize_.end(),
+		[opcode](const auto& gpair)
+		{
+			auto func = dynamic_cast<teq::iFunctor*>(gpair.first);
+			return nullptr != func && opcode == func->get_opcode().code_;
+		});
+}
+
+
+static std::vector<float> calc_data (const teq::TensptrT& tens)
+{
+	float* ptr = eteq::ETensor(tens).calc<float>();
+	return std::vector<float>(ptr, ptr + tens->shape().n_elems());
+}
+
+
+static std::vector<float> wave (teq::Shape shape, float freq)
+{
+	std::vector<float> out(shape.n_elems());
+	for (size_t i = 0, n = out.size(); i < n; ++i)
+	{
+		out[i] = std::sin(freq * (i + 1));
+	}
+	return out;
+}
+
+
+static void expect_close (const std::vector<float>& expect,
+	const std::vector<float>& got, float tol)
+{
+	ASSERT_EQ(expect.size(), got.size());
+	float absmax = 0;
+	for (float e : expect)
+	{
+		absmax = std::max(absmax, std::abs(e));
+	}
+	for (size_t i = 0, n = expect.size(); i < n; ++i)
+	{
+		EXPECT_NEAR(expect[i], got[i], tol * absmax) << "at index " << i;
+	}
+}
+
+
+TEST(QUANTIZE, Dense)
+{
+	teq::Shape xshape({8, 4});
+	teq::Shape w1shape({6, 8});
+	teq::Shape w2shape({3, 6});
+	auto xdata = wave(xshape, 0.7);
+	auto w1data = wave(w1shape, 1.3);
+	auto w2data = wave(w2shape, 0.4);
+
+	teq::TensptrT x = eteq::make_variable<float>(xdata.data(), xshape, "x");
+	teq::TensptrT w1 = eteq::make_constant<float>(w1data.data(), w1shape);
+	teq::TensptrT w2 = eteq::make_constant<float>(w2data.data(), w2shape);
+	teq::TensptrT hidden(eteq::make_functor(egen::MATMUL, {x, w1}));
+	teq::TensptrT root(eteq::make_functor(egen::MATMUL, {hidden, w2}));
+	auto expect = calc_data(root);
+
+	opt::GraphInfo graph({root});
+	auto targets = hone::calibration_targets(graph);
+	ASSERT_EQ(2, targets.size());
+
+	hone::QuantRangesT ranges;
+	hone::calibrate(ranges, targets);
+	ASSERT_EQ(2, ranges.size());
+	auto xrange = ranges.at(x.get());
+	EXPECT_FLOAT_EQ(*std::min_element(xdata.begin(), xdata.end()), xrange.lower_);
+	EXPECT_FLOAT_EQ(*std::max_element(xdata.begin(), xdata.end()), xrange.upper_);
+
+	EXPECT_EQ(2, hone::quantize(graph, ranges));
+	auto roots = graph.get_roots();
+	ASSERT_EQ(1, roots.size());
+	EXPECT_EQ(0, count_ops(roots, egen::MATMUL));
+	EXPECT_EQ(2, count_ops(roots, egen::QUANT_MATMUL));
+	EXPECT_EQ(2, count_ops(roots, egen::QUANTIZE));
+	EXPECT_EQ(egen::FLOAT, roots.front()->get_meta().type_code());
+	expect_close(expect, calc_data(roots.front()), 0.03);
+}
+
+
+TEST(QUANTIZE, PerTensor)
+{
+	teq::Shape xshape({5, 2});
+	teq::Shape wshape({4, 5});
+	auto xdata = wave(xshape, 0.9);
+	auto wdata = wave(wshape, 0.3);
+
+	teq::TensptrT x = eteq::make_variable<float>(xdata.data(), xshape, "x");
+	teq::TensptrT w = eteq::make_constant<float>(wdata.data(), wshape);
+	teq::TensptrT root(eteq::make_functor(egen::MATMUL, {x, w}));
+	auto expect = calc_data(root);
+
+	opt::GraphInfo graph({root});
+	hone::QuantRangesT ranges;
+	hone::calibrate(ranges, hone::calibration_targets(graph));
+	EXPECT_EQ(1, hone::quantize(graph, ranges, false));
+	auto out = graph.get_roots().front();
+	auto quant = dynamic_cast<teq::iFunctor*>(out.get());
+	ASSERT_NE(nullptr, quant);
+	ASSERT_EQ(egen::QUANT_MATMUL, quant->get_opcode().code_);
+	eigen::CoefsT multipliers;
+	eigen::Packer<eigen::CoefsT>().unpack(multipliers, *quant);
+	EXPECT_EQ(1, multipliers.size());
+	expect_close(expect, calc_data(out), 0.03);
+}
+
+
+TEST(QUANTIZE, StabilizerFallback)
+{
+	teq::Shape xshape({5, 2});
+	teq::Shape wshape({4, 5});
+	auto xdata = wave(xshape, 0.9);
+	auto wdata = wave(wshape, 0.3);
+
+	teq::TensptrT x = eteq::make_variable<float>(xdata.data(), xshape, "x");
+	teq::TensptrT w = eteq::make_constant<float>(wdata.data(), wshape);
+	teq::TensptrT unbounded(eteq::make_functor(egen::MATMUL, {x, w}));
+	teq::TensptrT bounded(eteq::make_functor(egen::MATMUL, {
+		eteq::make_functor(egen::TANH, {x}), w}));
+	auto expect = calc_data(bounded);
+
+	// without calibration, only activations with a stabilizer range quantize
+	opt::GraphInfo graph({unbounded, bounded});
+	EXPECT_EQ(1, hone::quantize(graph, {}));
+	auto roots = graph.get_roots();
+	ASSERT_EQ(2, roots.size());
+	EXPECT_EQ(1, count_ops(roots, egen::MATMUL));
+	EXPECT_EQ(1, count_ops(roots, egen::QUANT_MATMUL));
+	expect_close(expect, calc_data(roots[1]), 0.03);
+}
+
+
+TEST(QUANTIZE, Conv2d)
+{
+	teq::Shape imgshape({2, 6, 5, 2});
+	teq::Shape kernshape({3, 2, 3, 2});
+	auto imgdata = wave(imgshape, 0.5);
+	auto kerndata = wave(kernshape, 1.1);
+
+	teq::TensptrT img = eteq::make_variable<float>(imgdata.data(), imgshape, "img");
+	teq::TensptrT kern = eteq::make_constant<float>(kerndata.data(), kernshape);
+	teq::TensptrT root(eteq::make_functor(egen::CONV2D, {img, kern},
+		teq::DimsT{2, 1}, eigen::PairVecT<teq::DimT>{{1, 1}, {0, 1}}));
+	auto expect = calc_data(root);
+
+	opt::GraphInfo graph({root});
+	hone::QuantRangesT ranges;
+	hone::calibrate(ranges, hone::calibration_targets(graph));
+	EXPECT_EQ(1, hone::quantize(graph, ranges));
+	auto out = graph.get_roots().front();
+	EXPECT_EQ(1, count_ops({out}, egen::QUANT_CONV2D));
+	EXPECT_TRUE(root->shape().compatible_after(out->shape(), 0));
+	expect_close(expect, calc_data(out), 0.03);
+}
+
+
+TEST(QUANTIZE, SkipVariableWeights)
+{
+	teq::Shape xshape({5, 2});
+	teq::Shape wshape({4, 5});
+	auto xdata = wave(xshape, 0.9);
+	auto wdata = wave(wshape, 0.3);
+
+	teq::TensptrT x = eteq::make_variable<float>(xdata.data(), xshape, "x");
+	teq::TensptrT w = eteq::make_variable<float>(wdata.data(), wshape, "w");
+	teq::TensptrT root(eteq::make_functor(egen::MATMUL, {x, w}));
+
+	opt::GraphInfo graph({root});
+	EXPECT_EQ(0, hone::calibration_targets(graph).size());
+	EXPECT_EQ(0, hone::quantize(graph, {}));
+}
+
+
+#endif // DISABLE_HONE_QUANTIZE_TEST
@@ -34,6 +34,96 @@ using ErrorF = std::function<eteq::ETensor(const eteq::ETensorsT&)>;
 template <typename T>
 using ApproxF = std::function<VarErrsT<T>(const eteq::ETensor&,const eteq::EVariablesT<T>&)>;
 
+/// Return variable assignments of fused optimizer opcode (e.g.: APPLY_SGD)
+/// given argument groups {variable,gradient,states...} ordered by variables
+/// If batch is true, every group is updated by a single functor and each
+/// variable is associated with its identity depending on that functor
+template <typename T>
+VarErrsT<T> apply_fused (egen::_GENERATED_OPCODE opcode,
+	const eteq::EVariablesT<T>& variables,
+	const std::vector<teq::TensptrsT>& groups,
+	const eigen::CoefsT& coefs, bool batch,
+	const global::CfgMapptrT& ctx = global::context())
+{
+	assert(variables.size() == groups.size());
+	VarErrsT<T> out;
+	out.reserve(variables.size());
+	if (false == batch)
+	{
+		for (size_t i = 0, n = variables.size(); i < n; ++i)
+		{
+			out.push_back({variables[i], eteq::ETensor(
+				eteq::make_functor(opcode, groups[i], coefs), ctx)});
+		}
+		return out;
+	}
+	if (groups.empty())
+	{
+		return out;
+	}
+	teq::TensptrsT args;
+	for (const teq::TensptrsT& group : groups)
+	{
+		args.insert(args.end(), group.begin(), group.end());
+	}
+	teq::TensptrT update = eteq::make_functor(opcode, args, coefs);
+	for (const eteq::EVariable<T>& var : variables)
+	{
+		out.push_back({var, eteq::ETensor(eteq::make_functor(
+			egen::IDENTITY, teq::TensptrsT{var, update}), ctx)});
+	}
+	return out;
+}
+
+/// Return assignment subtracting gradient scaled by learning_rate from
+/// variable that only updates the slices of the variable indexed by the
+/// gradient if gradient is either SCATTER_ADD (e.g.: gradient of embedding
+/// variable in GATHER) or CONTRACT {{1,1}} of a sparse leaf
+/// (e.g.: gradient of embedding variable in MATMUL with sparse input),
+/// otherwise return an empty tensor
+template <typename T>
+eteq::ETensor sparse_assign_sub (const eteq::EVariable<T>& variable,
+	const eteq::ETensor& gradient, T learning_rate,
+	const global::CfgMapptrT& ctx = global::context())
+{
+	auto func = dynamic_cast<teq::iFunctor*>(gradient.get());
+	if (nullptr == func)
+	{
+		return eteq::ETensor();
+	}
+	auto args = func->get_args();
+	auto scale = [&](teq::TensptrT source)
+	{
+		return eteq::make_functor(egen::MUL, {source,
+			eteq::make_constant_like(learning_rate, source, ctx)});
+	};
+	switch (func->get_opcode().code_)
+	{
+		case egen::SCATTER_ADD:
+		{
+			teq::RankT dim;
+			eigen::Packer<teq::RankT>().unpack(dim, *func);
+			return eteq::ETensor(eteq::make_functor(egen::SCATTER_ASSIGN_SUB,
+				{variable, args[1], scale(args[0])}, dim), ctx);
+		}
+		case egen::CONTRACT:
+		{
+			eigen::PairVecT<teq::RankT> dims;
+			eigen::Packer<eigen::PairVecT<teq::RankT>>().unpack(dims, *func);
+			if (dims == eigen::PairVecT<teq::RankT>{{1, 1}} &&
+				nullptr != dynamic_cast<eigen::iSparseLeaf*>(args[0].get()))
+			{
+				return eteq::ETensor(eteq::make_functor(egen::SPARSE_ASSIGN_SUB,
+					{variable, args[0], scale(args[1])}), ctx);
+			}
+		}
+			break;
+		default:
+			break;
+	}
+	return eteq::ETensor();
+}
+
 }
 
 #endif // LAYR_APPROX_HPP
@@ -60,6 +60,13 @@ eteq::ETensor connect (const eteq::ETensor& root, const eteq::ETensor& input);
 
 eteq::ETensor deep_clone (const eteq::ETensor& root);
 
+/// Return true if every gate is a dense layer contracting the first
+/// dimension of its input with the second dimension of a 2D weight,
+/// and either every gate or no gate has bias, then populate weights and
+/// biases with the parameters of each gate (biases is empty if no gate has bias)
+bool get_dense_params (eteq::ETensorsT& weights,
+	eteq::ETensorsT& biases, const eteq::ETensorsT& gates);
+
 struct Trailer final : public teq::iOnceTraveler
 {
 	Trailer (const teq::OwnMapT& inputs) :
@@ -75,6 +75,82 @@ eteq::ETensor deep_clone (const eteq::ETensor& root)
 	return eteq::ETensor(kamino.clones_.at(root.get()), root.get_context());
 }
 
+
+/// Populate weight and bias (null if absent) of dense layer root
+/// Return false if root is not of the form built by dense
+static bool get_dense_param (teq::TensptrT& weight,
+	teq::TensptrT& bias, const eteq::ETensor& root)
+{
+	auto froot = std::dynamic_pointer_cast<teq::iFunctor>(
+		(teq::TensptrT) root);
+	if (nullptr == froot)
+	{
+		return false;
+	}
+	auto layerattr = dynamic_cast<const teq::LayerObj*>(
+		froot->get_attr(teq::layer_attr));
+	if (nullptr == layerattr || dense_name != layerattr->get_opname())
+	{
+		return false;
+	}
+	// dense layers are identity(contract(input, weight) [+ extend(bias)])
+	auto fout = std::dynamic_pointer_cast<teq::iFunctor>(
+		froot->get_args().front());
+	bias = nullptr;
+	if (nullptr != fout && egen::ADD == fout->get_opcode().code_)
+	{
+		auto addargs = fout->get_args();
+		auto fext = std::dynamic_pointer_cast<teq::iFunctor>(addargs.back());
+		if (2 != addargs.size() || nullptr == fext ||
+			egen::EXTEND != fext->get_opcode().code_)
+		{
+			return false;
+		}
+		bias = fext->get_args().front();
+		fout = std::dynamic_pointer_cast<teq::iFunctor>(addargs.front());
+	}
+	if (nullptr == fout || egen::CONTRACT != fout->get_opcode().code_)
+	{
+		return false;
+	}
+	eigen::PairVecT<teq::RankT> dims;
+	eigen::Packer<eigen::PairVecT<teq::RankT>>().unpack(dims, *fout);
+	auto cargs = fout->get_args();
+	weight = cargs.back();
+	teq::Shape wshape = weight->shape();
+	return cargs.front() == layerattr->get_tensor() &&
+		dims == eigen::PairVecT<teq::RankT>{{0, 1}} &&
+		wshape.n_elems() == (teq::NElemT) wshape.at(0) * wshape.at(1);
+}
+
+bool get_dense_params (eteq::ETensorsT& weights,
+	eteq::ETensorsT& biases, const eteq::ETensorsT& gates)
+{
+	eteq::ETensorsT ws, bs;
+	ws.reserve(gates.size());
+	bs.reserve(gates.size());
+	for (const eteq::ETensor& gate : gates)
+	{
+		teq::TensptrT weight, bias;
+		if (false == get_dense_param(weight, bias, gate))
+		{
+			return false;
+		}
+		ws.push_back(eteq::ETensor(weight, gate.get_context()));
+		if (nullptr != bias)
+		{
+			bs.push_back(eteq::ETensor(bias, gate.get_context()));
+		}
+	}
+	if (bs.size() > 0 && bs.size() < gates.size())
+	{
+		// cannot fuse gates that disagree on having bias
+		return false;
+	}
+	weights = ws;
+	biases = bs;
+	return true;
+}
 }
 
 #endif
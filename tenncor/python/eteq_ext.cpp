@@ -11,7 +11,7 @@ static py::array get_releasedata (eteq::ETensor& self)
 #define _CHOOSE_RELEASE_DATATYPE(REALTYPE){\
 	auto data = self.odata<REALTYPE>();\
 	return pytenncor::typedata_to_array<REALTYPE>(data.get(), self->shape(),\
-		self->get_meta().type_code(), py::dtype::of<REALTYPE>()); }
+		self->get_meta().type_code()); }
 	TYPE_LOOKUP(_CHOOSE_RELEASE_DATATYPE, dtype);
 #undef _CHOOSE_RELEASE_DATATYPE
 	return py::array();
@@ -121,7 +121,7 @@ void eteq_ext (py::module& m)
 			auto dtype = (egen::_GENERATED_DTYPE) self->get_meta().type_code();
 #define _CHOOSE_DATATYPE(REALTYPE)\
 			return pytenncor::typedata_to_array<REALTYPE>(self.data<REALTYPE>(),\
-				self->shape(), self->get_meta().type_code(), py::dtype::of<REALTYPE>());
+				self->shape(), self->get_meta().type_code());
 			TYPE_LOOKUP(_CHOOSE_DATATYPE, dtype);
 #undef _CHOOSE_DATATYPE
 			return py::array();
@@ -134,7 +134,7 @@ void eteq_ext (py::module& m)
 #define _CHOOSE_CALCTYPE(REALTYPE)\
 			return pytenncor::typedata_to_array<REALTYPE>(\
 				self.calc<REALTYPE>(ignored, max_version), self->shape(),\
-				self->get_meta().type_code(), py::dtype::of<REALTYPE>());
+				self->get_meta().type_code());
 			TYPE_LOOKUP(_CHOOSE_CALCTYPE, dtype);
 #undef _CHOOSE_CALCTYPE
 			return py::array();
@@ -148,7 +148,7 @@ void eteq_ext (py::module& m)
 #define _CHOOSE_RELEASE_CALCTYPE(REALTYPE){\
 			auto out = self.calc_release<REALTYPE>(ignored, max_version);\
 			return pytenncor::typedata_to_array<REALTYPE>(out.get(), self->shape(),\
-				self->get_meta().type_code(), py::dtype::of<REALTYPE>()); }
+				self->get_meta().type_code()); }
 			TYPE_LOOKUP(_CHOOSE_RELEASE_CALCTYPE, dtype);
 #undef _CHOOSE_RELEASE_CALCTYPE
 			return py::array();
@@ -355,7 +355,13 @@ void eteq_ext (py::module& m)
 
 		// ==== other stuff ====
 		.def("derive", &tcr::derive,
-		"Return derivative of first tensor with respect to second tensor")
+		"Return derivative of first tensor with respect to second tensor",
+		py::arg("root"), py::arg("targets"), py::arg("simplify") = false)
+		.def("derive_checkpointed", &tcr::derive_checkpointed,
+		"Return derivative of first tensor with respect to second tensor "
+		"recomputing forward activations from checkpoints during backprop",
+		py::arg("root"), py::arg("targets"),
+		py::arg("checkpoints") = eteq::ETensorsT{})
 
 		.def("trail",
 		[](const eteq::ETensor& root,
@@ -16,14 +16,22 @@ namespace pytenncor
 using ETensPairT = std::pair<eteq::ETensor,eteq::ETensor>;
 
 template <typename T>
-py::array typedata_to_array (T* data, teq::Shape shape,
-	size_t typecode, py::dtype dtype)
+py::array typedata_to_array (T* data, teq::Shape shape, size_t typecode)
 {
 	auto pshape = pyutils::c2pshape(shape);
-	return py::array(dtype, py::array::ShapeContainer(
+	return py::array(py::dtype::of<T>(), py::array::ShapeContainer(
 		pshape.begin(), pshape.end()), data);
 }
 
+/// Numpy has no bfloat16, so widen data to float32
+template <>
+inline py::array typedata_to_array<Eigen::bfloat16> (
+	Eigen::bfloat16* data, teq::Shape shape, size_t typecode)
+{
+	std::vector<float> wide(data, data + shape.n_elems());
+	return typedata_to_array<float>(wide.data(), shape, typecode);
+}
+
 struct Statement final
 {
 	Statement (teq::TensptrsT tens) : tracked_(tens)
@@ -5,8 +5,37 @@
 #include "pybind11/pybind11.h"
 #include "pybind11/numpy.h"
 
+#include "Eigen/Core"
+
 #include "internal/teq/teq.hpp"
 
+namespace pybind11
+{
+
+namespace detail
+{
+
+/// Map Eigen::half to numpy's float16
+template <>
+struct npy_format_descriptor<Eigen::half>
+{
+	static constexpr auto name = _("float16");
+
+	static pybind11::dtype dtype (void)
+	{
+		const int npy_half = 23;
+		if (auto ptr = npy_api::get().PyArray_DescrFromType_(npy_half))
+		{
+			return reinterpret_steal<pybind11::dtype>(ptr);
+		}
+		pybind11_fail("Unsupported buffer format!");
+	}
+};
+
+}
+
+}
+
 namespace pyutils
 {
 
@@ -35,6 +64,12 @@ std::vector<T> arr2shapedarr (teq::Shape& shape, py::array& data)
 		case 'f':
 			switch (tbytes)
 			{
+				case 2: // float16
+				{
+					const Eigen::half* fptr = static_cast<const Eigen::half*>(dptr);
+					out = std::vector<T>(fptr, fptr + n);
+				}
+					break;
 				case 4: // float32
 				{
 					const float* fptr = static_cast<const float*>(dptr);
@@ -40,6 +40,8 @@ static const std::unordered_map<
 	{"INT32", onnx::TensorProto::INT32},
 	{"UINT64", onnx::TensorProto::UINT64},
 	{"INT64", onnx::TensorProto::INT64},
+	{"FLOAT16", onnx::TensorProto::FLOAT16},
+	{"BFLOAT16", onnx::TensorProto::BFLOAT16},
 };
 
 struct MarshFuncs final : public onnx::iMarshFuncs
@@ -102,6 +104,12 @@ struct MarshFuncs final : public onnx::iMarshFuncs
 				pack<int64_t>(data, nelems, out,
 					&onnx::TensorProto::add_int64_data);
 				break;
+			// onnx stores 16-bit floats as their raw bits in int32_data
+			case onnx::TensorProto::FLOAT16:
+			case onnx::TensorProto::BFLOAT16:
+				pack<uint16_t>(data, nelems, out,
+					&onnx::TensorProto::add_int32_data);
+				break;
 #endif // EGEN_FULLTYPE
 			default:
 				global::fatalf("unknown onnx type %d (aka %s)",
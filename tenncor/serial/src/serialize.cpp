@@ -6,12 +6,10 @@
 namespace serial
 {
 
-template <typename CAST, typename T>
-static inline teq::TensptrT unpack (teq::Usage usage, teq::Shape shape,
-	std::string label, const google::protobuf::RepeatedField<T>& data)
+template <typename CAST>
+static inline teq::TensptrT unpack_leaf (teq::Usage usage, teq::Shape shape,
+	std::string label, CAST* ptr)
 {
-	std::vector<CAST> cdata(data.begin(), data.end());
-	CAST* ptr = cdata.data();
 	teq::TensptrT out;
 	switch (usage) {
 	case teq::IMMUTABLE:
@@ -22,7 +20,7 @@ static inline teq::TensptrT unpack (teq::Usage usage, teq::Shape shape,
 		break;
 	case teq::PLACEHOLDER:
 	{
-		std::vector<CAST> z(shape.n_elems(), 0);
+		std::vector<CAST> z(shape.n_elems(), (CAST) 0);
 		out = teq::TensptrT(eteq::Variable<CAST>::get(z.data(), shape, label, usage));
 	}
 		break;
@@ -32,6 +30,25 @@ static inline teq::TensptrT unpack (teq::Usage usage, teq::Shape shape,
 	return out;
 }
 
+template <typename CAST, typename T>
+static inline teq::TensptrT unpack (teq::Usage usage, teq::Shape shape,
+	std::string label, const google::protobuf::RepeatedField<T>& data)
+{
+	std::vector<CAST> cdata(data.begin(), data.end());
+	return unpack_leaf<CAST>(usage, shape, label, cdata.data());
+}
+
+/// Unpack 16-bit floats stored as their raw bits
+template <typename CAST>
+static inline teq::TensptrT unpack_bits (teq::Usage usage, teq::Shape shape,
+	std::string label, const google::protobuf::RepeatedField<int32_t>& data)
+{
+	std::vector<uint16_t> bits(data.begin(), data.end());
+	std::vector<CAST> cdata(bits.size());
+	std::memcpy(cdata.data(), bits.data(), sizeof(CAST) * bits.size());
+	return unpack_leaf<CAST>(usage, shape, label, cdata.data());
+}
+
 struct UnmarshFuncs final : public onnx::iUnmarshFuncs
 {
 	teq::TensptrT unmarsh_leaf (const onnx::TensorProto& pb_tens,
@@ -83,6 +100,14 @@ struct UnmarshFuncs final : public onnx::iUnmarshFuncs
 				out = unpack<int64_t>(usage, shape, label,
 					pb_tens.int64_data());
 				break;
+			case onnx::TensorProto::FLOAT16:
+				out = unpack_bits<Eigen::half>(usage, shape, label,
+					pb_tens.int32_data());
+				break;
+			case onnx::TensorProto::BFLOAT16:
+				out = unpack_bits<Eigen::bfloat16>(usage, shape, label,
+					pb_tens.int32_data());
+				break;
 #endif // EGEN_FULLTYPE
 			default:
 				global::fatalf("unknown onnx type %d", onnx_type);
@@ -179,4 +179,89 @@ TEST(SERIALIZE, LoadGraph)
 }
 
 
+#ifdef EGEN_FULLTYPE
+
+
+TEST(SERIALIZE, HalfRoundTrip)
+{
+	std::vector<Eigen::half> data{
+		Eigen::half(1), Eigen::half(-2.5), Eigen::half(0.125), Eigen::half(1024)};
+	teq::Shape shape({2, 2});
+	teq::TensptrT var(eteq::Variable<Eigen::half>::get(data.data(), shape, "x"));
+
+	onnx::TensIdT identified;
+	identified.insert(onnx::TensIdT::value_type(var.get(), "x"));
+	onnx::GraphProto graph;
+	serial::save_graph(graph, teq::TensptrsT{var}, identified);
+
+	ASSERT_EQ(1, graph.initializer_size());
+	auto& pb_tens = graph.initializer(0);
+	EXPECT_EQ(onnx::TensorProto::FLOAT16, pb_tens.data_type());
+	ASSERT_EQ(4, pb_tens.int32_data_size());
+	// onnx expects raw float16 bits, 0x3c00 is 1.0
+	EXPECT_EQ(0x3c00, pb_tens.int32_data(0));
+
+	onnx::TensptrIdT ids;
+	serial::load_graph(ids, graph);
+	ASSERT_HAS(ids.right, "x");
+	auto got = ids.right.at("x");
+	ASSERT_NE(nullptr, got);
+	EXPECT_EQ(egen::FLOAT16, got->get_meta().type_code());
+	auto gotdata = (Eigen::half*) got->device().data();
+	for (size_t i = 0, n = data.size(); i < n; ++i)
+	{
+		EXPECT_EQ((float) data[i], (float) gotdata[i]);
+	}
+}
+
+
+TEST(SERIALIZE, QuantizedRoundTrip)
+{
+	teq::Shape xshape({3, 2});
+	teq::Shape wshape({2, 3});
+	std::vector<float> xdata{0.5, -1, 0.25, 1, -0.75, 0};
+	std::vector<int8_t> wdata{127, -64, 32, 0, -127, 5};
+	teq::TensptrT x(eteq::make_variable<float>(xdata.data(), xshape, "x"));
+	teq::TensptrT w(eteq::make_constant_tensor<int8_t>(wdata.data(), wshape));
+	teq::TensptrT qx(eteq::make_functor(egen::QUANTIZE, {x},
+		eigen::CoefsT{1. / 128}));
+	teq::TensptrT root(eteq::make_functor(egen::QUANT_MATMUL, {qx, w},
+		eigen::CoefsT{0.5, 0.25}, egen::FLOAT));
+	ASSERT_EQ(egen::FLOAT, root->get_meta().type_code());
+	float* expect = eteq::ETensor(root).calc<float>();
+	ASSERT_NE(nullptr, expect);
+	std::vector<float> expect_data(expect, expect + root->shape().n_elems());
+
+	onnx::TensIdT identified;
+	identified.insert(onnx::TensIdT::value_type(root.get(), "root"));
+	onnx::GraphProto graph;
+	serial::save_graph(graph, teq::TensptrsT{root}, identified);
+
+	onnx::TensptrIdT ids;
+	serial::load_graph(ids, graph);
+	ASSERT_HAS(ids.right, "root");
+	auto got = ids.right.at("root");
+	ASSERT_NE(nullptr, got);
+	EXPECT_EQ(egen::FLOAT, got->get_meta().type_code());
+	auto gotfunc = dynamic_cast<teq::iFunctor*>(got.get());
+	ASSERT_NE(nullptr, gotfunc);
+	EXPECT_EQ(egen::QUANT_MATMUL, gotfunc->get_opcode().code_);
+	auto gotargs = gotfunc->get_args();
+	ASSERT_EQ(2, gotargs.size());
+	EXPECT_EQ(egen::INT8, gotargs[0]->get_meta().type_code());
+	EXPECT_EQ(egen::INT8, gotargs[1]->get_meta().type_code());
+
+	float* gotdata = eteq::ETensor(got).calc<float>();
+	ASSERT_NE(nullptr, gotdata);
+	for (size_t i = 0, n = expect_data.size(); i < n; ++i)
+	{
+		EXPECT_FLOAT_EQ(expect_data[i], gotdata[i]);
+	}
+}
+
+
+
+#endif // EGEN_FULLTYPE
+
+
 #endif // DISABLE_SERIAL_SERIALIZE_TEST
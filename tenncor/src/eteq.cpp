@@ -37,7 +37,8 @@ eteq::ETensorsT derive_with_manager (
 	return results;
 }
 
-eteq::ETensorsT derive (eteq::ETensor root, const eteq::ETensorsT& targets)
+eteq::ETensorsT derive (eteq::ETensor root,
+	const eteq::ETensorsT& targets, bool simplify)
 {
 	auto root_ctx = root.get_context();
 	if (nullptr == root_ctx)
@@ -61,7 +62,7 @@ eteq::ETensorsT derive (eteq::ETensor root, const eteq::ETensorsT& targets)
 		return derive_with_manager(*mgr, root, targets);
 	}
 
-	eteq::DerivativeFuncs builder;
+	eteq::DerivativeFuncs builder(simplify);
 	teq::TensptrsT targs(targets.begin(), targets.end());
 	teq::TensptrsT derivatives = teq::derive(root, targs, builder);
 	eteq::ETensorsT out;
@@ -75,6 +76,66 @@ eteq::ETensorsT derive (eteq::ETensor root, const eteq::ETensorsT& targets)
 	return out;
 }
 
+struct NonIdempotentFinder final : public teq::iOnceTraveler
+{
+	teq::TensSetT funcs_;
+
+private:
+	/// Implementation of iOnceTraveler
+	void visit_leaf (teq::iLeaf&) override {}
+
+	/// Implementation of iOnceTraveler
+	void visit_func (teq::iFunctor& func) override
+	{
+		auto deps = func.get_args();
+		teq::multi_visit(*this, deps);
+		if (false == egen::is_idempotent(
+			(egen::_GENERATED_OPCODE) func.get_opcode().code_))
+		{
+			funcs_.emplace(&func);
+		}
+	}
+};
+
+eteq::ETensorsT derive_checkpointed (eteq::ETensor root,
+	const eteq::ETensorsT& targets,
+	const eteq::ETensorsT& checkpoints)
+{
+	eteq::ETensorsT derivatives = derive(root, targets);
+	teq::TensptrsT grads(derivatives.begin(), derivatives.end());
+
+	teq::TensSetT ckpts;
+	if (checkpoints.empty())
+	{
+		ckpts = teq::sqrt_checkpoints({root});
+	}
+	else
+	{
+		std::transform(checkpoints.begin(), checkpoints.end(),
+			std::inserter(ckpts, ckpts.end()),
+			[](const eteq::ETensor& etens)
+			{
+				return etens.get();
+			});
+	}
+	// recomputing non-idempotent functors would not reproduce forward values
+	NonIdempotentFinder finder;
+	root->accept(finder);
+	ckpts.insert(finder.funcs_.begin(), finder.funcs_.end());
+	teq::rematerialize(grads, {root}, ckpts);
+
+	auto root_ctx = root.get_context();
+	eteq::ETensorsT out;
+	out.reserve(grads.size());
+	std::transform(grads.begin(), grads.end(),
+		std::back_inserter(out),
+		[&root_ctx](teq::TensptrT tens)
+		{
+			return eteq::ETensor(tens, root_ctx);
+		});
+	return out;
+}
+
 }
 
 #endif
@@ -23,7 +23,10 @@ static teq::TensptrsT optimize (
 	return hone::optimize(roots, json_in);
 }
 
-void optimize (std::string filename, const global::CfgMapptrT& ctx)
+using OptimizeF = std::function<teq::TensptrsT(const teq::TensptrsT&,std::istream&)>;
+
+static void optimize_reg (std::string filename,
+	const global::CfgMapptrT& ctx, OptimizeF optimize_roots)
 {
 	std::ifstream rulefile(filename);
 	auto& reg = eteq::get_reg(ctx);
@@ -33,7 +36,7 @@ void optimize (std::string filename, const global::CfgMapptrT& ctx)
 		roots.emplace(rpairs.second->get_tensor());
 	}
 	teq::TensptrsT inroots(roots.begin(), roots.end());
-	auto outroots = optimize(inroots, rulefile, ctx);
+	auto outroots = optimize_roots(inroots, rulefile);
 	assert(inroots.size() == outroots.size());
 	auto& graphinfo = eteq::get_graphinfo(ctx);
 	for (size_t i = 0, n = inroots.size(); i < n; ++i)
@@ -42,6 +45,207 @@ void optimize (std::string filename, const global::CfgMapptrT& ctx)
 	}
 }
 
+void optimize (std::string filename, const global::CfgMapptrT& ctx)
+{
+	optimize_reg(filename, ctx,
+	[&ctx](const teq::TensptrsT& roots, std::istream& json_in)
+	{
+		return optimize(roots, json_in, ctx);
+	});
+}
+
+static const std::string cached_leaf_prefix = "leaf_";
+
+static const std::string cached_root_prefix = "root_";
+
+static const std::string cached_root_key = "root";
+
+/// Return hash of mutable leaf properties that persist across runs
+static size_t hash_leaf (teq::iLeaf& leaf)
+{
+	teq::Shape shape = leaf.shape();
+	size_t seed = boost::hash_range(shape.begin(), shape.end());
+	boost::hash_combine(seed, leaf.get_meta().type_code());
+	boost::hash_combine(seed, (size_t) leaf.get_usage());
+	boost::hash_combine(seed, leaf.to_string());
+	return seed;
+}
+
+size_t fingerprint (teq::TensptrsT& roots,
+	onnx::TensIdT& leaves, const std::string& rules)
+{
+	hone::Hasher positionless(hash_leaf);
+	teq::multi_visit(positionless, roots);
+	std::stable_sort(roots.begin(), roots.end(),
+		[&positionless](const teq::TensptrT& a, const teq::TensptrT& b)
+		{
+			return positionless.at(a.get()) < positionless.at(b.get());
+		});
+
+	// hasher visits each leaf once in depth-first order of the sorted roots
+	hone::Hasher positional(
+	[&leaves](teq::iLeaf& leaf)
+	{
+		size_t position = leaves.size();
+		size_t seed = hash_leaf(leaf);
+		boost::hash_combine(seed, position);
+		leaves.insert({&leaf, cached_leaf_prefix + fmts::to_string(position)});
+		return seed;
+	});
+	size_t seed = std::hash<std::string>()(rules);
+	for (const teq::TensptrT& root : roots)
+	{
+		root->accept(positional);
+		boost::hash_combine(seed, positional.at(root.get()));
+	}
+	return seed;
+}
+
+/// Populate outs with optimized roots from cachepath if available
+/// Return true if every root is loaded
+static bool load_cache (teq::TensptrsT& outs, const std::string& cachepath,
+	const teq::TensptrsT& roots, const onnx::TensIdT& leaves)
+{
+	std::ifstream cachefile(cachepath, std::ios::binary);
+	if (false == cachefile.is_open())
+	{
+		return false;
+	}
+	onnx::ModelProto pb_model;
+	if (false == pb_model.ParseFromIstream(&cachefile) ||
+		pb_model.metadata_props().size() != (int) roots.size())
+	{
+		global::warnf("ignoring malformed optimization cache %s",
+			cachepath.c_str());
+		return false;
+	}
+
+	// reuse existing mutable leaves instead of loading placeholders
+	auto owners = teq::convert_ownmap(teq::track_ownrefs(roots));
+	onnx::TensptrIdT ids;
+	for (const auto& leaf : leaves)
+	{
+		auto owner = estd::try_get(owners, leaf.left, nullptr);
+		if (nullptr == owner)
+		{
+			return false;
+		}
+		ids.insert({owner, leaf.right});
+	}
+	serial::load_graph(ids, pb_model.graph());
+
+	const auto& pb_roots = pb_model.metadata_props();
+	teq::TensptrsT loaded;
+	loaded.reserve(roots.size());
+	for (size_t i = 0, n = roots.size(); i < n; ++i)
+	{
+		teq::TensptrT out;
+		if (false == estd::get(out, ids.right, pb_roots[i].value()) ||
+			false == out->shape().compatible_after(roots[i]->shape(), 0))
+		{
+			global::warnf("ignoring mismatched optimization cache %s",
+				cachepath.c_str());
+			return false;
+		}
+		loaded.push_back(out);
+	}
+	outs = loaded;
+	return true;
+}
+
+/// Store optimized roots in cachepath with mutable leaves
+/// as graph inputs identified by leaves
+static void save_cache (const std::string& cachepath,
+	const teq::TensptrsT& outs, onnx::TensIdT leaves)
+{
+	teq::TensSetT stops;
+	for (const auto& leaf : leaves)
+	{
+		stops.emplace(leaf.left);
+	}
+	onnx::ModelProto pb_model;
+	pb_model.set_ir_version(onnx::IR_VERSION);
+	for (size_t i = 0, n = outs.size(); i < n; ++i)
+	{
+		teq::iTensor* out = outs[i].get();
+		std::string id;
+		if (false == estd::get(id, leaves.left, out))
+		{
+			id = cached_root_prefix + fmts::to_string(i);
+			leaves.insert({out, id});
+		}
+		auto pb_root = pb_model.add_metadata_props();
+		pb_root->set_key(cached_root_key);
+		pb_root->set_value(id);
+	}
+	serial::save_graph(*pb_model.mutable_graph(), outs, leaves, stops);
+
+	std::ofstream cachefile(cachepath, std::ios::binary);
+	if (false == cachefile.is_open() ||
+		false == pb_model.SerializeToOstream(&cachefile))
+	{
+		global::warnf("failed to write optimization cache %s",
+			cachepath.c_str());
+	}
+}
+
+teq::TensptrsT cached_optimize (const teq::TensptrsT& roots,
+	std::istream& rulestr, const std::string& cache_dir,
+	const global::CfgMapptrT& ctx)
+{
+	if (roots.empty())
+	{
+		return {};
+	}
+	std::string rules((std::istreambuf_iterator<char>(rulestr)),
+		std::istreambuf_iterator<char>());
+	std::istringstream json_in(rules);
+	if (get_distrmgr(ctx))
+	{
+		// distributed graphs are optimized by the remote services
+		return optimize(roots, json_in, ctx);
+	}
+
+	teq::TensptrsT sorted = roots;
+	onnx::TensIdT leaves;
+	std::string cachepath = cache_dir + "/" +
+		fmts::to_string(fingerprint(sorted, leaves, rules)) + ".onnx";
+
+	teq::TensptrsT outs;
+	if (load_cache(outs, cachepath, sorted, leaves))
+	{
+		global::debugf("loaded optimized graph from %s", cachepath.c_str());
+	}
+	else
+	{
+		outs = optimize(sorted, json_in, ctx);
+		save_cache(cachepath, outs, leaves);
+	}
+
+	teq::TensMapT<teq::TensptrT> optimized;
+	for (size_t i = 0, n = sorted.size(); i < n; ++i)
+	{
+		optimized.emplace(sorted[i].get(), outs[i]);
+	}
+	teq::TensptrsT results;
+	results.reserve(roots.size());
+	for (const teq::TensptrT& root : roots)
+	{
+		results.push_back(optimized.at(root.get()));
+	}
+	return results;
+}
+
+void optimize (std::string filename, const std::string& cache_dir,
+	const global::CfgMapptrT& ctx)
+{
+	optimize_reg(filename, ctx,
+	[&](const teq::TensptrsT& roots, std::istream& json_in)
+	{
+		return cached_optimize(roots, json_in, cache_dir, ctx);
+	});
+}
+
 }
 
 #endif
@@ -879,6 +879,57 @@ TEST(API, DependsRunOnce)
 }
 
 
+TEST(API, CheckpointedDerive)
+{
+	eigen::Device device;
+	teq::Shape shape({3, 2});
+	std::vector<double> data = {0.1, -0.2, 0.3, -0.4, 0.5, -0.6};
+	teq::NElemT n = shape.n_elems();
+
+	eteq::ETensor src = eteq::make_variable<double>(data.data(), shape, "src");
+	eteq::ETensorsT layers;
+	eteq::ETensor prev = src;
+	for (size_t i = 0; i < 9; ++i)
+	{
+		prev = tenncor().tanh(prev);
+		layers.push_back(prev);
+	}
+	auto dest = tenncor().reduce_sum(prev);
+
+	auto expect = tcr::derive(dest, {src}).front();
+	auto manual = tcr::derive_checkpointed(dest, {src},
+		{layers[2], layers[5]}).front();
+	auto automatic = tcr::derive_checkpointed(dest, {src}).front();
+
+	// only checkpoints of the forward graph are referenced by backward graph
+	auto refs = teq::track_ownptrs(teq::TensptrsT{manual});
+	for (size_t i = 0, nlayers = layers.size(); i < nlayers; ++i)
+	{
+		if (i == 2 || i == 5)
+		{
+			EXPECT_HAS(refs, layers[i].get());
+		}
+		else
+		{
+			EXPECT_FALSE(estd::has(refs, layers[i].get()));
+		}
+	}
+	auto autorefs = teq::track_ownptrs(teq::TensptrsT{automatic});
+	EXPECT_FALSE(estd::has(autorefs, layers[0].get()));
+
+	teq::Evaluator eval;
+	eval.evaluate(device, {expect.get(), manual.get(), automatic.get()});
+	double* eptr = (double*) expect->device().data();
+	double* mptr = (double*) manual->device().data();
+	double* aptr = (double*) automatic->device().data();
+	for (size_t i = 0; i < n; ++i)
+	{
+		EXPECT_DOUBLE_EQ(eptr[i], mptr[i]);
+		EXPECT_DOUBLE_EQ(eptr[i], aptr[i]);
+	}
+}
+
+
 TEST(API, Abs)
 {
 	unary_elementary(
@@ -2519,12 +2570,9 @@ TEST(API, Conv)
 	EXPECT_GRAPHEQ(
 		"(IDENTITY<FLOAT>[3\\6\\4\\2\\1\\1\\1\\1])\n"
 		"_`--(ADD<FLOAT>[3\\6\\4\\2\\1\\1\\1\\1])\n"
-		"_____`--(PERMUTE<FLOAT>[3\\6\\4\\2\\1\\1\\1\\1])\n"
-		"_____|___`--(CONV<FLOAT>[1\\6\\4\\2\\3\\1\\1\\1])\n"
-		"_____|_______`--(PAD<FLOAT>[4\\10\\9\\2\\5\\1\\1\\1])\n"
-		"_____|_______|___`--(variable:x<FLOAT>[4\\10\\9\\2\\1\\1\\1\\1])\n"
-		"_____|_______`--(REVERSE<FLOAT>[3\\4\\5\\6\\1\\1\\1\\1])\n"
-		"_____|___________`--(variable:weight<FLOAT>[3\\4\\5\\6\\1\\1\\1\\1])\n"
+		"_____`--(CONV2D<FLOAT>[3\\6\\4\\2\\1\\1\\1\\1])\n"
+		"_____|___`--(variable:x<FLOAT>[4\\10\\9\\2\\1\\1\\1\\1])\n"
+		"_____|___`--(variable:weight<FLOAT>[3\\4\\5\\6\\1\\1\\1\\1])\n"
 		"_____`--(EXTEND<FLOAT>[3\\6\\4\\2\\1\\1\\1\\1])\n"
 		"_________`--(variable:bias<FLOAT>[3\\1\\1\\1\\1\\1\\1\\1])", y);
 }
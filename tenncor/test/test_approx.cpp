@@ -512,4 +512,201 @@ TEST(APPROX, Adam)
 }
 
 
+
+using ApproxBuilderF = std::function<layr::VarErrsT<float>(
+	TenncorAPI&,const eteq::ETensor&,const eteq::EVariablesT<float>&)>;
+
+
+// return variable values after minimizing a quadratic loss for nsteps
+static std::vector<float> minimize_quadratic (
+	ApproxBuilderF build, size_t nsteps, layr::VarErrsT<float>* out = nullptr)
+{
+	global::CfgMapptrT ctx = std::make_shared<estd::ConfigMap<>>();
+	TenncorAPI api(ctx);
+	std::vector<float> data0 = {0.5, -1, 2};
+	std::vector<float> data1 = {3, 0, -2, 1};
+	auto x0 = eteq::make_variable<float>(data0.data(), teq::Shape({3}), "x0", ctx);
+	auto x1 = eteq::make_variable<float>(data1.data(), teq::Shape({2, 2}), "x1", ctx);
+	auto loss = api.reduce_sum(api.square(x0 - 1.f)) +
+		api.reduce_sum(api.square(x1 + 2.f) * 3.f);
+
+	auto updates = build(api, loss, eteq::EVariablesT<float>{x0, x1});
+	teq::TensSetT roots;
+	for (auto& update : updates)
+	{
+		roots.emplace(update.second.get());
+	}
+	for (size_t i = 0; i < nsteps; ++i)
+	{
+		eigen::Device device(eigen::get_runtime(ctx));
+		teq::get_eval(ctx).evaluate(device, roots);
+	}
+	if (nullptr != out)
+	{
+		*out = updates;
+	}
+	std::vector<float> values;
+	for (auto& var : {x0, x1})
+	{
+		auto ptr = (float*) var->device().data();
+		values.insert(values.end(), ptr, ptr + var->shape().n_elems());
+	}
+	return values;
+}
+
+
+static void check_fused (ApproxBuilderF composite,
+	std::function<layr::VarErrsT<float>(TenncorAPI&,
+		const eteq::ETensor&,const eteq::EVariablesT<float>&,bool)> fused,
+	const std::string& opname)
+{
+	const size_t nsteps = 5;
+	auto expect = minimize_quadratic(composite, nsteps);
+
+	layr::VarErrsT<float> updates;
+	auto got = minimize_quadratic(
+		[&](TenncorAPI& api, const eteq::ETensor& loss,
+			const eteq::EVariablesT<float>& vars)
+		{
+			return fused(api, loss, vars, false);
+		}, nsteps, &updates);
+	ASSERT_EQ(2, updates.size());
+	for (auto& update : updates)
+	{
+		auto func = dynamic_cast<teq::iFunctor*>(update.second.get());
+		ASSERT_NE(nullptr, func);
+		EXPECT_STREQ(opname.c_str(), func->get_opcode().name_.c_str());
+		EXPECT_EQ(update.first.get(), func->get_args().front().get());
+	}
+	ASSERT_EQ(expect.size(), got.size());
+	for (size_t i = 0, n = expect.size(); i < n; ++i)
+	{
+		EXPECT_NEAR(expect[i], got[i], 1e-4) << opname << " at " << i;
+	}
+
+	auto batched = minimize_quadratic(
+		[&](TenncorAPI& api, const eteq::ETensor& loss,
+			const eteq::EVariablesT<float>& vars)
+		{
+			return fused(api, loss, vars, true);
+		}, nsteps, &updates);
+	ASSERT_EQ(2, updates.size());
+	teq::TensSetT fused_funcs;
+	for (auto& update : updates)
+	{
+		auto func = dynamic_cast<teq::iFunctor*>(update.second.get());
+		ASSERT_NE(nullptr, func);
+		EXPECT_STREQ("IDENTITY", func->get_opcode().name_.c_str());
+		fused_funcs.emplace(func->get_args()[1].get());
+	}
+	EXPECT_EQ(1, fused_funcs.size());
+	ASSERT_EQ(expect.size(), batched.size());
+	for (size_t i = 0, n = expect.size(); i < n; ++i)
+	{
+		EXPECT_NEAR(expect[i], batched[i], 1e-4) << opname << " batch at " << i;
+	}
+}
+
+
+TEST(APPROX, FusedSGD)
+{
+	check_fused(
+		[](TenncorAPI& api, const eteq::ETensor& loss,
+			const eteq::EVariablesT<float>& vars)
+		{
+			return api.approx.sgd<float>(loss, vars, 0.1);
+		},
+		[](TenncorAPI& api, const eteq::ETensor& loss,
+			const eteq::EVariablesT<float>& vars, bool batch)
+		{
+			return api.approx.fused_sgd<float>(loss, vars, 0.1,
+				layr::UnaryF(), batch);
+		}, "APPLY_SGD");
+}
+
+
+TEST(APPROX, FusedAdagrad)
+{
+	check_fused(
+		[](TenncorAPI& api, const eteq::ETensor& loss,
+			const eteq::EVariablesT<float>& vars)
+		{
+			return api.approx.adagrad<float>(loss, vars, 0.1, 1e-6);
+		},
+		[](TenncorAPI& api, const eteq::ETensor& loss,
+			const eteq::EVariablesT<float>& vars, bool batch)
+		{
+			return api.approx.fused_adagrad<float>(loss, vars, 0.1, 1e-6,
+				layr::UnaryF(), batch);
+		}, "APPLY_ADAGRAD");
+}
+
+
+TEST(APPROX, FusedRmsMomentum)
+{
+	check_fused(
+		[](TenncorAPI& api, const eteq::ETensor& loss,
+			const eteq::EVariablesT<float>& vars)
+		{
+			return api.approx.rms_momentum<float>(loss, vars, 0.1, 0.9, 1e-6);
+		},
+		[](TenncorAPI& api, const eteq::ETensor& loss,
+			const eteq::EVariablesT<float>& vars, bool batch)
+		{
+			return api.approx.fused_rms_momentum<float>(loss, vars, 0.1, 0.9,
+				1e-6, layr::UnaryF(), batch);
+		}, "APPLY_RMSPROP");
+}
+
+
+TEST(APPROX, FusedAdam)
+{
+	check_fused(
+		[](TenncorAPI& api, const eteq::ETensor& loss,
+			const eteq::EVariablesT<float>& vars)
+		{
+			return api.approx.adam<float>(loss, vars, 0.01, 0.9, 0.999, 1e-6);
+		},
+		[](TenncorAPI& api, const eteq::ETensor& loss,
+			const eteq::EVariablesT<float>& vars, bool batch)
+		{
+			return api.approx.fused_adam<float>(loss, vars, 0.01, 0.9, 0.999,
+				1e-6, batch);
+		}, "APPLY_ADAM");
+}
+
+
+TEST(APPROX, SparseSGD)
+{
+	std::vector<float> wdata = {
+		1, 2, 3,
+		4, 5, 6,
+		7, 8, 9,
+		10, 11, 12,
+	};
+	std::vector<int32_t> idata = {3, 1, 3};
+	teq::Shape wshape({3, 4});
+	auto embedding = eteq::make_variable<float>(wdata.data(), wshape, "embedding");
+	auto indices = eteq::make_constant<int32_t>(idata.data(), teq::Shape({3}));
+	auto err = tenncor().reduce_sum(tenncor().gather(embedding, indices, 1));
+
+	auto groups = tenncor().approx.sgd<float>(
+		err, eteq::EVariablesT<float>{embedding}, 0.5);
+	ASSERT_EQ(1, groups.size());
+	auto update = dynamic_cast<teq::iFunctor*>(groups.front().second.get());
+	ASSERT_NE(nullptr, update);
+	EXPECT_EQ(egen::SCATTER_ASSIGN_SUB, update->get_opcode().code_);
+
+	// only gathered rows are updated, once per occurrence
+	float* got = groups.front().second.calc<float>();
+	std::vector<float> expect = {
+		1, 2, 3,
+		3.5, 4.5, 5.5,
+		7, 8, 9,
+		9, 10, 11,
+	};
+	EXPECT_VECEQ(expect, std::vector<float>(got, got + wshape.n_elems()));
+}
+
+
 #endif // DISABLE_TENNCOR_APPROX_TEST
@@ -109,12 +109,9 @@ TEST(CONV, Connection)
 	EXPECT_GRAPHEQ(
 		"(IDENTITY<FLOAT>[3\\6\\4\\2\\1\\1\\1\\1])\n"
 		"_`--(ADD<FLOAT>[3\\6\\4\\2\\1\\1\\1\\1])\n"
-		"_____`--(PERMUTE<FLOAT>[3\\6\\4\\2\\1\\1\\1\\1])\n"
-		"_____|___`--(CONV<FLOAT>[1\\6\\4\\2\\3\\1\\1\\1])\n"
-		"_____|_______`--(PAD<FLOAT>[4\\10\\9\\2\\5\\1\\1\\1])\n"
-		"_____|_______|___`--(variable:x<FLOAT>[4\\10\\9\\2\\1\\1\\1\\1])\n"
-		"_____|_______`--(REVERSE<FLOAT>[3\\4\\5\\6\\1\\1\\1\\1])\n"
-		"_____|___________`--(variable:weight<FLOAT>[3\\4\\5\\6\\1\\1\\1\\1])\n"
+		"_____`--(CONV2D<FLOAT>[3\\6\\4\\2\\1\\1\\1\\1])\n"
+		"_____|___`--(variable:x<FLOAT>[4\\10\\9\\2\\1\\1\\1\\1])\n"
+		"_____|___`--(variable:weight<FLOAT>[3\\4\\5\\6\\1\\1\\1\\1])\n"
 		"_____`--(EXTEND<FLOAT>[3\\6\\4\\2\\1\\1\\1\\1])\n"
 		"_________`--(variable:bias<FLOAT>[3\\1\\1\\1\\1\\1\\1\\1])", y);
 }
@@ -214,50 +211,14 @@ TEST(BIND, Softmax)
 	auto s0 = layr::connect(sft0, eteq::ETensor(x));
 	auto s1 = layr::connect(sft1, eteq::ETensor(x));
 
-	std::string eps_str = fmts::to_string(std::numeric_limits<float>::epsilon());
-	auto expect_str0 = fmts::sprintf(
+	EXPECT_GRAPHEQ(
 		"(IDENTITY<FLOAT>[6\\2\\1\\1\\1\\1\\1\\1])\n"
-		"_`--(DIV<FLOAT>[6\\2\\1\\1\\1\\1\\1\\1])\n"
-		"_____`--(EXP<FLOAT>[6\\2\\1\\1\\1\\1\\1\\1])\n"
-		"_____|___`--(SUB<FLOAT>[6\\2\\1\\1\\1\\1\\1\\1])\n"
-		"_____|_______`--(variable:x<FLOAT>[6\\2\\1\\1\\1\\1\\1\\1])\n"
-		"_____|_______`--(EXTEND<FLOAT>[6\\2\\1\\1\\1\\1\\1\\1])\n"
-		"_____|___________`--(REDUCE_MAX<FLOAT>[1\\2\\1\\1\\1\\1\\1\\1])\n"
-		"_____|_______________`--(variable:x<FLOAT>[6\\2\\1\\1\\1\\1\\1\\1])\n"
-		"_____`--(EXTEND<FLOAT>[6\\2\\1\\1\\1\\1\\1\\1])\n"
-		"_________`--(ADD<FLOAT>[1\\2\\1\\1\\1\\1\\1\\1])\n"
-		"_____________`--(REDUCE_SUM<FLOAT>[1\\2\\1\\1\\1\\1\\1\\1])\n"
-		"_____________|___`--(EXP<FLOAT>[6\\2\\1\\1\\1\\1\\1\\1])\n"
-		"_____________|_______`--(SUB<FLOAT>[6\\2\\1\\1\\1\\1\\1\\1])\n"
-		"_____________|___________`--(variable:x<FLOAT>[6\\2\\1\\1\\1\\1\\1\\1])\n"
-		"_____________|___________`--(EXTEND<FLOAT>[6\\2\\1\\1\\1\\1\\1\\1])\n"
-		"_____________|_______________`--(REDUCE_MAX<FLOAT>[1\\2\\1\\1\\1\\1\\1\\1])\n"
-		"_____________|___________________`--(variable:x<FLOAT>[6\\2\\1\\1\\1\\1\\1\\1])\n"
-		"_____________`--(EXTEND<FLOAT>[1\\2\\1\\1\\1\\1\\1\\1])\n"
-		"_________________`--(constant:%s<FLOAT>[1\\1\\1\\1\\1\\1\\1\\1])", eps_str.c_str());
-	EXPECT_GRAPHEQ(expect_str0.c_str(), s0);
-
-	auto expect_str1 = fmts::sprintf(
+		"_`--(SOFTMAX<FLOAT>[6\\2\\1\\1\\1\\1\\1\\1])\n"
+		"_____`--(variable:x<FLOAT>[6\\2\\1\\1\\1\\1\\1\\1])", s0);
+	EXPECT_GRAPHEQ(
 		"(IDENTITY<FLOAT>[6\\2\\1\\1\\1\\1\\1\\1])\n"
-		"_`--(DIV<FLOAT>[6\\2\\1\\1\\1\\1\\1\\1])\n"
-		"_____`--(EXP<FLOAT>[6\\2\\1\\1\\1\\1\\1\\1])\n"
-		"_____|___`--(SUB<FLOAT>[6\\2\\1\\1\\1\\1\\1\\1])\n"
-		"_____|_______`--(variable:x<FLOAT>[6\\2\\1\\1\\1\\1\\1\\1])\n"
-		"_____|_______`--(EXTEND<FLOAT>[6\\2\\1\\1\\1\\1\\1\\1])\n"
-		"_____|___________`--(REDUCE_MAX<FLOAT>[6\\1\\1\\1\\1\\1\\1\\1])\n"
-		"_____|_______________`--(variable:x<FLOAT>[6\\2\\1\\1\\1\\1\\1\\1])\n"
-		"_____`--(EXTEND<FLOAT>[6\\2\\1\\1\\1\\1\\1\\1])\n"
-		"_________`--(ADD<FLOAT>[6\\1\\1\\1\\1\\1\\1\\1])\n"
-		"_____________`--(REDUCE_SUM<FLOAT>[6\\1\\1\\1\\1\\1\\1\\1])\n"
-		"_____________|___`--(EXP<FLOAT>[6\\2\\1\\1\\1\\1\\1\\1])\n"
-		"_____________|_______`--(SUB<FLOAT>[6\\2\\1\\1\\1\\1\\1\\1])\n"
-		"_____________|___________`--(variable:x<FLOAT>[6\\2\\1\\1\\1\\1\\1\\1])\n"
-		"_____________|___________`--(EXTEND<FLOAT>[6\\2\\1\\1\\1\\1\\1\\1])\n"
-		"_____________|_______________`--(REDUCE_MAX<FLOAT>[6\\1\\1\\1\\1\\1\\1\\1])\n"
-		"_____________|___________________`--(variable:x<FLOAT>[6\\2\\1\\1\\1\\1\\1\\1])\n"
-		"_____________`--(EXTEND<FLOAT>[6\\1\\1\\1\\1\\1\\1\\1])\n"
-		"_________________`--(constant:%s<FLOAT>[1\\1\\1\\1\\1\\1\\1\\1])", eps_str.c_str());
-	EXPECT_GRAPHEQ(expect_str1.c_str(), s1);
+		"_`--(SOFTMAX<FLOAT>[6\\2\\1\\1\\1\\1\\1\\1])\n"
+		"_____`--(variable:x<FLOAT>[6\\2\\1\\1\\1\\1\\1\\1])", s1);
 }
 
 
@@ -2,6 +2,8 @@
 #ifndef DISABLE_TENNCOR__OPT_TEST
 
 
+#include <filesystem>
+
 #include "gtest/gtest.h"
 
 #include "testutil/tutil.hpp"
@@ -408,4 +410,55 @@ TEST(OPTIMIZE, CNNLayer)
 }
 
 
+TEST(OPTIMIZE, Cache)
+{
+	auto cache_dir = std::filesystem::temp_directory_path() / "tenncor_optcache";
+	std::filesystem::remove_all(cache_dir);
+	std::filesystem::create_directories(cache_dir);
+
+	teq::Shape shape({2, 3});
+	std::vector<double> data = {1, 2, 3, 4, 5, 6};
+	auto build = [&]
+	{
+		eteq::ETensor x = eteq::make_variable<double>(data.data(), shape, "x");
+		eteq::ETensor a = eteq::make_constant<double>(data.data(), shape);
+		eteq::ETensor b = eteq::make_constant_scalar<double>(2, shape);
+		return teq::TensptrsT{x * (a + b), x - (a + b)};
+	};
+
+	auto roots = build();
+	std::ifstream rulefile(optfile);
+	auto optimized = tcr::cached_optimize(roots, rulefile, cache_dir.string());
+	ASSERT_EQ(2, optimized.size());
+	EXPECT_EQ(1, std::distance(
+		std::filesystem::directory_iterator(cache_dir),
+		std::filesystem::directory_iterator()));
+
+	// rebuilt graph loads from cache and keeps its own variable
+	auto roots2 = build();
+	teq::TensptrsT swapped = {roots2[1], roots2[0]};
+	std::ifstream rulefile2(optfile);
+	auto loaded = tcr::cached_optimize(swapped, rulefile2, cache_dir.string());
+	ASSERT_EQ(2, loaded.size());
+	EXPECT_EQ(1, std::distance(
+		std::filesystem::directory_iterator(cache_dir),
+		std::filesystem::directory_iterator()));
+
+	std::stringstream expect_mul, expect_sub;
+	PrettyEquation peq;
+	peq.cfg_ = PrintEqConfig{true, true};
+	peq.print(expect_mul, optimized[0]);
+	peq.print(expect_sub, optimized[1]);
+	EXPECT_GRAPHEQ(expect_sub.str(), loaded[0]);
+	EXPECT_GRAPHEQ(expect_mul.str(), loaded[1]);
+
+	auto mul = std::static_pointer_cast<teq::iFunctor>(loaded[1]);
+	auto x = std::static_pointer_cast<teq::iFunctor>(roots2[0])->get_args()[0];
+	auto args = mul->get_args();
+	EXPECT_TRUE(args[0] == x || args[1] == x);
+
+	std::filesystem::remove_all(cache_dir);
+}
+
+
 #endif // DISABLE_TENNCOR_OPT_TEST
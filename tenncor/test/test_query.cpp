@@ -2,6 +2,8 @@
 #ifndef DISABLE_TENNCOR_QUERY_TEST
 
 
+#include <chrono>
+
 #include "gtest/gtest.h"
 
 #include "exam/exam.hpp"
@@ -1350,6 +1352,82 @@ TEST(ADV, LayerMatch)
 }
 
 
+
+// compare patterns compiled once and matched together against per-query compilation
+TEST(ADV, MatcherBenchmark)
+{
+	auto rnn_roots = rnn_setup();
+	query::Query index;
+	teq::multi_visit(index, rnn_roots);
+
+	std::vector<std::string> patterns = {
+		"{\"op\":{\"opname\":\"ADD\",\"args\":["
+			"{\"op\":{\"opname\":\"CONTRACT\",\"args\":[{\"symb\":\"X\"},{\"symb\":\"W\"}]}},"
+			"{\"op\":{\"opname\":\"EXTEND\",\"args\":[{\"symb\":\"B\"}]}}]}}",
+		"{\"op\":{\"opname\":\"ADD\",\"args\":["
+			"{\"op\":{\"opname\":\"CONTRACT\",\"args\":[{\"op\":{\"opname\":\"CONCAT\"}},"
+			"{\"leaf\":{\"label\":\"weight\"}}]}},{\"symb\":\"B\"}]}}",
+		"{\"op\":{\"opname\":\"MUL\",\"args\":[{\"symb\":\"A\"},{\"symb\":\"A\"}]}}",
+		"{\"op\":{\"opname\":\"MUL\",\"args\":[{\"symb\":\"A\"},"
+			"{\"op\":{\"opname\":\"TANH\",\"args\":[{\"symb\":\"B\"}]}}]}}",
+		"{\"op\":{\"opname\":\"TANH\",\"args\":[{\"op\":{\"opname\":\"IDENTITY\","
+			"\"args\":[{\"op\":{\"opname\":\"ADD\"}}]}}]}}",
+		"{\"op\":{\"opname\":\"SUB\",\"args\":[{\"leaf\":{}},{\"symb\":\"Y\"}]}}",
+		"{\"op\":{\"opname\":\"SLICE\",\"args\":[{\"leaf\":{\"label\":\"input\"}}]}}",
+		"{\"op\":{\"opname\":\"CONCAT\",\"args\":[{\"symb\":\"X\"},"
+			"{\"op\":{\"opname\":\"EXTEND\",\"args\":[{\"symb\":\"S\"}]}}]}}",
+	};
+	std::vector<query::Node> conds(patterns.size());
+	query::Matcher matcher;
+	for (size_t i = 0, n = patterns.size(); i < n; ++i)
+	{
+		std::stringstream inss;
+		inss << patterns[i];
+		query::json_parse(conds[i], inss);
+		EXPECT_EQ(i, matcher.add(conds[i]));
+	}
+
+	const size_t nreps = 200;
+	std::vector<query::QResultsT> expect;
+	auto start = std::chrono::steady_clock::now();
+	for (size_t rep = 0; rep < nreps; ++rep)
+	{
+		expect.clear();
+		for (auto& cond : conds)
+		{
+			expect.push_back(index.match(cond));
+		}
+	}
+	auto per_query = std::chrono::steady_clock::now() - start;
+
+	std::vector<query::QResultsT> got;
+	start = std::chrono::steady_clock::now();
+	for (size_t rep = 0; rep < nreps; ++rep)
+	{
+		got = matcher.match_all(index);
+	}
+	auto compiled = std::chrono::steady_clock::now() - start;
+
+	ASSERT_EQ(expect.size(), got.size());
+	size_t nmatches = 0;
+	for (size_t i = 0, n = expect.size(); i < n; ++i)
+	{
+		query::QReSetT exset(expect[i].begin(), expect[i].end());
+		query::QReSetT gotset(got[i].begin(), got[i].end());
+		EXPECT_EQ(exset, gotset) << "pattern " << patterns[i];
+		nmatches += expect[i].size();
+	}
+	EXPECT_LT(0, nmatches);
+
+	using Micros = std::chrono::microseconds;
+	std::cout << "[ BENCHMARK] " << patterns.size() << " patterns x " << nreps
+		<< " reps (" << nmatches << " matches/rep): per query "
+		<< std::chrono::duration_cast<Micros>(per_query).count()
+		<< "us, compiled "
+		<< std::chrono::duration_cast<Micros>(compiled).count() << "us\n";
+}
+
+
 // match commutative with attributes
 
 
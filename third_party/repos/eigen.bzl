@@ -4,6 +4,6 @@ def eigen_repository():
     new_git_repository(
         name = "com_github_eigenteam_eigen",
         remote = "https://gitlab.com/libeigen/eigen.git",
-        tag = "3.3.7",
+        tag = "3.4.0",
         build_file = "@com_github_mingkaic_tenncor//third_party:eigen.BUILD",
     )
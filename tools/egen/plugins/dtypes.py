@@ -177,10 +177,8 @@ def _handle_mapping(arguments):
     ])
 
 _convert_tmp = '''case {code}:
-        {{
-            std::vector<OUTTYPE> temp(({dtype}*) input, ({dtype}*) input + nelems);
-            std::memcpy(out, temp.data(), sizeof(OUTTYPE) * nelems);
-        }}
+            std::transform(({dtype}*) input, ({dtype}*) input + nelems, out,
+                [](const {dtype}& in) {{ return static_cast<OUTTYPE>(in); }});
             break;'''
 def _handle_conversions(arguments):
     dtypes = arguments[dtype_key]
@@ -275,9 +273,16 @@ class DTypesPlugin:
 
         module = globals()
 
+        type_includes = arguments.get('includes', [])
+        if isinstance(type_includes, str):
+            type_includes = [type_includes]
+        type_includes = ['"' + include.strip() + '"'
+            for include in type_includes]
+
         generated_files[_hdr_file] = FileRep(
             build_template(_header_template, module, arguments),
-            user_includes=['<string>', '<cstring>', '"internal/global/global.hpp"'],
+            user_includes=['<algorithm>', '<string>',
+                '"internal/global/global.hpp"'] + type_includes,
             internal_refs=[])
 
         generated_files[_src_file] = FileRep(